@@ -0,0 +1,197 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Asset
+ * \{
+ */
+
+/*!
+ * 	\file asset.c
+ *
+ * 	\brief Implementation of the asset store.
+ *
+ * 	This file implements the asset index lookup and reads.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "simplelink.h"
+#include "bcache.h"
+#include "asset.h"
+#include "fs.h"
+
+/*!
+ * 	\var static unsigned char ASSET_FILE_NAME[]
+ *
+ * 	\brief Path to the asset file.
+ *
+ * 	The file is saved as /sys/assets.bin.
+ */
+static unsigned char ASSET_FILE_NAME[] = "/sys/assets.bin";
+
+/*! Handle of the asset file, -1 when closed. */
+static int32_t hAsset = -1;
+
+/*! Number of entries in the index. */
+static uint32_t count;
+
+/*
+ * FNV-1a hash of the asset name.
+ */
+uint32_t ASSETId(const char *name) {
+  uint32_t hash = 2166136261u;
+
+  while (*name != '\0') {
+    hash ^= (unsigned char) *name++;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+/*
+ * Open the asset file and read its header.
+ */
+int32_t ASSETOpen() {
+  int32_t RetVal;
+  assethdr_t hdr;
+#ifdef BOOT_BCACHE
+  SlFsFileInfo_t FileInfo;
+#endif
+
+  ASSETClose();
+
+  RetVal = sl_FsOpen(ASSET_FILE_NAME, FS_MODE_OPEN_READ, NULL, &hAsset);
+  if (0 != RetVal) {
+    hAsset = -1;
+    return RetVal;
+  }
+
+#ifdef BOOT_BCACHE
+  /* The cache reads whole blocks up to the end of the file. */
+  if (0 == sl_FsGetInfo(ASSET_FILE_NAME, 0, &FileInfo))
+    BCACHESetLen(hAsset, FileInfo.FileLen);
+#endif
+
+  RetVal = BCACHERead(hAsset, 0, (unsigned char*) &hdr, sizeof(assethdr_t));
+  if (((int32_t) sizeof(assethdr_t) != RetVal) || (ASSET_MAGIC != hdr.magic)) {
+    ASSETClose();
+    return -1;
+  }
+
+  count = hdr.count;
+  return 0;
+}
+
+/*
+ * Compare the name stored for the entry, ids of different names may be the
+ * same.
+ */
+static int32_t ASSETSameName(const asset_t *asset, const char *name) {
+  unsigned char buf[ASSET_NAME_CHUNK];
+  uint32_t len = strlen(name);
+  uint32_t done;
+  uint32_t n;
+
+  if (len != asset->namelen)
+    return 0;
+
+  for (done = 0; done < len; done += n) {
+    n = (len - done < ASSET_NAME_CHUNK) ? len - done : ASSET_NAME_CHUNK;
+
+    if (((int32_t) n != BCACHERead(hAsset, asset->nameoff + done, buf, n))
+        || (0 != memcmp(buf, name + done, n)))
+      return 0;
+  }
+
+  return 1;
+}
+
+/*
+ * Binary search of the id in the index.
+ */
+int32_t ASSETFind(const char *name, asset_t *asset) {
+  uint32_t id = ASSETId(name);
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  uint32_t mid;
+
+  if (0 > hAsset)
+    return -1;
+
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+
+    if ((int32_t) sizeof(assetentry_t) != BCACHERead(hAsset,
+        sizeof(assethdr_t) + mid * sizeof(assetentry_t),
+        (unsigned char*) asset, sizeof(assetentry_t)))
+      return -1;
+
+    /* The packed ids are unique, no other entry can have the name. */
+    if (asset->id == id)
+      return ASSETSameName(asset, name) ? 0 : -1;
+
+    if (asset->id < id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return -1;
+}
+
+/*
+ * Read part of an asset.
+ */
+int32_t ASSETRead(asset_t *asset, uint32_t offset, unsigned char *buf,
+    uint32_t len) {
+  if (0 > hAsset)
+    return -1;
+
+  if (offset >= asset->length)
+    return 0;
+
+  if (len > asset->length - offset)
+    len = asset->length - offset;
+
+  return BCACHERead(hAsset, asset->offset + offset, buf, len);
+}
+
+/*
+ * Close the file and drop the cached blocks.
+ */
+void ASSETClose() {
+  if (0 <= hAsset) {
+    BCACHEInvalidate(hAsset);
+    sl_FsClose(hAsset, NULL, NULL, 0);
+  }
+
+  hAsset = -1;
+  count = 0;
+}
+
+/*!
+ * \}
+ */
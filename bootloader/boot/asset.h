@@ -0,0 +1,206 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Asset Asset
+ * \{
+ *
+ * \brief Read-only assets fetched on demand from a flash file.
+ *
+ * ### Overview
+ * Certificates, lookup tables and web pages don't need to be linked into the
+ * application image. They are packed into a single file (see
+ * tools/mkassets.py) with an index sorted by asset id, and read at offsets
+ * with sl_FsRead only when needed. The id is a hash of the name, so the name
+ * is stored too and ASSETFind compares it on a match: a name that is not in
+ * the file is never taken for an asset with the same id. All the reads go
+ * through the block cache (see bcache.h), so repeated small reads don't go
+ * to the NWP every time.
+ *
+ * The SRAM cost is the block cache, BCACHE_BLOCKS * BCACHE_BLOCK_SIZE bytes.
+ * Applications with large assets usually build with bigger values than the
+ * bootloader defaults (for example 8 blocks of 256 bytes). Hits and misses
+ * are reported by BCACHEStats.
+ *
+ * ### Requires
+ * - Simplelink (Can be the TINY build).
+ * - BCache.
+ *
+ * ### Usage
+ * Start the simplelink stack, open the asset file with ASSETOpen, find the
+ * asset by its name with ASSETFind and read it with ASSETRead.
+ *
+ * ### Example
+ *
+ * \code
+ *  asset_t cert;
+ *  unsigned char buf[64];
+ *
+ *  ASSETOpen();
+ *
+ *  if (0 == ASSETFind("ca.der", &cert))
+ *    ASSETRead(&cert, 0, buf, sizeof(buf));
+ *
+ *  ASSETClose();
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _ASSET_H_
+#define _ASSET_H_
+
+/*!
+ *	\file asset.h
+ *
+ *	\brief Constants, types and function prototypes of the asset store.
+ *
+ *	This file contains definitions used by the asset.c.
+ */
+
+/*!
+ *	\def ASSET_MAGIC
+ *
+ * 	\brief Magic number ("ASE2", the index with the names) in the header of
+ * 	the asset file.
+ */
+#define ASSET_MAGIC	0x32455341
+
+/*!
+ *	\def ASSET_NAME_CHUNK
+ *
+ * 	\brief Bytes of the stored name compared at once by ASSETFind.
+ */
+#define ASSET_NAME_CHUNK	16
+
+/*!
+ *	\struct assethdr_t
+ *
+ *	\brief Header of the asset file, followed by count assetentry_t, the
+ *	names and the data.
+ */
+typedef struct {
+  /*! Must be ASSET_MAGIC. */
+  uint32_t magic;
+  /*! Number of entries in the index. */
+  uint32_t count;
+} assethdr_t;
+
+/*!
+ *	\struct assetentry_t
+ *
+ *	\brief Index entry, the index is sorted by id.
+ */
+typedef struct {
+  /*! Asset id, see ASSETId. */
+  uint32_t id;
+  /*! Offset of the asset data in the file. */
+  uint32_t offset;
+  /*! Length of the asset in bytes. */
+  uint32_t length;
+  /*! Offset of the name in the file, not null terminated. */
+  uint32_t nameoff;
+  /*! Length of the name. */
+  uint32_t namelen;
+} assetentry_t;
+
+/*!
+ *	\typedef asset_t
+ *
+ *	\brief Handle of an asset found with ASSETFind.
+ */
+typedef assetentry_t asset_t;
+
+/*!
+ *	\fn uint32_t ASSETId(const char *name)
+ *
+ * 	\brief Compute the id of an asset name.
+ *
+ * 	The id is the 32 bit FNV-1a hash of the name, the same used by
+ * 	tools/mkassets.py.
+ *
+ * 	\param[in] name Null terminated asset name.
+ *
+ * 	\return The asset id.
+ */
+uint32_t ASSETId(const char *name);
+
+/*!
+ *	\fn int32_t ASSETOpen(void)
+ *
+ * 	\brief Open the asset file.
+ *
+ * 	Opens /sys/assets.bin and checks its header. The file is kept open until
+ * 	ASSETClose.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t ASSETOpen(void);
+
+/*!
+ *	\fn int32_t ASSETFind(const char *name, asset_t *asset)
+ *
+ * 	\brief Find an asset in the index.
+ *
+ * 	The entry with the id of the name is taken only if its stored name is
+ * 	the same.
+ *
+ * 	\param[in] name Null terminated asset name.
+ * 	\param[out] asset Asset handle.
+ *
+ * 	\return 0 on success, -1 if not found.
+ */
+int32_t ASSETFind(const char *name, asset_t *asset);
+
+/*!
+ *	\fn int32_t ASSETRead(asset_t *asset, uint32_t offset, unsigned char *buf, uint32_t len)
+ *
+ * 	\brief Read part of an asset.
+ *
+ * 	\param[in] asset Asset handle from ASSETFind.
+ * 	\param[in] offset Offset inside the asset.
+ * 	\param[out] buf Buffer to hold the data.
+ * 	\param[in] len Number of bytes to read.
+ *
+ * 	\return Number of bytes read (less than len at the end of the asset) or a
+ * 	negative value on error.
+ */
+int32_t ASSETRead(asset_t *asset, uint32_t offset, unsigned char *buf,
+    uint32_t len);
+
+/*!
+ *	\fn void ASSETClose(void)
+ *
+ * 	\brief Close the asset file.
+ */
+void ASSETClose(void);
+
+#endif
+
+/*!
+ * \}
+ */
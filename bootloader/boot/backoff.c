@@ -0,0 +1,121 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Backoff
+ * \{
+ */
+
+/*!
+ * 	\file backoff.c
+ *
+ * 	\brief Implementation of the boot backoff.
+ *
+ * 	This file implements the attempt count and the hibernate between
+ * 	attempts.
+ */
+
+#include <stdint.h>
+#include "hw_types.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "backoff.h"
+
+/*
+ * Read the count, the upper half must be the complement of the lower one.
+ */
+static uint32_t BACKOFFCount(void) {
+  uint32_t word = MAP_PRCMOCRRegisterRead(BACKOFF_OCR);
+
+  if (0xFFFF != ((word >> 16) ^ (word & 0xFFFF)))
+    return 0;
+
+  return word & 0xFFFF;
+}
+
+/*
+ * Write the count.
+ */
+static void BACKOFFSetCount(uint32_t count) {
+  MAP_PRCMOCRRegisterWrite(BACKOFF_OCR, ((~count & 0xFFFF) << 16) | count);
+}
+
+/*
+ * Count the attempt before anything can fail.
+ */
+uint32_t BACKOFFBegin() {
+  uint32_t count = BACKOFFCount();
+
+  if (count < 0xFFFF)
+    BACKOFFSetCount(count + 1);
+
+  return count;
+}
+
+/*
+ * Too many failures, only the minimal boot is tried.
+ */
+int32_t BACKOFFRecovery() {
+  return BACKOFFCount() > BACKOFF_MAX_TRIES;
+}
+
+/*
+ * BACKOFF_BASE_MS doubled for each failure after the first, capped.
+ */
+uint32_t BACKOFFDelay(uint32_t failures) {
+  uint32_t ms = BACKOFF_BASE_MS;
+
+  while ((failures-- > 1) && (ms < BACKOFF_MAX_MS))
+    ms *= 2;
+
+  return (ms > BACKOFF_MAX_MS) ? BACKOFF_MAX_MS : ms;
+}
+
+/*
+ * Sleep in hibernate, the wake up is a new boot.
+ */
+void BACKOFFFail() {
+  unsigned long long ticks = BACKOFFDelay(BACKOFFCount());
+
+  ticks = (ticks * 32768) / 1000;
+
+  MAP_PRCMHibernateIntervalSet(ticks);
+  MAP_PRCMHibernateWakeupSourceEnable(PRCM_HIB_SLOW_CLK_CTR);
+  MAP_PRCMHibernateEnter();
+
+  /* Not reached, unless the hibernate was refused. */
+  PRCMSOCReset();
+}
+
+/*
+ * Clear the count.
+ */
+void BACKOFFDone() {
+  BACKOFFSetCount(0);
+}
+
+/*!
+ * \}
+ */
@@ -0,0 +1,174 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Backoff Backoff
+ * \{
+ *
+ * \brief Exponential backoff between failed boots.
+ *
+ * ### Overview
+ * Resetting the SOC right after a failure (sl_Start, boot.cfg write, image
+ * load) turns a persistent fault into a reset storm that drains a battery in
+ * hours. Instead, every boot attempt is counted in an OCR register of the
+ * hibernate domain (BACKOFF_OCR), which survives resets and hibernate:
+ * BACKOFFBegin counts the attempt and BACKOFFDone clears the count once an
+ * image is started, so a boot cut by the watchdog or a hang counts as a
+ * failure too. A new image on trial only clears it when it confirms itself
+ * (CONFIRMImage), so an image that faults at once counts as a failure.
+ *
+ * After a failure, BACKOFFFail hibernates before the next attempt, for
+ * BACKOFF_BASE_MS doubled for each failure in a row, up to BACKOFF_MAX_MS.
+ * The CC3200 draws a few uA in hibernate, against tens of mA while booting.
+ * After sl_Start, boot.cfg must be closed (BOOTClose) and the NWP stopped
+ * before BACKOFFFail.
+ *
+ * After BACKOFF_MAX_TRIES failures in a row the bootloader enters a minimal
+ * recovery state (BACKOFFRecovery): it skips boot.cfg and only tries to start
+ * the factory image, once every BACKOFF_MAX_MS. A power cycle clears the
+ * count.
+ *
+ * tools/backoffsim.py estimates the battery life under a fault rate, with
+ * and without the backoff.
+ *
+ * ### Requires
+ * - Driverlib;
+ *
+ * ### Example
+ *
+ * \code
+ *  BACKOFFBegin();
+ *  if (0 > sl_Start(NULL, NULL, NULL)) {
+ *    sl_Stop(0);
+ *    BACKOFFFail();
+ *  }
+ *  ...
+ *  if (!trial)
+ *    BACKOFFDone();
+ *  BOOTRun((void*) HANDOFF->base);
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _BACKOFF_H_
+#define _BACKOFF_H_
+
+/*!
+ *	\file backoff.h
+ *
+ *	\brief Constants and function prototypes of the boot backoff.
+ *
+ *	This file contains definitions used by the backoff.c.
+ */
+
+#ifndef BACKOFF_OCR
+/*!
+ *	\def BACKOFF_OCR
+ *
+ * 	\brief Index of the OCR register used for the count (see HIBSTATE_OCR).
+ */
+#define BACKOFF_OCR	0
+#endif
+
+#ifndef BACKOFF_BASE_MS
+/*!
+ *	\def BACKOFF_BASE_MS
+ *
+ * 	\brief Hibernate time after the first failure, in milliseconds.
+ */
+#define BACKOFF_BASE_MS	1000
+#endif
+
+#ifndef BACKOFF_MAX_MS
+/*!
+ *	\def BACKOFF_MAX_MS
+ *
+ * 	\brief Longest hibernate time between attempts, in milliseconds.
+ */
+#define BACKOFF_MAX_MS	3600000
+#endif
+
+#ifndef BACKOFF_MAX_TRIES
+/*!
+ *	\def BACKOFF_MAX_TRIES
+ *
+ * 	\brief Failures in a row before the recovery state.
+ */
+#define BACKOFF_MAX_TRIES	8
+#endif
+
+/*!
+ *	\fn uint32_t BACKOFFBegin(void)
+ *
+ * 	\brief Count a new boot attempt.
+ *
+ * 	\return Failed attempts in a row before this one.
+ */
+uint32_t BACKOFFBegin(void);
+
+/*!
+ *	\fn int32_t BACKOFFRecovery(void)
+ *
+ * 	\brief Check whether the boot is in the recovery state.
+ *
+ * 	\return 1 after BACKOFF_MAX_TRIES failures in a row, 0 otherwise.
+ */
+int32_t BACKOFFRecovery(void);
+
+/*!
+ *	\fn uint32_t BACKOFFDelay(uint32_t failures)
+ *
+ * 	\brief Hibernate time after a number of failures in a row.
+ *
+ * 	\param[in] failures Failures in a row, including the last one.
+ *
+ * 	\return Time in milliseconds.
+ */
+uint32_t BACKOFFDelay(uint32_t failures);
+
+/*!
+ *	\fn void BACKOFFFail(void)
+ *
+ * 	\brief Hibernate before the next attempt, never returns.
+ *
+ * 	The files must be closed and the NWP stopped first.
+ */
+void BACKOFFFail(void);
+
+/*!
+ *	\fn void BACKOFFDone(void)
+ *
+ * 	\brief The boot made it, clear the count.
+ */
+void BACKOFFDone(void);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,248 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup BCache
+ * \{
+ */
+
+/*!
+ * 	\file bcache.c
+ *
+ * 	\brief Implementation of the block cache.
+ *
+ * 	This file implements the LRU block cache used for small reads.
+ */
+
+#ifdef BOOT_BCACHE
+
+#include <stdint.h>
+#include <string.h>
+#include "simplelink.h"
+#include "bcache.h"
+#include "fs.h"
+
+/*!
+ * 	\struct bcacheblock_t
+ *
+ * 	\brief A block of a file kept in SRAM.
+ */
+typedef struct {
+  /*! Handle of the file, valid only if used is not 0. */
+  int32_t hFile;
+  /*! Block number in the file. */
+  uint32_t block;
+  /*! Value of the access counter at the last use, 0 for an empty block. */
+  uint32_t used;
+  /*! Number of valid bytes in data. */
+  uint32_t len;
+  /*! 1 if the file ends at len, more bytes can't be read. */
+  uint32_t eof;
+  /*! Block contents. */
+  unsigned char data[BCACHE_BLOCK_SIZE];
+} bcacheblock_t;
+
+/*!
+ * 	\struct bcachefile_t
+ *
+ * 	\brief Length of a file given with BCACHESetLen.
+ */
+typedef struct {
+  /*! Handle of the file, valid only if used is not 0. */
+  int32_t hFile;
+  /*! 1 if the entry is in use. */
+  uint32_t used;
+  /*! Length of the file. */
+  uint32_t len;
+} bcachefile_t;
+
+/*! Cache blocks. */
+static bcacheblock_t cache[BCACHE_BLOCKS];
+
+/*! Known file lengths. */
+static bcachefile_t files[BCACHE_FILES];
+
+/*! Access counter used as LRU clock. */
+static uint32_t lruclock;
+
+/*! Cache counters. */
+static bcachestats_t stats;
+
+/*
+ * Find the length given for a file.
+ */
+static bcachefile_t *BCACHEFindFile(int32_t hFile) {
+  uint32_t i;
+
+  for (i = 0; i < BCACHE_FILES; i++) {
+    if (files[i].used && files[i].hFile == hFile)
+      return &files[i];
+  }
+
+  return NULL;
+}
+
+/*
+ * Get a block with at least need valid bytes (or the end of the file)
+ * through the cache, loading it from the flash on a miss.
+ */
+static bcacheblock_t *BCACHEGetBlock(int32_t hFile, uint32_t block,
+    uint32_t need) {
+  bcacheblock_t *victim = &cache[0];
+  bcachefile_t *file = BCACHEFindFile(hFile);
+  uint32_t start = block * BCACHE_BLOCK_SIZE;
+  uint32_t size;
+  int32_t RetVal;
+  uint32_t i;
+
+  lruclock++;
+
+  for (i = 0; i < BCACHE_BLOCKS; i++) {
+    if (cache[i].used && cache[i].hFile == hFile && cache[i].block == block) {
+      if ((cache[i].len >= need) || cache[i].eof) {
+        stats.hits++;
+        cache[i].used = lruclock;
+        return &cache[i];
+      }
+
+      /* Read short for an earlier request, read it again in place. */
+      victim = &cache[i];
+      break;
+    }
+
+    /* Remember the least recently used (or empty) block. */
+    if (cache[i].used < victim->used)
+      victim = &cache[i];
+  }
+
+  stats.misses++;
+
+  /* Never read past the end of the file, or of the request if unknown. */
+  if (NULL == file)
+    size = need;
+  else if (start >= file->len)
+    size = 0;
+  else if (file->len - start < BCACHE_BLOCK_SIZE)
+    size = file->len - start;
+  else
+    size = BCACHE_BLOCK_SIZE;
+
+  RetVal = size ? sl_FsRead(hFile, start, victim->data, size) : 0;
+  if (0 > RetVal) {
+    victim->used = 0;
+    return NULL;
+  }
+
+  victim->hFile = hFile;
+  victim->block = block;
+  victim->len = RetVal;
+  victim->eof = ((uint32_t) RetVal < size)
+      || ((NULL != file) && (start + size >= file->len));
+  victim->used = lruclock;
+  return victim;
+}
+
+/*
+ * Read from a file through the cache.
+ */
+int32_t BCACHERead(int32_t hFile, uint32_t offset, unsigned char *buf,
+    uint32_t len) {
+  bcacheblock_t *blk;
+  uint32_t pos;
+  uint32_t n;
+  uint32_t done = 0;
+
+  while (done < len) {
+    pos = offset % BCACHE_BLOCK_SIZE;
+    n = BCACHE_BLOCK_SIZE - pos;
+    if (n > len - done)
+      n = len - done;
+
+    blk = BCACHEGetBlock(hFile, offset / BCACHE_BLOCK_SIZE, pos + n);
+    if (NULL == blk)
+      return -1;
+
+    /* End of file. */
+    if (pos >= blk->len)
+      break;
+
+    if (n > blk->len - pos)
+      n = blk->len - pos;
+
+    memcpy(buf + done, blk->data + pos, n);
+    done += n;
+    offset += n;
+  }
+
+  return done;
+}
+
+/*
+ * Record the length of a file, if there is a free entry.
+ */
+void BCACHESetLen(int32_t hFile, uint32_t len) {
+  bcachefile_t *file = BCACHEFindFile(hFile);
+  uint32_t i;
+
+  for (i = 0; (NULL == file) && (i < BCACHE_FILES); i++) {
+    if (!files[i].used)
+      file = &files[i];
+  }
+
+  if (NULL == file)
+    return;
+
+  file->hFile = hFile;
+  file->used = 1;
+  file->len = len;
+}
+
+/*
+ * Drop the blocks and the length of a file.
+ */
+void BCACHEInvalidate(int32_t hFile) {
+  bcachefile_t *file = BCACHEFindFile(hFile);
+  uint32_t i;
+
+  for (i = 0; i < BCACHE_BLOCKS; i++) {
+    if (cache[i].hFile == hFile)
+      cache[i].used = 0;
+  }
+
+  if (NULL != file)
+    file->used = 0;
+}
+
+/*
+ * Copy the cache counters.
+ */
+void BCACHEStats(bcachestats_t *out) {
+  *out = stats;
+}
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,192 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup BCache BCache
+ * \{
+ *
+ * \brief Read-through block cache in front of sl_FsRead.
+ *
+ * ### Overview
+ * Every sl_FsRead is a SPI transaction with the NWP, and for small reads
+ * (headers, relocation tables, configuration records) the cost of the
+ * transaction dominates. This module keeps the last used blocks of the open
+ * files in SRAM, so small scattered reads of the same region only go to the
+ * NWP once.
+ *
+ * Blocks are keyed by file handle and block number. Since SimpleLink reuses
+ * the handles, BCACHEInvalidate must be called before a file is closed or
+ * written.
+ *
+ * A block is never read past the end of the file: sl_FsRead may fail,
+ * instead of returning less, when asked for bytes past the allocated size.
+ * When the length of the file was given with BCACHESetLen whole blocks are
+ * read up to it, otherwise a miss reads only up to the end of the request
+ * and the block is read again if a later request needs more of it.
+ *
+ * The block size (BCACHE_BLOCK_SIZE) and the number of blocks (BCACHE_BLOCKS)
+ * can be redefined at build time. Bulk reads, like the image payload, should
+ * keep using sl_FsRead directly.
+ *
+ * The cache is only built with BOOT_BCACHE defined. Without it BCACHERead is
+ * sl_FsRead, the other functions are empty macros and the reads of the boot
+ * and asset modules each go to the NWP.
+ *
+ * ### Requires
+ * - Simplelink (Can be the TINY build).
+ *
+ * ### Example
+ *
+ * \code
+ *  imghdr_t hdr;
+ *
+ *  sl_FsOpen(name, FS_MODE_OPEN_READ, NULL, &hFile);
+ *  sl_FsGetInfo(name, 0, &FileInfo);
+ *  BCACHESetLen(hFile, FileInfo.FileLen);
+ *  BCACHERead(hFile, 0, (unsigned char*) &hdr, sizeof(imghdr_t));
+ *  BCACHEInvalidate(hFile);
+ *  sl_FsClose(hFile, NULL, NULL, 0);
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _BCACHE_H_
+#define _BCACHE_H_
+
+/*!
+ *	\file bcache.h
+ *
+ *	\brief Constants, types and function prototypes of the block cache.
+ *
+ *	This file contains definitions used by the bcache.c.
+ */
+
+#ifndef BCACHE_BLOCK_SIZE
+/*!
+ *	\def BCACHE_BLOCK_SIZE
+ *
+ * 	\brief Size of a cache block in bytes.
+ */
+#define BCACHE_BLOCK_SIZE	128
+#endif
+
+#ifndef BCACHE_BLOCKS
+/*!
+ *	\def BCACHE_BLOCKS
+ *
+ * 	\brief Number of blocks in the cache.
+ */
+#define BCACHE_BLOCKS	4
+#endif
+
+#ifndef BCACHE_FILES
+/*!
+ *	\def BCACHE_FILES
+ *
+ * 	\brief Number of files whose length can be given with BCACHESetLen.
+ */
+#define BCACHE_FILES	2
+#endif
+
+/*!
+ *	\struct bcachestats_t
+ *
+ *	\brief Cache statistics.
+ */
+typedef struct {
+  /*! Blocks served from the SRAM. */
+  uint32_t hits;
+  /*! Blocks read from the flash (one sl_FsRead each). */
+  uint32_t misses;
+} bcachestats_t;
+
+#ifdef BOOT_BCACHE
+
+/*!
+ *	\fn int32_t BCACHERead(int32_t hFile, uint32_t offset, unsigned char *buf, uint32_t len)
+ *
+ * 	\brief Read from a file through the cache.
+ *
+ * 	\param[in] hFile Handle of a file opened for reading.
+ * 	\param[in] offset Offset in the file.
+ * 	\param[out] buf Buffer to hold the data.
+ * 	\param[in] len Number of bytes to read.
+ *
+ * 	\return Number of bytes read (less than len at the end of the file) or a
+ * 	negative value on error.
+ */
+int32_t BCACHERead(int32_t hFile, uint32_t offset, unsigned char *buf,
+    uint32_t len);
+
+/*!
+ *	\fn void BCACHESetLen(int32_t hFile, uint32_t len)
+ *
+ * 	\brief Give the length of a file, so whole blocks can be read.
+ *
+ * 	Ignored when BCACHE_FILES files already have a length, the reads of the
+ * 	file are then clamped to the requests. Dropped by BCACHEInvalidate.
+ *
+ * 	\param[in] hFile Handle of a file opened for reading.
+ * 	\param[in] len Length of the file (SlFsFileInfo_t::FileLen).
+ */
+void BCACHESetLen(int32_t hFile, uint32_t len);
+
+/*!
+ *	\fn void BCACHEInvalidate(int32_t hFile)
+ *
+ * 	\brief Drop all the cached blocks and the length of a file.
+ *
+ * 	Must be called before closing or writing the file.
+ *
+ * 	\param[in] hFile File handle.
+ */
+void BCACHEInvalidate(int32_t hFile);
+
+/*!
+ *	\fn void BCACHEStats(bcachestats_t *stats)
+ *
+ * 	\brief Get the hit/miss counters.
+ *
+ * 	\param[out] stats Structure to hold the counters.
+ */
+void BCACHEStats(bcachestats_t *stats);
+
+#else
+
+#define BCACHERead(hFile, offset, buf, len)	sl_FsRead(hFile, offset, buf, len)
+#define BCACHESetLen(hFile, len)
+#define BCACHEInvalidate(hFile)
+#define BCACHEStats(stats)	memset(stats, 0, sizeof(bcachestats_t))
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,185 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Blake2s
+ * \{
+ */
+
+/*!
+ * 	\file blake2s.c
+ *
+ * 	\brief Implementation of the BLAKE2s digest.
+ *
+ * 	This file implements the BLAKE2s compression function and the streaming
+ * 	interface, following RFC 7693.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "blake2s.h"
+
+/*! Initialization vector, the same of SHA-256. */
+static const uint32_t iv[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372,
+    0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+
+/*! Message word permutation of each round. */
+static const uint8_t sigma[10][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+    { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+    { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+    { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+    { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+    { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+    { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+    { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+    { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 } };
+
+/*! Rotate right, a single ROR on the Cortex-M4. */
+#define ROTR(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+
+/*! Mixing function G on the words a, b, c, d of v with x and y. */
+#define G(a, b, c, d, x, y) do { \
+    v[a] = v[a] + v[b] + (x); v[d] = ROTR(v[d] ^ v[a], 16); \
+    v[c] = v[c] + v[d];       v[b] = ROTR(v[b] ^ v[c], 12); \
+    v[a] = v[a] + v[b] + (y); v[d] = ROTR(v[d] ^ v[a], 8); \
+    v[c] = v[c] + v[d];       v[b] = ROTR(v[b] ^ v[c], 7); \
+  } while (0)
+
+/*
+ * Compress one block, last is set for the final block.
+ */
+static void BLAKE2SCompress(blake2sctx_t *ctx, const uint8_t *block,
+    uint32_t last) {
+  uint32_t v[16];
+  uint32_t m[16];
+  const uint8_t *s;
+  uint32_t i;
+
+  /* Little endian, like the Cortex-M4, but the block may be unaligned. */
+  memcpy(m, block, BLAKE2S_BLOCK);
+
+  for (i = 0; i < 8; i++) {
+    v[i] = ctx->h[i];
+    v[i + 8] = iv[i];
+  }
+
+  v[12] ^= ctx->t[0];
+  v[13] ^= ctx->t[1];
+  if (last)
+    v[14] = ~v[14];
+
+  for (i = 0; i < 10; i++) {
+    s = sigma[i];
+    G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+    G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+    G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+    G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+    G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+    G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+    G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+    G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+
+  for (i = 0; i < 8; i++)
+    ctx->h[i] ^= v[i] ^ v[i + 8];
+}
+
+/*
+ * Count len more bytes.
+ */
+static void BLAKE2SCount(blake2sctx_t *ctx, uint32_t len) {
+  ctx->t[0] += len;
+  if (ctx->t[0] < len)
+    ctx->t[1]++;
+}
+
+/*
+ * Load the parameter block (no key, sequential mode) into the state.
+ */
+void BLAKE2SInit(blake2sctx_t *ctx, uint32_t outlen) {
+  uint32_t i;
+
+  if ((0 == outlen) || (outlen > BLAKE2S_OUTLEN))
+    outlen = BLAKE2S_OUTLEN;
+
+  for (i = 0; i < 8; i++)
+    ctx->h[i] = iv[i];
+
+  ctx->h[0] ^= 0x01010000 ^ outlen;
+  ctx->t[0] = 0;
+  ctx->t[1] = 0;
+  ctx->buflen = 0;
+  ctx->outlen = outlen;
+}
+
+/*
+ * The last block is only compressed by BLAKE2SFinal, so a full block is kept
+ * in the buffer until more data arrives.
+ */
+void BLAKE2SUpdate(blake2sctx_t *ctx, const uint8_t *data, uint32_t len) {
+  uint32_t fill;
+
+  if (0 == len)
+    return;
+
+  if (ctx->buflen + len > BLAKE2S_BLOCK) {
+    /* Complete and compress the buffered block. */
+    fill = BLAKE2S_BLOCK - ctx->buflen;
+    memcpy(ctx->buf + ctx->buflen, data, fill);
+    BLAKE2SCount(ctx, BLAKE2S_BLOCK);
+    BLAKE2SCompress(ctx, ctx->buf, 0);
+    ctx->buflen = 0;
+    data += fill;
+    len -= fill;
+
+    /* Compress straight from the input. */
+    while (len > BLAKE2S_BLOCK) {
+      BLAKE2SCount(ctx, BLAKE2S_BLOCK);
+      BLAKE2SCompress(ctx, data, 0);
+      data += BLAKE2S_BLOCK;
+      len -= BLAKE2S_BLOCK;
+    }
+  }
+
+  memcpy(ctx->buf + ctx->buflen, data, len);
+  ctx->buflen += len;
+}
+
+/*
+ * Pad and compress the last block.
+ */
+void BLAKE2SFinal(blake2sctx_t *ctx, uint8_t *digest) {
+  BLAKE2SCount(ctx, ctx->buflen);
+  memset(ctx->buf + ctx->buflen, 0, BLAKE2S_BLOCK - ctx->buflen);
+  BLAKE2SCompress(ctx, ctx->buf, 1);
+
+  /* Little endian output. */
+  memcpy(digest, ctx->h, ctx->outlen);
+}
+
+/*!
+ * \}
+ */
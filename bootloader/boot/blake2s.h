@@ -0,0 +1,135 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Blake2s Blake2s
+ * \{
+ *
+ * \brief BLAKE2s (RFC 7693) message digest.
+ *
+ * ### Overview
+ * Software SHA-256 is slow on the Cortex-M4. BLAKE2s was designed for 32 bit
+ * cores: it only uses 32 bit additions, xors and rotations, needs no tables
+ * besides the message schedule and runs 10 rounds over 64 byte blocks. It is
+ * used to check the payload of images built with IMG_DIGEST_BLAKE2S.
+ *
+ * Only the unkeyed mode with a 32 byte digest is used by the bootloader, but
+ * any digest length up to BLAKE2S_OUTLEN can be asked for.
+ *
+ * ### Example
+ *
+ * \code
+ *  blake2sctx_t ctx;
+ *  uint8_t digest[BLAKE2S_OUTLEN];
+ *
+ *  BLAKE2SInit(&ctx, BLAKE2S_OUTLEN);
+ *  BLAKE2SUpdate(&ctx, data, len);
+ *  BLAKE2SFinal(&ctx, digest);
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _BLAKE2S_H_
+#define _BLAKE2S_H_
+
+/*!
+ *	\file blake2s.h
+ *
+ *	\brief Constants, types and function prototypes of the BLAKE2s digest.
+ *
+ *	This file contains definitions used by the blake2s.c.
+ */
+
+/*!
+ *	\def BLAKE2S_BLOCK
+ *
+ * 	\brief Size of a BLAKE2s block in bytes.
+ */
+#define BLAKE2S_BLOCK	64
+
+/*!
+ *	\def BLAKE2S_OUTLEN
+ *
+ * 	\brief Maximum (and default) digest length in bytes.
+ */
+#define BLAKE2S_OUTLEN	32
+
+/*!
+ *	\struct blake2sctx_t
+ *
+ *	\brief State of a running digest.
+ */
+typedef struct {
+  /*! Chained state. */
+  uint32_t h[8];
+  /*! Total number of bytes compressed, low and high words. */
+  uint32_t t[2];
+  /*! Bytes waiting in buf. */
+  uint32_t buflen;
+  /*! Digest length in bytes. */
+  uint32_t outlen;
+  /*! Last, possibly partial, block. */
+  uint8_t buf[BLAKE2S_BLOCK];
+} blake2sctx_t;
+
+/*!
+ *	\fn void BLAKE2SInit(blake2sctx_t *ctx, uint32_t outlen)
+ *
+ * 	\brief Start a new digest.
+ *
+ * 	\param[out] ctx Digest state.
+ * 	\param[in] outlen Digest length, 1 to BLAKE2S_OUTLEN.
+ */
+void BLAKE2SInit(blake2sctx_t *ctx, uint32_t outlen);
+
+/*!
+ *	\fn void BLAKE2SUpdate(blake2sctx_t *ctx, const uint8_t *data, uint32_t len)
+ *
+ * 	\brief Add data to the digest.
+ *
+ * 	\param[in,out] ctx Digest state.
+ * 	\param[in] data Data to hash.
+ * 	\param[in] len Number of bytes in data.
+ */
+void BLAKE2SUpdate(blake2sctx_t *ctx, const uint8_t *data, uint32_t len);
+
+/*!
+ *	\fn void BLAKE2SFinal(blake2sctx_t *ctx, uint8_t *digest)
+ *
+ * 	\brief Finish the digest.
+ *
+ * 	\param[in,out] ctx Digest state.
+ * 	\param[out] digest Buffer of ctx->outlen bytes for the digest.
+ */
+void BLAKE2SFinal(blake2sctx_t *ctx, uint8_t *digest);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -37,10 +37,25 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "unused.h"
+#include "hw_types.h"
+#include "hw_memmap.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "wdt.h"
 #include "simplelink.h"
 #include "boot.h"
+#include "bcache.h"
+#include "blake2s.h"
+#include "digest.h"
+#include "unpack.h"
+#include "patch.h"
+#include "ckpt.h"
+#include "hibstate.h"
 #include "fs.h"
+
 /*!
  * 	\var static unsigned char bootfile[]
  *
@@ -68,17 +83,70 @@ static unsigned char IMG_FACTORY_NAME[] = "/sys/factory.bin";
  */
 static unsigned char IMG_CUSTOM_NAME[] = "/sys/custom.bin";
 
+/*!
+ * 	\var static unsigned char IMG_SLOT_NAME[]
+ *
+ * 	\brief Path to the second custom image slot.
+ *
+ * 	The file is saved as /sys/custom1.bin, the first slot is custom.bin.
+ */
+static unsigned char IMG_SLOT_NAME[] = "/sys/custom1.bin";
+
+/*! Slot of the custom image, from the configuration last read or written. */
+static uint32_t customslot;
+
+/*!
+ * 	\def BOOT_CFG_FLAGS
+ *
+ * 	\brief Flags used to create boot.cfg.
+ *
+ * 	With BOOT_SECURE the file is encrypted by the NWP and fail-safe. It stays
+ * 	public, so no token has to be kept to read it back.
+ */
+#ifdef BOOT_SECURE
+#define BOOT_CFG_FLAGS	(_FS_FILE_OPEN_FLAG_COMMIT | _FS_FILE_OPEN_FLAG_SECURE \
+    | _FS_FILE_OPEN_FLAG_NO_SIGNATURE_TEST | _FS_FILE_PUBLIC_WRITE \
+    | _FS_FILE_PUBLIC_READ)
+#else
+#define BOOT_CFG_FLAGS	(_FS_FILE_PUBLIC_WRITE | _FS_FILE_PUBLIC_READ)
+#endif
+
+/*! Read handle of boot.cfg kept open between calls, -1 when closed. */
+static int32_t hCfg = -1;
+
 /*
- * Check if the configuration file exists.
+ * Open boot.cfg for reading, if not open yet.
  */
-int32_t BOOTExistCfg() {
+static int32_t BOOTOpenCfg(void) {
   int32_t RetVal;
-  SlFsFileInfo_t FileInfo;
 
-  /* If file info exists, the file exists. */
-  RetVal = sl_FsGetInfo(bootfile, 0, &FileInfo);
+  if (0 <= hCfg)
+    return 0;
+
+  RetVal = sl_FsOpen(bootfile, FS_MODE_OPEN_READ, NULL, &hCfg);
+  if (0 != RetVal)
+    hCfg = -1;
+
+  return RetVal;
+}
+
+/*
+ * Close the read handle of boot.cfg.
+ */
+static void BOOTCloseCfg(void) {
+  if (0 <= hCfg) {
+    BCACHEInvalidate(hCfg);
+    sl_FsClose(hCfg, NULL, NULL, 0);
+  }
 
-  return (0 == RetVal) ? 1 : 0;
+  hCfg = -1;
+}
+
+/*
+ * Check if the configuration file exists, keeping it open for BOOTReadCfg.
+ */
+int32_t BOOTExistCfg() {
+  return (0 == BOOTOpenCfg()) ? 1 : 0;
 }
 
 /*
@@ -89,9 +157,8 @@ int32_t BOOTCreateCfg() {
   int32_t hFile;
 
   /* Create a public file with max size of 512 bytes. */
-  RetVal = sl_FsOpen(bootfile,
-      FS_MODE_OPEN_CREATE(512, _FS_FILE_PUBLIC_WRITE | _FS_FILE_PUBLIC_READ),
-      NULL, &hFile);
+  RetVal = sl_FsOpen(bootfile, FS_MODE_OPEN_CREATE(512, BOOT_CFG_FLAGS), NULL,
+      &hFile);
 
   /* Return the file handler if success. */
   return (0 != RetVal) ? -1 : hFile;
@@ -101,6 +168,9 @@ int32_t BOOTCreateCfg() {
  * Delete the configuration.
  */
 int32_t BOOTDeleteCfg() {
+  BOOTCloseCfg();
+  HIBSTATEClear();
+
   /* Delete the configuration file. */
   return sl_FsDel(bootfile, 0);
 }
@@ -110,23 +180,19 @@ int32_t BOOTDeleteCfg() {
  */
 int32_t BOOTReadCfg(bootinfo_t *bootinfo) {
   int32_t RetVal;
-  int32_t hFile;
-
-  /* If boot.cfg doesn't exists, return error. */
-  if (!BOOTExistCfg())
-    return -1;
 
-  /* Open the file in read mode. */
-  RetVal = sl_FsOpen(bootfile, FS_MODE_OPEN_READ, NULL, &hFile);
+  /* The file stays open, and its block cached, for the next read. */
+  RetVal = BOOTOpenCfg();
   if (RetVal != 0)
     return RetVal;
 
-  /* Reat it. */
-  RetVal = sl_FsRead(hFile, 0, (unsigned char*) bootinfo, sizeof(bootinfo_t));
+  memset(bootinfo, 0, sizeof(bootinfo_t));
+  RetVal = BCACHERead(hCfg, 0, (unsigned char*) bootinfo, sizeof(bootinfo_t));
+  if (RetVal < 0)
+    return RetVal;
 
-  /* Close it. */
-  sl_FsClose(hFile, NULL, NULL, 0);
-  return (RetVal < 0) ? RetVal : 0;
+  BOOTSelectSlot(bootinfo->customslot);
+  return 0;
 }
 
 /*
@@ -137,16 +203,15 @@ int32_t BOOTWriteCfg(bootinfo_t *bootinfo) {
   int32_t RetVal;
   int32_t hFile;
 
-  /* Check whether file exists or not. */
-  if (BOOTExistCfg()) {
+  /* A file can't be open for reading and writing at the same time. */
+  BOOTCloseCfg();
 
-    /* If exists, open it. */
-    RetVal = sl_FsOpen(bootfile, FS_MODE_OPEN_WRITE, NULL, &hFile);
-    if (0 != RetVal)
-      return -1;
-  }
-  else {
-    /* Create a new one otherwise. */
+  /* The OCR copy must never be newer than the flash. */
+  HIBSTATEClear();
+
+  /* Open it, or create a new one if it doesn't exist. */
+  RetVal = sl_FsOpen(bootfile, FS_MODE_OPEN_WRITE, NULL, &hFile);
+  if (0 != RetVal) {
     hFile = BOOTCreateCfg();
     if (-1 == hFile)
       return -1;
@@ -158,58 +223,568 @@ int32_t BOOTWriteCfg(bootinfo_t *bootinfo) {
   /* Close the file. */
   sl_FsClose(hFile, NULL, NULL, 0);
 
-  /* Return 0 case everything is ok. */
-  return (0 > RetVal) ? -1 : 0;
+  if (0 > RetVal)
+    return -1;
+
+  BOOTSelectSlot(bootinfo->customslot);
+  HIBSTATESave(bootinfo);
+  return 0;
 }
 
 /*
- * Load an image from the serial flash to the SRAM.
- * The image type must be IMG_FACTORY or IMG_CUSTOM.
+ * Close the files kept open.
  */
-int32_t BOOTLoadImg(imgtype_t img) {
-  int32_t hFile;
-  int32_t RetVal;
-  SlFsFileInfo_t FileInfo;
+void BOOTClose() {
+  BOOTCloseCfg();
+}
 
-  /* Pointer to the SRAM position where the image will be loaded. */
-  unsigned char *BaseAddr = (unsigned char*) BASE_ADDR;
+/*!
+ * 	\def RELOC_CHUNK
+ *
+ * 	\brief Number of relocation entries read from the flash at once.
+ */
+#define RELOC_CHUNK	32
 
-  switch (img) {
+/*! Token used to open the image files (see BOOT_IMG_TOKEN). */
+static _u32 imgtoken = BOOT_IMG_TOKEN;
 
-  /*
-   * Open the correct file according to the image type.
-   * Return error if wrong image type is passed.
-   */
+/*
+ * Get the file name of an image, NULL for an unknown image type.
+ */
+unsigned char *BOOTImgName(imgtype_t img) {
+  switch (img) {
   case IMG_FACTORY:
-    RetVal = sl_FsOpen(IMG_FACTORY_NAME, FS_MODE_OPEN_READ, 0, &hFile);
-    if (0 != RetVal)
-      return RetVal;
-    sl_FsGetInfo(IMG_FACTORY_NAME, 0, &FileInfo);
-    break;
+    return IMG_FACTORY_NAME;
 
   case IMG_CUSTOM:
-    RetVal = sl_FsOpen(IMG_CUSTOM_NAME, FS_MODE_OPEN_READ, 0, &hFile);
-    if (0 != RetVal)
-      return RetVal;
-    sl_FsGetInfo(IMG_CUSTOM_NAME, 0, &FileInfo);
-    break;
+    return BOOTSlotName(customslot);
 
   default:
+    return NULL;
+  }
+}
+
+/*
+ * Get the file name of a custom image slot, NULL for an unknown slot.
+ */
+unsigned char *BOOTSlotName(uint32_t slot) {
+  switch (slot) {
+  case 0:
+    return IMG_CUSTOM_NAME;
+
+  case 1:
+    return IMG_SLOT_NAME;
+
+  default:
+    return NULL;
+  }
+}
+
+/*
+ * Set the slot of IMG_CUSTOM, an unknown slot reads as slot 0.
+ */
+void BOOTSelectSlot(uint32_t slot) {
+  customslot = (slot < 2) ? slot : 0;
+}
+
+/*
+ * Get the slot of IMG_CUSTOM.
+ */
+uint32_t BOOTCustomSlot(void) {
+  return customslot;
+}
+
+/*
+ * Open an image file for reading with the image token.
+ */
+int32_t BOOTOpenImg(imgtype_t img, int32_t *hFile) {
+  unsigned char *name = BOOTImgName(img);
+
+  if (NULL == name)
     return -1;
+
+  return sl_FsOpen(name, FS_MODE_OPEN_READ, &imgtoken, hFile);
+}
+
+/*
+ * Read the relocation table of an image in chunks and apply it to the words
+ * already loaded at addr.
+ */
+static int32_t BOOTRelocate(int32_t hFile, imghdr_t *hdr, uint32_t addr) {
+  int32_t RetVal;
+  uint16_t entries[RELOC_CHUNK];
+  uint32_t offset = IMG_PAYLOAD_OFF(hdr) + IMG_STORED_LEN(hdr);
+  uint32_t remaining = hdr->reloclen;
+  uint32_t delta = addr - hdr->linkaddr;
+  uint32_t nwords = hdr->imglen / 4;
+  uint32_t *words = (uint32_t*) addr;
+  uint32_t pos = 0;
+  uint32_t count;
+  uint32_t i;
+
+  while (remaining > 0) {
+    count = (remaining > RELOC_CHUNK) ? RELOC_CHUNK : remaining;
+
+    RetVal = BCACHERead(hFile, offset, (unsigned char*) entries,
+        count * sizeof(uint16_t));
+    if (RetVal != (int32_t) (count * sizeof(uint16_t)))
+      return -1;
+
+    for (i = 0; i < count; i++) {
+      if (RELOC_SKIP == entries[i]) {
+        pos += RELOC_SKIP;
+        continue;
+      }
+
+      pos += entries[i];
+
+      /* A relocation outside the payload means a broken table. */
+      if (pos >= nwords)
+        return -1;
+
+      words[pos] += delta;
+    }
+
+    offset += count * sizeof(uint16_t);
+    remaining -= count;
   }
 
-  /* Load the image to the SRAM. */
-  RetVal = sl_FsRead(hFile, 0, BaseAddr, FileInfo.FileLen);
-  if (0 > RetVal)
+  return 0;
+}
+
+#ifdef BOOT_FILES
+/*
+ * Check that len bytes at dest are in the .noinit section of the image
+ * loaded at addr, or between the end of its SRAM and RETAINED_ADDR. The C
+ * runtime of the application clears anything else, or it is the image.
+ */
+static int32_t BOOTCheckDest(imghdr_t *hdr, uint32_t addr, uint32_t dest,
+    uint32_t len) {
+  uint32_t memend = addr + IMG_MEM_LEN(hdr);
+  uint32_t noinit = hdr->noinitaddr + (addr - hdr->linkaddr);
+
+  if ((dest >= memend) && (dest <= RETAINED_ADDR)
+      && (len <= RETAINED_ADDR - dest))
+    return 0;
+
+  /* The section itself must be past the payload and inside the image. */
+  if ((0 == hdr->noinitlen) || (noinit < addr + hdr->imglen)
+      || (noinit > memend) || (hdr->noinitlen > memend - noinit))
+    return -1;
+
+  if ((dest < noinit) || (dest - noinit > hdr->noinitlen)
+      || (len > hdr->noinitlen - (dest - noinit)))
+    return -1;
+
+  return 0;
+}
+
+/*
+ * Load the extra files listed in the header into their SRAM buffers.
+ * A missing file doesn't stop the boot, its error goes to the handoff.
+ */
+static int32_t BOOTLoadFiles(int32_t hFile, imghdr_t *hdr, uint32_t addr) {
+  imgfile_t file;
+  bootfile_t *out;
+  SlFsFileInfo_t FileInfo;
+  uint32_t dest;
+  uint32_t len;
+  uint32_t i;
+  int32_t hData;
+  int32_t RetVal;
+
+  if (hdr->filecount > BOOT_MAX_FILES)
+    return -1;
+
+  for (i = 0; i < hdr->filecount; i++) {
+    RetVal = BCACHERead(hFile, hdr->fileoff + i * sizeof(imgfile_t),
+        (unsigned char*) &file, sizeof(imgfile_t));
+    if ((int32_t) sizeof(imgfile_t) != RetVal)
+      return -1;
+
+    file.name[IMG_FILE_NAME_LEN - 1] = '\0';
+    dest = file.addr + (addr - hdr->linkaddr);
+
+    /* The buffer must survive the start of the application. */
+    if (0 != BOOTCheckDest(hdr, addr, dest, file.maxlen))
+      return -1;
+
+    out = &HANDOFF->files[i];
+    out->addr = dest;
+
+    /* Read only what the file has, the buffer may be larger. */
+    RetVal = sl_FsGetInfo((unsigned char*) file.name, 0, &FileInfo);
+    if (0 == RetVal)
+      RetVal = sl_FsOpen((unsigned char*) file.name, FS_MODE_OPEN_READ, NULL,
+          &hData);
+
+    if (0 == RetVal) {
+      len = (FileInfo.FileLen < file.maxlen) ? FileInfo.FileLen : file.maxlen;
+      RetVal = len ? sl_FsRead(hData, 0, (unsigned char*) dest, len) : 0;
+      sl_FsClose(hData, NULL, NULL, 0);
+    }
+
+    out->len = RetVal;
+    HANDOFF->nfiles = i + 1;
+  }
+
+  return 0;
+}
+#endif
+
+/*
+ * Check the digest of the payload loaded at addr.
+ */
+static int32_t BOOTCheckDigest(imghdr_t *hdr, uint32_t addr) {
+  digestctx_t ctx;
+
+  if (0 != DIGESTInit(&ctx, hdr->digestalg))
+    return -1;
+
+  DIGESTUpdate(&ctx, (const uint8_t*) addr, hdr->imglen);
+  return DIGESTCheck(&ctx, hdr->digest);
+}
+
+#ifdef BOOT_PACKED
+/*
+ * Read the chunks of a packed payload and unpack them at addr.
+ */
+static int32_t BOOTUnpack(int32_t hFile, imghdr_t *hdr, uint32_t addr) {
+  uint8_t *buf;
+  digestctx_t ctx;
+  imgchunk_t chunk;
+  uint32_t nchunks = (hdr->imglen + IMG_CHUNK_SIZE - 1) / IMG_CHUNK_SIZE;
+  uint32_t table = IMG_PAYLOAD_OFF(hdr);
+  uint32_t offset = table + nchunks * sizeof(imgchunk_t);
+  uint32_t end = IMG_PAYLOAD_OFF(hdr) + hdr->packlen;
+  uint32_t pos = 0;
+  uint32_t rawlen;
+  uint32_t i;
+  int32_t RetVal;
+
+  if ((0 != DIGESTInit(&ctx, hdr->digestalg)) || (offset > end))
+    return -1;
+
+  /* The digest covers the payload in file order, the table comes first. */
+  for (i = 0; i < nchunks; i++) {
+    RetVal = BCACHERead(hFile, table + i * sizeof(imgchunk_t),
+        (unsigned char*) &chunk, sizeof(imgchunk_t));
+    if ((int32_t) sizeof(imgchunk_t) != RetVal)
+      return -1;
+
+    DIGESTUpdate(&ctx, (const uint8_t*) &chunk, sizeof(imgchunk_t));
+  }
+
+  for (i = 0; i < nchunks; i++) {
+    RetVal = BCACHERead(hFile, table + i * sizeof(imgchunk_t),
+        (unsigned char*) &chunk, sizeof(imgchunk_t));
+    if ((int32_t) sizeof(imgchunk_t) != RetVal)
+      return -1;
+
+    rawlen = hdr->imglen - pos;
+    if (rawlen > IMG_CHUNK_SIZE)
+      rawlen = IMG_CHUNK_SIZE;
+
+    if ((chunk.len > IMG_CHUNK_SIZE) || (chunk.len > end - offset))
+      return -1;
+
+    if (IMG_CODEC_RAW == chunk.codec) {
+      /* Raw chunks go straight to their place. */
+      if (chunk.len != rawlen)
+        return -1;
+
+      RetVal = sl_FsRead(hFile, offset, (unsigned char*) addr + pos, rawlen);
+      if (RetVal != (int32_t) rawlen)
+        return -1;
+
+      DIGESTUpdate(&ctx, (const uint8_t*) addr + pos, rawlen);
+    }
+    else {
+      /* The coded chunk is read past its place, into SRAM of the image that
+       * is not written yet or is cleared by its C runtime. The bootloader
+       * stack has no room for it. */
+      buf = (uint8_t*) addr + pos + rawlen;
+      if (chunk.len > IMG_MEM_LEN(hdr) - pos - rawlen)
+        return -1;
+
+      RetVal = sl_FsRead(hFile, offset, buf, chunk.len);
+      if (RetVal != (int32_t) chunk.len)
+        return -1;
+
+      DIGESTUpdate(&ctx, buf, chunk.len);
+
+      RetVal = UNPACKChunk(chunk.codec, buf, chunk.len, (uint8_t*) addr + pos,
+          rawlen, (const uint8_t*) addr);
+      if (0 != RetVal)
+        return RetVal;
+    }
+
+    offset += chunk.len;
+    pos += rawlen;
+  }
+
+  if (offset != end)
+    return -1;
+
+  return DIGESTCheck(&ctx, hdr->digest);
+}
+#endif
+
+/*
+ * Load an image that starts with an imghdr_t.
+ */
+static int32_t BOOTLoadHdrImg(int32_t hFile, imghdr_t *hdr, uint32_t addr) {
+  int32_t RetVal;
+
+  if (hdr->hdrlen < IMG_HDR_MINLEN)
+    return -1;
+
+  /* Fields unknown to an older header are 0. */
+  if (hdr->hdrlen < sizeof(imghdr_t))
+    memset((unsigned char*) hdr + hdr->hdrlen, 0,
+        sizeof(imghdr_t) - hdr->hdrlen);
+
+  /* Only relocatable images can run away from their link address. */
+  if (addr != hdr->linkaddr && !(hdr->flags & IMG_FLAG_RELOC))
+    return -1;
+
+  /* The image, with its .bss and stack, must fit in the application
+   * window. */
+  if (IMG_MEM_LEN(hdr) > RETAINED_ADDR - addr)
+    return -1;
+
+  if (hdr->flags & IMG_FLAG_PACKED) {
+#ifdef BOOT_PACKED
+    RetVal = BOOTUnpack(hFile, hdr, addr);
+#else
+    return -1;
+#endif
+  }
+  else {
+    RetVal = sl_FsRead(hFile, IMG_PAYLOAD_OFF(hdr), (unsigned char*) addr,
+        hdr->imglen);
+    if (RetVal != (int32_t) hdr->imglen)
+      return (0 > RetVal) ? RetVal : -1;
+
+    RetVal = BOOTCheckDigest(hdr, addr);
+  }
+
+  if (0 != RetVal)
+    return RetVal;
+
+  if (addr != hdr->linkaddr) {
+    RetVal = BOOTRelocate(hFile, hdr, addr);
+    if (0 != RetVal)
+      return RetVal;
+  }
+
+#ifdef BOOT_FILES
+  RetVal = BOOTLoadFiles(hFile, hdr, addr);
+  if (0 != RetVal)
+    return RetVal;
+#endif
+
+  /* Patched last, the digest and the relocations see the image as built. */
+  return PATCHApply(hFile, hdr, addr);
+}
+
+/*
+ * Publish the loaded image to the application.
+ */
+static void BOOTHandoff(uint32_t addr, uint32_t imglen, uint32_t trialms,
+    uint32_t flags) {
+  HANDOFF->base = addr;
+  HANDOFF->imglen = imglen;
+  HANDOFF->trialms = trialms ? trialms : BOOT_TRIAL_MS;
+  HANDOFF->trialid = 0;
+  HANDOFF->flags = flags;
+  HANDOFF->magic = HANDOFF_MAGIC;
+}
+
+/*
+ * Load an image from the serial flash to the SRAM at BASE_ADDR.
+ */
+int32_t BOOTLoadImg(imgtype_t img) {
+  return BOOTLoadImgAt(img, BASE_ADDR);
+}
+
+/*
+ * Load an image file to the SRAM at addr and publish it, without the
+ * checkpoint.
+ */
+static int32_t BOOTLoadImgFile(imgtype_t img, uint32_t addr, imghdr_t *hdr) {
+  int32_t hFile;
+  int32_t RetVal;
+  SlFsFileInfo_t FileInfo;
+  uint32_t imglen = 0;
+
+  HANDOFF->magic = 0;
+  HANDOFF->nfiles = 0;
+  HANDOFF->patches = 0;
+
+  /* Fails for a wrong image type too. */
+  RetVal = BOOTOpenImg(img, &hFile);
+  if (0 != RetVal)
     return RetVal;
 
+  /* The cache reads the tables at the end of the file up to its end. */
+  RetVal = sl_FsGetInfo(BOOTImgName(img), imgtoken, &FileInfo);
+  if (0 != RetVal) {
+    sl_FsClose(hFile, 0, 0, 0);
+    return RetVal;
+  }
+
+  BCACHESetLen(hFile, FileInfo.FileLen);
+
+  /* Check for an image header. */
+  RetVal = BCACHERead(hFile, 0, (unsigned char*) hdr, sizeof(imghdr_t));
+
+  if (((int32_t) sizeof(imghdr_t) == RetVal) && (IMG_MAGIC == hdr->magic)) {
+    imglen = hdr->imglen;
+    RetVal = BOOTLoadHdrImg(hFile, hdr, addr);
+  }
+  else if (BASE_ADDR != addr) {
+    /* Raw images are always linked for BASE_ADDR. */
+    RetVal = -1;
+  }
+  else {
+    /* Unlike 1.0.x raw images can't reach into the retained records (see
+     * RETAINED_ADDR). */
+    RetVal = (FileInfo.FileLen > RETAINED_ADDR - addr) ? -1 : 0;
+
+    if (0 == RetVal) {
+      /* Load the raw image to the SRAM, it has no header fields. */
+      memset(hdr, 0, sizeof(imghdr_t));
+      imglen = FileInfo.FileLen;
+      RetVal = sl_FsRead(hFile, 0, (unsigned char*) addr, imglen);
+      RetVal = (0 > RetVal) ? RetVal : 0;
+    }
+  }
+
   /* Close the handler. */
+  BCACHEInvalidate(hFile);
   sl_FsClose(hFile, 0, 0, 0);
 
+  if (0 != RetVal)
+    return RetVal;
+
+  BOOTHandoff(addr, imglen, hdr->trialms, hdr->flags);
+  return 0;
+}
+
+/*
+ * Load an image from the serial flash to the SRAM at addr.
+ * The image type must be IMG_FACTORY or IMG_CUSTOM.
+ */
+int32_t BOOTLoadImgAt(imgtype_t img, uint32_t addr) {
+  imghdr_t hdr;
+  int32_t RetVal;
+
+  /* Return error if wrong address is passed. */
+  if ((addr < BASE_ADDR) || (addr >= RETAINED_ADDR) || (addr & (IMG_ALIGN - 1)))
+    return -1;
+
+  CKPTReset();
+
+  RetVal = BOOTLoadImgFile(img, addr, &hdr);
+  if (0 != RetVal)
+    return RetVal;
+
+  /*
+   * A bad checkpoint may have overwritten the image. It is loaded once more
+   * without the checkpoint, even if deleting the file failed.
+   */
+  if (0 != CKPTRestore(&hdr, addr))
+    return BOOTLoadImgFile(img, addr, &hdr);
+
   /* Return success. */
   return 0;
 }
 
+/*
+ * Check an image file that is in SRAM at src and move its payload to addr.
+ */
+int32_t BOOTLoadMem(uint32_t src, uint32_t len, uint32_t addr) {
+  imghdr_t hdr;
+  int32_t RetVal;
+
+  if ((addr < BASE_ADDR) || (addr >= RETAINED_ADDR) || (addr & (IMG_ALIGN - 1))
+      || (src < BASE_ADDR) || (src >= RETAINED_ADDR)
+      || (len > RETAINED_ADDR - src))
+    return -1;
+
+  HANDOFF->magic = 0;
+  HANDOFF->nfiles = 0;
+  HANDOFF->patches = 0;
+
+  memset(&hdr, 0, sizeof(imghdr_t));
+
+  if ((len < sizeof(imghdr_t)) || (IMG_MAGIC != *(uint32_t*) src)) {
+    /* Raw images are always linked for BASE_ADDR. */
+    if (BASE_ADDR != addr)
+      return -1;
+
+    hdr.imglen = len;
+  }
+  else {
+    memcpy(&hdr, (void*) src, sizeof(imghdr_t));
+
+    if ((hdr.hdrlen < IMG_HDR_MINLEN) || (hdr.hdrlen > len))
+      return -1;
+
+    /* Fields unknown to an older header are 0. */
+    if (hdr.hdrlen < sizeof(imghdr_t))
+      memset((unsigned char*) &hdr + hdr.hdrlen, 0,
+          sizeof(imghdr_t) - hdr.hdrlen);
+
+    if ((IMG_PAYLOAD_OFF(&hdr) > len)
+        || (hdr.imglen > len - IMG_PAYLOAD_OFF(&hdr)))
+      return -1;
+
+    /* The relocations, the extra files and the codecs are not applied from
+     * SRAM. */
+    if ((addr != hdr.linkaddr) || (hdr.flags & IMG_FLAG_PACKED))
+      return -1;
+  }
+
+  if (IMG_MEM_LEN(&hdr) > RETAINED_ADDR - addr)
+    return -1;
+
+  /* Source and destination may overlap. */
+  memmove((void*) addr, (void*) (src + IMG_PAYLOAD_OFF(&hdr)), hdr.imglen);
+
+  RetVal = BOOTCheckDigest(&hdr, addr);
+  if (0 != RetVal)
+    return RetVal;
+
+  BOOTHandoff(addr, hdr.imglen, hdr.trialms, hdr.flags);
+  CKPTReset();
+  return 0;
+}
+
+/*
+ * Start the watchdog with the trial timeout.
+ */
+void BOOTArmTrial(uint32_t ms) {
+  uint32_t reload;
+
+  /*
+   * The first timeout only raises the interrupt, the SOC is reset on the
+   * second one. Split the trial time between both.
+   */
+  ms /= 2;
+  reload = (ms > 0xFFFFFFFF / WDT_TICKS_PER_MS) ? 0xFFFFFFFF :
+      ms * WDT_TICKS_PER_MS;
+
+  MAP_PRCMPeripheralClkEnable(PRCM_WDT, PRCM_RUN_MODE_CLK);
+  MAP_WatchdogUnlock(WDT_BASE);
+
+  /* Don't reset the board while it is halted by the debugger. */
+  MAP_WatchdogStallEnable(WDT_BASE);
+  MAP_WatchdogReloadSet(WDT_BASE, reload);
+  MAP_WatchdogEnable(WDT_BASE);
+}
+
 /*
  * Run an binary image file located at BaseAddr, in SRAM.
  */
@@ -42,9 +42,123 @@
  * OTA update must set the boot status to BOOT_CHECK and select the
  * IMG_CUSTOM in order to validate the new firmware.
  *
+ * boot.cfg stays a file of its own, not a key of the KV store (kv.h): a KV
+ * commit rewrites the whole live log, and the bootloader can't spare the RAM
+ * copy of the log.
+ *
+ * ### Trial boots
+ * When a new image is started with BOOT_CHECK, the bootloader arms the
+ * hardware watchdog with the trial timeout of the image (imghdr_t::trialms,
+ * BOOT_TRIAL_MS if not set). The application must confirm the image (see
+ * confirm.h) within this time. The watchdog can't be stopped through its
+ * registers once enabled, only by a reset of the peripheral
+ * (PRCMPeripheralReset(PRCM_WDT)), so the application must either keep
+ * clearing it (WatchdogIntClear) or reset it once confirmed. An image that
+ * hangs is reset by the watchdog and the next boot finds BOOT_CHECKING,
+ * rolling back to the factory image.
+ *
+ * The bootloader itself runs every boot stage under the watchdog with its
+ * own budget (see deadline.h) and resets the peripheral before the image is
+ * started, so the watchdog is only running in the application when
+ * BOOTArmTrial armed it for a trial.
+ *
+ * ### Image format
+ * An image file is either a raw binary linked for BASE_ADDR or a binary
+ * prefixed by an imghdr_t (see tools/mkimg.py). Images built with the
+ * IMG_FLAG_RELOC flag carry a relocation table after the payload and can be
+ * loaded at any IMG_ALIGN aligned address inside the application window
+ * (BOOTLoadImgAt). The address where the image was actually placed is
+ * published to the application in the boothandoff_t structure at
+ * HANDOFF_ADDR.
+ *
+ * ### Packed images
+ * With IMG_FLAG_PACKED the payload is split in IMG_CHUNK_SIZE chunks and
+ * each one is stored raw, run-length coded or LZ77 coded, whichever loads
+ * faster (tools/mkimg.py -z weighs the flash reads against the decoding).
+ * The payload starts with a table of imgchunk_t, one per chunk, followed by
+ * the chunks. The loader reads and unpacks one chunk at a time straight
+ * into its place (see unpack.h). A coded chunk is read first into the SRAM
+ * of the image past its place (imghdr_t::memlen), so the chunks that don't
+ * fit there, at the end of an image with little .bss, are stored raw.
+ *
+ * ### Integrity
+ * The header may carry a digest of the payload (imghdr_t::digestalg and
+ * imghdr_t::digest). It is checked after the payload is read and before it
+ * is relocated, and an image that doesn't match is not started. BLAKE2s
+ * (IMG_DIGEST_BLAKE2S, see blake2s.h) is used because it is much faster than
+ * SHA-256 in software on the Cortex-M4. The digest covers the payload as
+ * stored in the file (IMG_STORED_LEN bytes), so it is checked while a
+ * packed image is read, before it is unpacked.
+ * Images that only need to detect corruption can use the much cheaper
+ * Adler-32 instead (IMG_DIGEST_ADLER32, see cksum.h).
+ *
+ * ### Extra files
+ * The header may list up to BOOT_MAX_FILES extra files (imgfile_t), like
+ * calibration data or certificates, that are loaded in the same NWP session
+ * as the image, straight into SRAM buffers of the application. The
+ * destinations are relocated with the image. Their addresses and lengths are
+ * published in boothandoff_t::files, so the application doesn't need to start
+ * the NWP just to read them.
+ *
+ * A destination must be in the .noinit section of the application
+ * (imghdr_t::noinitaddr) or past the SRAM it uses (imghdr_t::memlen), since
+ * its C runtime clears the .bss before main. At most imgfile_t::maxlen bytes
+ * are read, and only as many as the file has.
+ *
+ * ### Per-device patches
+ * The header may declare up to BOOT_MAX_REGIONS patchable regions
+ * (imgregion_t), like a constants table of the application. After the image
+ * is checked and relocated, the records of the per-device patch file are
+ * written into those regions (see patch.h), so a single image serves every
+ * device. The result is published in boothandoff_t::patches.
+ *
+ * ### Checkpoints
+ * An application can save its initialized SRAM to a checkpoint bound to the
+ * digest of the image (see ckpt.h). When one matches the image just loaded,
+ * it is restored over the image and the application is entered at its resume
+ * function instead of its reset handler.
+ *
+ * ### Image slots
+ * The custom image is kept in one of two files, /sys/custom.bin (slot 0)
+ * and /sys/custom1.bin (slot 1), given by bootinfo_t::customslot. The
+ * other one is where the next update is written (see imgwr.h), so it can be
+ * allocated and erased ahead of the download. BOOTImgName(IMG_CUSTOM) is
+ * the file of the slot in the configuration last read or written: an
+ * application must read it (BOOTReadCfg) before using the custom image.
+ *
+ * ### Secure files
+ * Built with BOOT_SECURE, boot.cfg is created as a secure (encrypted by the
+ * NWP) fail-safe file. The images may be secure files created with a token,
+ * given at build time with BOOT_IMG_TOKEN and used for every image open.
+ * Opening a secure file costs more NWP time, so the read handle of boot.cfg
+ * is kept open from BOOTExistCfg until the file is written or BOOTClose is
+ * called, and the image is opened only once per load.
+ *
+ * ### Build options
+ * The bootloader must fit in 16KB of SRAM with its stack, so the features
+ * past the 1.0.x image format are only built when their symbol is defined:
+ * - BOOT_FILES: the extra files of the header.
+ * - BOOT_PACKED: packed images (see unpack.h).
+ * - BOOT_BLAKE2S: the BLAKE2s digest (see digest.h).
+ * - BOOT_PATCH: the per-device patches (see patch.h).
+ * - BOOT_CKPT: the checkpoints (see ckpt.h).
+ * - BOOT_STAGE: the images staged in SRAM (see stage.h).
+ * - BOOT_HIBSTATE: the state word kept over hibernation (see hibstate.h).
+ * - BOOT_BCACHE: the read cache (see bcache.h).
+ * - BOOT_WLAN: the NWP handover (see wlan.h).
+ * - BOOT_SECURE, BOOT_NETBOOT and BOOT_PROFILE, as before.
+ *
+ * Without them the extra files and the patches of a header are ignored, and
+ * packed images and BLAKE2s digests are refused. The application must be
+ * built with the same BOOT_CKPT and BOOT_STAGE as the bootloader.
+ *
  * ### Requires
  * - Driverlib;
  * - Simplelink (Can be the TINY build).
+ * - Cksum.
+ * - Digest.
+ * - BCache, Blake2s, Unpack, Patch, HibState and Ckpt, each with its build
+ *   option.
  *
  * ### Usage
  * First start the simplelink stack with an sl_Start(NULL, NULL, NULL) in
@@ -73,7 +187,6 @@
  * \date		01/2015
  * \copyright Akenge Engenharia
  *
- * \todo Add support for secure files.
  * \todo Load images different from custom.bin and factory.bin.
  * \todo Add ASSERT code to validate parameters.
  *
@@ -102,6 +215,245 @@
  */
 #define BASE_ADDR	0x20004000
 
+/*!
+ *	\def RETAINED_ADDR
+ *
+ * 	\brief Start of the SRAM area shared between the bootloader and the
+ * 	application.
+ *
+ * 	The last 2KB of the SRAM are never touched by the ROM loader or by the
+ * 	image loading, so they are used to pass information to the application.
+ * 	Applications must not link anything above this address: mkimg.py
+ * 	refuses an ELF that uses SRAM (.bss, heap and stack included) past it,
+ * 	and the loader checks imghdr_t::memlen against it.
+ *
+ * 	Raw images (without imghdr_t) are limited to RETAINED_ADDR too, where
+ * 	1.0.x loaded up to the end of the SRAM: the retained records written
+ * 	after the load would overwrite the end of a larger image. Such images
+ * 	must be rebuilt smaller or with mkimg.py.
+ *
+ * 	Layout:
+ * 	- HANDOFF_ADDR (+0x000): boothandoff_t.
+ * 	- CONFIRM_ADDR (+0x040): confirmation record (see confirm.h).
+ * 	- STAGE_ADDR (+0x060): staged image descriptor (see stage.h).
+ * 	- WLAN_ADDR (+0x090): NWP handover record (see wlan.h).
+ * 	- CKPT_ADDR (+0x0B0): checkpoint resume vector (see ckpt.h).
+ * 	- DEADLINE_ADDR (+0x100): boot deadline record (see deadline.h).
+ * 	- PROF_ADDR (+0x400): boot profiler samples (see prof.h).
+ */
+#define RETAINED_ADDR	0x2003F800
+
+/*!
+ *	\def IMG_ALIGN
+ *
+ * 	\brief Alignment required for the load address of an image.
+ *
+ * 	The application interrupt vector is used as the VTOR, which must be
+ * 	aligned to 1KB on the CC3200.
+ */
+#define IMG_ALIGN	0x400
+
+/*!
+ *	\def IMG_MAGIC
+ *
+ * 	\brief Magic number ("AIMG") that identifies an image with an imghdr_t.
+ */
+#define IMG_MAGIC	0x474D4941
+
+/*!
+ *	\def IMG_FLAG_RELOC
+ *
+ * 	\brief The image carries a relocation table and can be loaded at any
+ * 	address.
+ */
+#define IMG_FLAG_RELOC	0x0001
+
+/*!
+ *	\def IMG_FLAG_PACKED
+ *
+ * 	\brief The payload is stored in chunks, each one with its own codec.
+ */
+#define IMG_FLAG_PACKED	0x0002
+
+/*!
+ *	\def IMG_FLAG_WLAN
+ *
+ * 	\brief The application takes over the NWP running, already connecting
+ * 	(see wlan.h).
+ */
+#define IMG_FLAG_WLAN	0x0004
+
+/*!
+ *	\def IMG_CHUNK_SIZE
+ *
+ * 	\brief Unpacked size of the chunks of a packed payload (the last one may
+ * 	be shorter).
+ */
+#define IMG_CHUNK_SIZE	1024
+
+/*!
+ *	\def IMG_CODEC_RAW
+ *
+ * 	\brief The chunk is stored as is.
+ */
+#define IMG_CODEC_RAW	0
+
+/*!
+ *	\def IMG_CODEC_RLE
+ *
+ * 	\brief The chunk is run-length coded (see unpack.h).
+ */
+#define IMG_CODEC_RLE	1
+
+/*!
+ *	\def IMG_CODEC_LZ
+ *
+ * 	\brief The chunk is LZ77 coded (see unpack.h).
+ */
+#define IMG_CODEC_LZ	2
+
+/*!
+ *	\def RELOC_SKIP
+ *
+ * 	\brief Relocation entry that advances 0xFFFF words without relocating.
+ */
+#define RELOC_SKIP	0xFFFF
+
+/*!
+ *	\def IMG_HDR_MINLEN
+ *
+ * 	\brief Size of the first version of imghdr_t.
+ *
+ * 	Fields after the ones covered by imghdr_t::hdrlen are read as 0.
+ */
+#define IMG_HDR_MINLEN	20
+
+/*!
+ *	\def IMG_DIGEST_NONE
+ *
+ * 	\brief The image has no digest.
+ */
+#define IMG_DIGEST_NONE	0
+
+/*!
+ *	\def IMG_DIGEST_BLAKE2S
+ *
+ * 	\brief imghdr_t::digest is the BLAKE2s-256 of the payload.
+ */
+#define IMG_DIGEST_BLAKE2S	1
+
+/*!
+ *	\def IMG_DIGEST_ADLER32
+ *
+ * 	\brief The first 4 bytes of imghdr_t::digest are the Adler-32 of the
+ * 	payload (little endian), the other bytes are 0.
+ */
+#define IMG_DIGEST_ADLER32	2
+
+/*!
+ *	\def IMG_DIGEST_LEN
+ *
+ * 	\brief Size of imghdr_t::digest.
+ */
+#define IMG_DIGEST_LEN	32
+
+/*!
+ *	\def BOOT_IMG_TOKEN
+ *
+ * 	\brief Token used to open the image files.
+ *
+ * 	Needed when the images are secure files without public read access.
+ */
+#ifndef BOOT_IMG_TOKEN
+#define BOOT_IMG_TOKEN	0
+#endif
+
+/*!
+ *	\def BOOT_MAX_FILES
+ *
+ * 	\brief Maximum number of extra files loaded with an image.
+ */
+#define BOOT_MAX_FILES	4
+
+/*!
+ *	\def BOOT_MAX_REGIONS
+ *
+ * 	\brief Maximum number of patchable regions of an image.
+ */
+#define BOOT_MAX_REGIONS	4
+
+/*!
+ *	\def IMG_FILE_NAME_LEN
+ *
+ * 	\brief Size of the file name in imgfile_t (including the '\\0').
+ */
+#define IMG_FILE_NAME_LEN	40
+
+#ifndef BOOT_TRIAL_MS
+/*!
+ *	\def BOOT_TRIAL_MS
+ *
+ * 	\brief Default trial timeout in milliseconds.
+ */
+#define BOOT_TRIAL_MS	30000
+#endif
+
+/*!
+ * 	\def WDT_TICKS_PER_MS
+ *
+ * 	\brief Watchdog clock (80MHz) ticks per millisecond.
+ */
+#define WDT_TICKS_PER_MS	80000
+
+/*!
+ *	\def HANDOFF_MAGIC
+ *
+ * 	\brief Magic number ("HOFF") of a valid boothandoff_t.
+ */
+#define HANDOFF_MAGIC	0x46464F48
+
+/*!
+ *	\def HANDOFF_ADDR
+ *
+ * 	\brief Address of the boothandoff_t passed to the application.
+ */
+#define HANDOFF_ADDR	RETAINED_ADDR
+
+/*!
+ *	\def HANDOFF
+ *
+ * 	\brief Pointer to the boothandoff_t passed to the application.
+ */
+#define HANDOFF	((boothandoff_t*) HANDOFF_ADDR)
+
+/*!
+ *	\def CONFIRM_ADDR
+ *
+ * 	\brief Address of the retained confirmation record (see confirm.h).
+ */
+#define CONFIRM_ADDR	(RETAINED_ADDR + 0x40)
+
+/*!
+ *	\def CKPT_ADDR
+ *
+ * 	\brief Address of the retained checkpoint resume vector (see ckpt.h).
+ */
+#define CKPT_ADDR	(RETAINED_ADDR + 0xB0)
+
+/*!
+ *	\def STAGE_ADDR
+ *
+ * 	\brief Address of the retained staged image descriptor (see stage.h).
+ */
+#define STAGE_ADDR	(RETAINED_ADDR + 0x60)
+
+/*!
+ *	\def WLAN_ADDR
+ *
+ * 	\brief Address of the retained NWP handover record (see wlan.h).
+ */
+#define WLAN_ADDR	(RETAINED_ADDR + 0x90)
+
 /*!
  *	\enum bootstatus_t
  *
@@ -141,15 +493,189 @@ typedef struct {
   bootstatus_t status;
   /*! Type of the image to boot. */
   imgtype_t bootimg;
+  /*! Id of the current trial boot, set with BOOT_CHECKING. */
+  uint32_t trialid;
+  /*! SCRUB_BIT of the images found intact by the last scrub (see scrub.h). */
+  uint32_t scrubok;
+  /*! SCRUB_BIT of the images found damaged by the last scrub. */
+  uint32_t scrubbad;
+  /*! IPv4 address of the netboot server (see netboot.h), 0 to disable. */
+  uint32_t netaddr;
+  /*! TCP port of the netboot server. */
+  uint32_t netport;
+  /*! Slot of the custom image (0 or 1). */
+  uint32_t customslot;
 } bootinfo_t;
 
+/*!
+ *	\struct imghdr_t
+ *
+ *	\brief Header in front of the application binary.
+ *
+ *	The image file is the header, followed by the imgfile_t and imgregion_t
+ *	tables, followed by imglen bytes of payload (starting with the interrupt
+ *	vector) at IMG_PAYLOAD_OFF, followed by reloclen relocation entries.
+ *	hdrlen is only the size of the header, so a newer, longer imghdr_t can
+ *	still be told apart from the tables.
+ *
+ *	Each relocation entry is an uint16_t. The first entry is the index of the
+ *	first word to relocate and the next ones are the distance, in words, from
+ *	the previous relocated word. RELOC_SKIP advances 0xFFFF words without
+ *	relocating anything. Relocating a word means adding the difference between
+ *	the load address and linkaddr to it.
+ */
+typedef struct {
+  /*! Must be IMG_MAGIC. */
+  uint32_t magic;
+  /*! Size of the header (sizeof(imghdr_t) of the tool that built it). */
+  uint16_t hdrlen;
+  /*! IMG_FLAG_* bits. */
+  uint16_t flags;
+  /*! Address the image was linked for. */
+  uint32_t linkaddr;
+  /*! Length of the payload in bytes. */
+  uint32_t imglen;
+  /*! Number of relocation entries after the payload. */
+  uint32_t reloclen;
+  /*! Time for the image to confirm a trial boot in ms, 0 for BOOT_TRIAL_MS. */
+  uint32_t trialms;
+  /*! Offset of the imgfile_t table in the image file. */
+  uint32_t fileoff;
+  /*! Number of entries in the imgfile_t table (up to BOOT_MAX_FILES). */
+  uint32_t filecount;
+  /*! IMG_DIGEST_* algorithm of digest. */
+  uint32_t digestalg;
+  /*! Digest of the payload as stored in the file (before relocation). */
+  uint8_t digest[IMG_DIGEST_LEN];
+  /*! Length of the payload in the file, with IMG_FLAG_PACKED. */
+  uint32_t packlen;
+  /*! Offset of the imgregion_t table in the image file. */
+  uint32_t regionoff;
+  /*! Number of entries in the imgregion_t table (up to BOOT_MAX_REGIONS). */
+  uint32_t regioncount;
+  /*! SRAM used from the load address (payload, .bss, heap and stack), 0 if
+   *  only the payload is known. */
+  uint32_t memlen;
+  /*! Offset of the payload in the image file, 0 if right after the header. */
+  uint32_t payloadoff;
+  /*! Link address of the .noinit section of the application, the only
+   *  place below memlen where extra files can be loaded. */
+  uint32_t noinitaddr;
+  /*! Length of the .noinit section, 0 if none. */
+  uint32_t noinitlen;
+} imghdr_t;
+
+/*!
+ *	\def IMG_STORED_LEN
+ *
+ * 	\brief Length of the payload in the image file.
+ */
+#define IMG_STORED_LEN(hdr)	(((hdr)->flags & IMG_FLAG_PACKED) ? \
+    (hdr)->packlen : (hdr)->imglen)
+
+/*!
+ *	\def IMG_PAYLOAD_OFF
+ *
+ * 	\brief Offset of the payload in the image file.
+ */
+#define IMG_PAYLOAD_OFF(hdr)	((hdr)->payloadoff ? (hdr)->payloadoff : \
+    (hdr)->hdrlen)
+
+/*!
+ *	\def IMG_MEM_LEN
+ *
+ * 	\brief SRAM used by the image from its load address.
+ */
+#define IMG_MEM_LEN(hdr)	(((hdr)->memlen > (hdr)->imglen) ? \
+    (hdr)->memlen : (hdr)->imglen)
+
+/*!
+ *	\struct imgchunk_t
+ *
+ *	\brief Entry of the chunk table at the start of a packed payload.
+ */
+typedef struct {
+  /*! IMG_CODEC_* of the chunk. */
+  uint16_t codec;
+  /*! Length of the chunk in the file, at most IMG_CHUNK_SIZE. */
+  uint16_t len;
+} imgchunk_t;
+
+/*!
+ *	\struct imgfile_t
+ *
+ *	\brief Extra file to be loaded together with the image.
+ */
+typedef struct {
+  /*! Null terminated file name. */
+  char name[IMG_FILE_NAME_LEN];
+  /*! Destination in SRAM, relocated with the image. It must be in the
+   *  .noinit section or past the SRAM used by the image (imghdr_t::memlen),
+   *  anywhere else the C runtime of the application would clear it. */
+  uint32_t addr;
+  /*! Size of the destination buffer, longer files are cut. */
+  uint32_t maxlen;
+} imgfile_t;
+
+/*!
+ *	\struct imgregion_t
+ *
+ *	\brief Region of the image that can be patched per device.
+ */
+typedef struct {
+  /*! Link address of the region, word aligned. */
+  uint32_t addr;
+  /*! Length of the region in bytes. */
+  uint32_t len;
+} imgregion_t;
+
+/*!
+ *	\struct bootfile_t
+ *
+ *	\brief Extra file loaded by the bootloader, see boothandoff_t.
+ */
+typedef struct {
+  /*! Address where the file was loaded. */
+  uint32_t addr;
+  /*! Bytes loaded, or the (negative) SL error code. */
+  int32_t len;
+} bootfile_t;
+
+/*!
+ *	\struct boothandoff_t
+ *
+ *	\brief Information passed from the bootloader to the application.
+ *
+ *	Written at HANDOFF_ADDR right before the application is started.
+ */
+typedef struct {
+  /*! HANDOFF_MAGIC when the structure is valid. */
+  uint32_t magic;
+  /*! Address where the image was loaded. */
+  uint32_t base;
+  /*! Length of the loaded image in bytes. */
+  uint32_t imglen;
+  /*! Trial timeout of the image in ms. */
+  uint32_t trialms;
+  /*! Id of the trial boot (bootinfo_t::trialid), 0 if not on trial. */
+  uint32_t trialid;
+  /*! Number of entries in files. */
+  uint32_t nfiles;
+  /*! Extra files, in the order of the image header. */
+  bootfile_t files[BOOT_MAX_FILES];
+  /*! Patch records applied, or the (negative) error of the patch file. */
+  int32_t patches;
+  /*! IMG_FLAG_* bits of the image. */
+  uint32_t flags;
+} boothandoff_t;
+
 /*!
  *	\fn int32_t BOOTExistCfg(void)
  *
  * 	\brief Check if boot.cfg exists.
  *
- *	Uses the sl_FsGetInfo function to check whether boot.cfg exists in the
- * 	flash memory;
+ *	Opens boot.cfg for reading to check whether it exists in the flash memory.
+ *	The handle is kept open for BOOTReadCfg (see BOOTClose).
  *
  *	\return 1 if the file exists, 0 otherwise.
  */
@@ -188,7 +714,7 @@ int32_t BOOTDeleteCfg(void);
  * 	\brief Reads the boot.cfg file.
  *
  * 	Reads the file from flash and stores it in the structure pointed by
- * 	bootinfo.
+ * 	bootinfo. Fields missing in an older (shorter) file are set to 0.
  *
  * 	\param[out] bootinfo Structure to hold the boot.cfg file data.
  *
@@ -203,12 +729,80 @@ int32_t BOOTReadCfg(bootinfo_t *bootinfo);
  *
  * 	Writes the boot.cfg file with the contents of the bootinfo structure.
  *
+ * 	\note Not thread-safe, RTOS applications should use CFGWrite (cfg.h).
+ *
  * 	\param[in] bootinfo Structure that contains the boot.cfg file data.
  *
  * 	\return 0 on success, SL error code otherwise.
  */
 int32_t BOOTWriteCfg(bootinfo_t *bootinfo);
 
+/*!
+ *	\fn unsigned char *BOOTImgName(imgtype_t img)
+ *
+ * 	\brief Get the path of an image file.
+ *
+ * 	\param[in] img Image type.
+ *
+ * 	\return The file name, NULL for an unknown image type.
+ */
+unsigned char *BOOTImgName(imgtype_t img);
+
+/*!
+ *	\fn unsigned char *BOOTSlotName(uint32_t slot)
+ *
+ * 	\brief Get the path of a custom image slot.
+ *
+ * 	\param[in] slot Slot (0 or 1).
+ *
+ * 	\return The file name, NULL for an unknown slot.
+ */
+unsigned char *BOOTSlotName(uint32_t slot);
+
+/*!
+ *	\fn void BOOTSelectSlot(uint32_t slot)
+ *
+ * 	\brief Set the slot used for IMG_CUSTOM.
+ *
+ * 	Called with the configuration read or written, applications don't need
+ * 	it.
+ *
+ * 	\param[in] slot Slot (0 or 1).
+ */
+void BOOTSelectSlot(uint32_t slot);
+
+/*!
+ *	\fn uint32_t BOOTCustomSlot(void)
+ *
+ * 	\brief Get the slot used for IMG_CUSTOM.
+ *
+ * 	\return The slot.
+ */
+uint32_t BOOTCustomSlot(void);
+
+/*!
+ *	\fn int32_t BOOTOpenImg(imgtype_t img, int32_t *hFile)
+ *
+ * 	\brief Open an image file for reading.
+ *
+ * 	The file is opened with BOOT_IMG_TOKEN.
+ *
+ * 	\param[in] img Image type.
+ * 	\param[out] hFile File handle.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t BOOTOpenImg(imgtype_t img, int32_t *hFile);
+
+/*!
+ *	\fn void BOOTClose(void)
+ *
+ * 	\brief Close the files kept open by the boot functions.
+ *
+ * 	Must be called before the NWP is stopped.
+ */
+void BOOTClose(void);
+
 /*!
  *	\fn int32_t BOOTLoadImg(imgtype_t img)
  *
@@ -217,9 +811,46 @@ int32_t BOOTWriteCfg(bootinfo_t *bootinfo);
  * 	This function will load a custom firmware (custom.bin) or the factory
  * 	firmware (factory.bin) in the SRAM at position BASE_ADDR, depending on the
  * 	parameter img.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
  */
 int32_t BOOTLoadImg(imgtype_t img);
 
+/*!
+ *	\fn int32_t BOOTLoadImgAt(imgtype_t img, uint32_t addr)
+ *
+ * 	\brief Load an application image from the flash at a given address.
+ *
+ * 	Same as BOOTLoadImg, but the image is placed at addr. Only images with the
+ * 	IMG_FLAG_RELOC flag can be loaded at an address different from the one
+ * 	they were linked for. The relocations are applied while the table is read
+ * 	from the flash and the handoff structure is filled with the actual base.
+ *
+ * 	\param[in] img Image to load.
+ * 	\param[in] addr SRAM address, aligned to IMG_ALIGN.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t BOOTLoadImgAt(imgtype_t img, uint32_t addr);
+
+/*!
+ *	\fn int32_t BOOTLoadMem(uint32_t src, uint32_t len, uint32_t addr)
+ *
+ * 	\brief Load an image file that is already in the SRAM.
+ *
+ * 	The image file (header and payload) received or staged at src is moved
+ * 	to addr, its digest is checked and the handoff structure is filled. The
+ * 	image must be linked for addr: relocations and extra files are not
+ * 	applied.
+ *
+ * 	\param[in] src SRAM address of the image file.
+ * 	\param[in] len Length of the image file.
+ * 	\param[in] addr SRAM address to run the image, aligned to IMG_ALIGN.
+ *
+ * 	\return 0 on success, -1 otherwise.
+ */
+int32_t BOOTLoadMem(uint32_t src, uint32_t len, uint32_t addr);
+
 /*!
  *  \fn void BOOTRun(void* BaseAddr)
  *
@@ -233,6 +864,18 @@ int32_t BOOTLoadImg(imgtype_t img);
  */
 void BOOTRun(void* BaseAddr);
 
+/*!
+ *  \fn void BOOTArmTrial(uint32_t ms)
+ *
+ *  \brief Arm the watchdog for a trial boot.
+ *
+ *  Starts the hardware watchdog so the SOC is reset if the application
+ *  doesn't take care of it within ms milliseconds (about 107s max).
+ *
+ *   \param[in] ms Trial timeout in milliseconds.
+ */
+void BOOTArmTrial(uint32_t ms);
+
 #endif
 
 /*!
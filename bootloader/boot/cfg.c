@@ -0,0 +1,179 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Cfg
+ * \{
+ */
+
+/*!
+ * 	\file cfg.c
+ *
+ * 	\brief Implementation of the configuration service.
+ *
+ * 	This file implements the latched sequence counter around the
+ * 	configuration snapshot.
+ */
+
+#include <stdint.h>
+#include "boot.h"
+#include "cfg.h"
+
+/*! Sequence counter, odd while copy[0] is being written. */
+static volatile uint32_t seq;
+
+/*! The two copies of the snapshot, readers use copy[seq & 1]. */
+static bootinfo_t copy[2];
+
+/*! Set when the snapshot was loaded by CFGInit. */
+static volatile uint32_t ready;
+
+/*! Set while a task is in CFGWrite. */
+static volatile uint32_t writer;
+
+/*! Service counters. */
+static cfgstats_t stats;
+
+/*
+ * Publish a new snapshot, only called by the writer.
+ */
+static void CFGPublish(bootinfo_t *bootinfo) {
+  seq++;
+  __sync_synchronize();
+  copy[0] = *bootinfo;
+  __sync_synchronize();
+  seq++;
+  __sync_synchronize();
+  copy[1] = *bootinfo;
+  __sync_synchronize();
+}
+
+/*
+ * Load the snapshot from the flash.
+ */
+int32_t CFGInit() {
+  bootinfo_t bootinfo;
+  int32_t RetVal;
+
+  RetVal = BOOTReadCfg(&bootinfo);
+  if (0 != RetVal)
+    return RetVal;
+
+  CFGPublish(&bootinfo);
+  ready = 1;
+
+  return 0;
+}
+
+/*
+ * Copy the snapshot, again if the writer went through both copies meanwhile.
+ */
+int32_t CFGRead(bootinfo_t *bootinfo) {
+  uint32_t start;
+
+  if (!ready)
+    return -1;
+
+  stats.reads++;
+
+  for (;;) {
+    start = seq;
+    __sync_synchronize();
+    *bootinfo = copy[start & 1];
+    __sync_synchronize();
+
+    if (start == seq)
+      return 0;
+
+    stats.retries++;
+  }
+}
+
+/*
+ * Write the file first, then publish the snapshot.
+ */
+int32_t CFGWrite(bootinfo_t *bootinfo) {
+  int32_t RetVal;
+
+  if (!ready)
+    return -1;
+
+  if (__sync_lock_test_and_set(&writer, 1)) {
+    stats.busy++;
+    return CFG_BUSY;
+  }
+
+  RetVal = BOOTWriteCfg(bootinfo);
+  if (0 == RetVal) {
+    CFGPublish(bootinfo);
+    stats.writes++;
+  }
+
+  __sync_lock_release(&writer);
+
+  return RetVal;
+}
+
+/*
+ * Apply the change to the snapshot under the writer lock.
+ */
+int32_t CFGUpdate(cfgedit_t edit, void *arg) {
+  bootinfo_t bootinfo;
+  int32_t RetVal;
+
+  if (!ready)
+    return -1;
+
+  if (__sync_lock_test_and_set(&writer, 1)) {
+    stats.busy++;
+    return CFG_BUSY;
+  }
+
+  /* Only the writer changes the snapshot, copy[1] is stable. */
+  bootinfo = copy[1];
+
+  RetVal = edit(&bootinfo, arg);
+  if (0 == RetVal) {
+    RetVal = BOOTWriteCfg(&bootinfo);
+    if (0 == RetVal) {
+      CFGPublish(&bootinfo);
+      stats.writes++;
+    }
+  }
+
+  __sync_lock_release(&writer);
+
+  return RetVal;
+}
+
+/*
+ * Get the counters.
+ */
+void CFGStats(cfgstats_t *cfgstats) {
+  *cfgstats = stats;
+}
+
+/*!
+ * \}
+ */
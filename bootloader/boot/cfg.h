@@ -0,0 +1,219 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Cfg Cfg
+ * \{
+ *
+ * \brief Thread-safe access to the boot configuration for applications.
+ *
+ * ### Overview
+ * BOOTReadCfg and BOOTWriteCfg open boot.cfg on every call and have no
+ * synchronization, which is fine for the bootloader but not for an RTOS
+ * application where several tasks (OTA, telemetry, watchdog) use the
+ * configuration. This module keeps a snapshot of the configuration in SRAM:
+ *
+ * - Readers copy the snapshot with CFGRead, without locks and without
+ *   talking to the NWP.
+ * - A single writer at a time updates it with CFGWrite. The file is written
+ *   first and the snapshot is only published after the write succeeded, so
+ *   readers never see a value that is not in the flash. If another task is
+ *   already writing, CFGWrite returns CFG_BUSY without waiting.
+ * - A change of a few fields is made with CFGUpdate, which applies it to the
+ *   snapshot under the same writer lock. Copying the configuration with
+ *   CFGRead and writing it back with CFGWrite would lose the changes other
+ *   tasks made in between.
+ *
+ * The scrubber (Scrub) and the image writer (ImgWr) update the
+ * configuration through CFGUpdate too, so they can run in tasks of their own.
+ *
+ * The snapshot is protected by a sequence counter and kept in two copies
+ * (a "latch"): while the writer updates one copy, readers use the other one.
+ * The writer bumps the counter before each of the two copies, and a reader
+ * retries whenever the counter changed while it was copying, so an update
+ * can cost a reader up to two retries. Each retry copies the snapshot the
+ * writer is not touching, so a high priority reader never spins waiting for
+ * a preempted writer.
+ *
+ * CFGStats counts the reads, the read retries, the writes and the writers
+ * turned away, to check the contention on the target. The read counters are
+ * not atomic and may miss a few concurrent reads.
+ *
+ * ### Requires
+ * - Boot.
+ *
+ * ### Usage
+ * Call CFGInit once before starting the tasks that use the configuration.
+ * Writers that must not lose an update retry while CFGWrite returns
+ * CFG_BUSY, or wrap it in a mutex of the RTOS.
+ *
+ * ### Example
+ *
+ * \code
+ *  bootinfo_t bootinfo;
+ *
+ *  CFGInit();
+ *
+ *  // In any task.
+ *  CFGRead(&bootinfo);
+ *  if (BOOT_CHECKING == bootinfo.status)
+ *    while (CFG_BUSY == CFGUpdate(Confirm, NULL))
+ *      osi_Sleep(1);
+ *
+ *  // With Confirm:
+ *  static int32_t Confirm(bootinfo_t *bootinfo, void *arg) {
+ *    if (BOOT_CHECKING != bootinfo->status)
+ *      return CFG_UNCHANGED;
+ *
+ *    bootinfo->status = BOOT_OK;
+ *    return 0;
+ *  }
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _CFG_H_
+#define _CFG_H_
+
+/*!
+ *	\file cfg.h
+ *
+ *	\brief Constants, types and function prototypes of the configuration
+ *	service.
+ *
+ *	This file contains definitions used by the cfg.c.
+ */
+
+/*!
+ *	\def CFG_BUSY
+ *
+ * 	\brief Returned by CFGWrite and CFGUpdate when another task is writing.
+ */
+#define CFG_BUSY	(-2)
+
+/*!
+ *	\def CFG_UNCHANGED
+ *
+ * 	\brief Returned by a cfgedit_t that has nothing to write.
+ */
+#define CFG_UNCHANGED	1
+
+/*!
+ *	\typedef cfgedit_t
+ *
+ * 	\brief Change made by CFGUpdate to the current configuration.
+ *
+ * 	Returns 0 to write the changed configuration, anything else to leave it
+ * 	as it is; CFGUpdate returns that value. Called with the writer lock held,
+ * 	must not call the configuration service.
+ */
+typedef int32_t (*cfgedit_t)(bootinfo_t *bootinfo, void *arg);
+
+/*!
+ *	\struct cfgstats_t
+ *
+ *	\brief Counters of the configuration service.
+ */
+typedef struct {
+  /*! Calls to CFGRead. */
+  uint32_t reads;
+  /*! Times a reader had to copy the snapshot again. */
+  uint32_t retries;
+  /*! Successful calls to CFGWrite and CFGUpdate that wrote the file. */
+  uint32_t writes;
+  /*! Calls to CFGWrite and CFGUpdate that returned CFG_BUSY. */
+  uint32_t busy;
+} cfgstats_t;
+
+/*!
+ *	\fn int32_t CFGInit(void)
+ *
+ * 	\brief Load the configuration snapshot.
+ *
+ * 	Reads the configuration with BOOTReadCfg. Must be called before any task
+ * 	uses the configuration service, Scrub or ImgWr.
+ *
+ * 	\return 0 on success, SL error code otherwise.
+ */
+int32_t CFGInit(void);
+
+/*!
+ *	\fn int32_t CFGRead(bootinfo_t *bootinfo)
+ *
+ * 	\brief Get a consistent copy of the configuration.
+ *
+ * 	Lock free, can be called from any task or interrupt handler.
+ *
+ * 	\param[out] bootinfo Structure to hold the configuration.
+ *
+ * 	\return 0 on success, -1 if CFGInit was not called.
+ */
+int32_t CFGRead(bootinfo_t *bootinfo);
+
+/*!
+ *	\fn int32_t CFGWrite(bootinfo_t *bootinfo)
+ *
+ * 	\brief Write the configuration and publish it to the readers.
+ *
+ * 	\param[in] bootinfo New configuration.
+ *
+ * 	\return 0 on success, CFG_BUSY if another task is writing, SL error code
+ * 	or -1 otherwise.
+ */
+int32_t CFGWrite(bootinfo_t *bootinfo);
+
+/*!
+ *	\fn int32_t CFGUpdate(cfgedit_t edit, void *arg)
+ *
+ * 	\brief Change the current configuration, write it and publish it.
+ *
+ * 	The read, the change and the write are made with the writer lock held,
+ * 	so no update of another task is lost.
+ *
+ * 	\param[in] edit Function that changes the configuration.
+ * 	\param[in] arg Argument passed to edit.
+ *
+ * 	\return 0 on success, the value returned by edit if it is not 0,
+ * 	CFG_BUSY if another task is writing, SL error code or -1 otherwise.
+ */
+int32_t CFGUpdate(cfgedit_t edit, void *arg);
+
+/*!
+ *	\fn void CFGStats(cfgstats_t *cfgstats)
+ *
+ * 	\brief Get the counters of the configuration service.
+ *
+ * 	\param[out] cfgstats Structure to hold the counters.
+ */
+void CFGStats(cfgstats_t *cfgstats);
+
+#endif
+
+/*!
+ * \}
+ */
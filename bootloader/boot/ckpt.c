@@ -0,0 +1,272 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Ckpt
+ * \{
+ */
+
+/*!
+ * 	\file ckpt.c
+ *
+ * 	\brief Implementation of the checkpoints.
+ *
+ * 	This file saves the application state to the flash and restores it at
+ * 	boot.
+ */
+
+#ifdef BOOT_CKPT
+
+#include <stdint.h>
+#include <string.h>
+#include "hw_types.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "cksum.h"
+#include "ckpt.h"
+#include "fs.h"
+
+/*!
+ * 	\var static unsigned char ckptfile[]
+ *
+ * 	\brief Path of the checkpoint file.
+ *
+ * 	The file is saved as /sys/ckpt.bin.
+ */
+static unsigned char ckptfile[] = "/sys/ckpt.bin";
+
+/*!
+ * 	\def CKPT_BUF_SIZE
+ *
+ * 	\brief Bytes copied at once by CKPTSave.
+ */
+#define CKPT_BUF_SIZE	256
+
+/*
+ * Check that the regions are between start and end, the SRAM of the image
+ * past its payload.
+ */
+static int32_t CKPTCheckRegions(const ckptregion_t *regions, uint32_t count,
+    uint32_t start, uint32_t end) {
+  uint32_t i;
+
+  if ((0 == count) || (count > CKPT_MAX_REGIONS) || (end > RETAINED_ADDR))
+    return -1;
+
+  for (i = 0; i < count; i++) {
+    if ((regions[i].addr < start) || (regions[i].addr >= end)
+        || (regions[i].len > end - regions[i].addr))
+      return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Read the regions in place, checking them against the header.
+ */
+static int32_t CKPTReadRegions(int32_t hFile, const ckpthdr_t *chdr) {
+  uint32_t adler = CKSUM_ADLER_INIT;
+  uint32_t offset = sizeof(ckpthdr_t);
+  uint32_t i;
+  int32_t RetVal;
+
+  for (i = 0; i < chdr->count; i++) {
+    RetVal = sl_FsRead(hFile, offset, (unsigned char*) chdr->regions[i].addr,
+        chdr->regions[i].len);
+    if ((int32_t) chdr->regions[i].len != RetVal)
+      return (0 > RetVal) ? RetVal : -1;
+
+    adler = CKSUMAdler32(adler, (const uint8_t*) chdr->regions[i].addr,
+        chdr->regions[i].len);
+    offset += chdr->regions[i].len;
+  }
+
+  return (adler == chdr->check) ? 0 : -1;
+}
+
+/*
+ * Forget the previous boot.
+ */
+void CKPTReset(void) {
+  CKPT->entry = 0;
+  CKPT->ticks = 0;
+  CKPT->alg = IMG_DIGEST_NONE;
+}
+
+/*
+ * Overlay the saved regions on the image just loaded.
+ */
+int32_t CKPTRestore(const imghdr_t *hdr, uint32_t addr) {
+  uint32_t start = (uint32_t) MAP_PRCMSlowClkCtrGet();
+  ckpthdr_t chdr;
+  int32_t hFile;
+  int32_t RetVal;
+
+  /* Only an image with a digest can be told from the next one. */
+  if (IMG_DIGEST_NONE == hdr->digestalg)
+    return 0;
+
+  memcpy((void*) CKPT->digest, hdr->digest, IMG_DIGEST_LEN);
+  CKPT->memend = addr + IMG_MEM_LEN(hdr);
+  CKPT->alg = hdr->digestalg;
+
+  RetVal = sl_FsOpen(ckptfile, FS_MODE_OPEN_READ, NULL, &hFile);
+  if (0 != RetVal)
+    return 0;
+
+  RetVal = sl_FsRead(hFile, 0, (unsigned char*) &chdr, sizeof(ckpthdr_t));
+
+  if (((int32_t) sizeof(ckpthdr_t) != RetVal) || (CKPT_MAGIC != chdr.magic)
+      || (hdr->digestalg != chdr.alg)
+      || (0 != memcmp(hdr->digest, chdr.digest, IMG_DIGEST_LEN))
+      || (addr != chdr.base) || (hdr->imglen != chdr.imglen)) {
+    /* Saved by another image, kept until the application replaces it. */
+    sl_FsClose(hFile, NULL, NULL, 0);
+    return 0;
+  }
+
+  /* Same checks as CKPTSave, nothing was overwritten yet. */
+  if ((chdr.resume < addr) || (chdr.resume - addr >= hdr->imglen)
+      || (0 != CKPTCheckRegions(chdr.regions, chdr.count,
+          addr + hdr->imglen, CKPT->memend))) {
+    sl_FsClose(hFile, NULL, NULL, 0);
+    sl_FsDel(ckptfile, 0);
+    return 0;
+  }
+
+  RetVal = CKPTReadRegions(hFile, &chdr);
+
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  if (0 != RetVal) {
+    /* The image may be overwritten already, it must be loaded again. */
+    sl_FsDel(ckptfile, 0);
+    return -1;
+  }
+
+  CKPT->sp = *(uint32_t*) addr;
+  CKPT->entry = chdr.resume;
+  CKPT->ticks = (uint32_t) MAP_PRCMSlowClkCtrGet() - start;
+  return 0;
+}
+
+/*
+ * Resume vector or image vector.
+ */
+uint32_t CKPTEntry(void) {
+  return CKPT->entry ? CKPT_ADDR : HANDOFF->base;
+}
+
+/*
+ * Write the regions, then the header that makes them valid.
+ */
+int32_t CKPTSave(const ckptregion_t *regions, uint32_t count,
+    void (*resume)(void)) {
+  unsigned char buf[CKPT_BUF_SIZE];
+  ckpthdr_t chdr;
+  uint32_t offset = sizeof(ckpthdr_t);
+  uint32_t done;
+  uint32_t n;
+  uint32_t i;
+  int32_t hFile;
+  int32_t RetVal;
+
+  if ((IMG_DIGEST_NONE == CKPT->alg) || (HANDOFF_MAGIC != HANDOFF->magic)
+      || ((uint32_t) resume < HANDOFF->base)
+      || ((uint32_t) resume - HANDOFF->base >= HANDOFF->imglen)
+      || (0 != CKPTCheckRegions(regions, count,
+          HANDOFF->base + HANDOFF->imglen, CKPT->memend)))
+    return -1;
+
+  memset(&chdr, 0, sizeof(ckpthdr_t));
+  chdr.magic = CKPT_MAGIC;
+  chdr.alg = CKPT->alg;
+  memcpy(chdr.digest, (void*) CKPT->digest, IMG_DIGEST_LEN);
+  chdr.base = HANDOFF->base;
+  chdr.imglen = HANDOFF->imglen;
+  chdr.resume = (uint32_t) resume;
+  chdr.count = count;
+  chdr.check = CKSUM_ADLER_INIT;
+  memcpy(chdr.regions, regions, count * sizeof(ckptregion_t));
+
+  for (i = 0; i < count; i++)
+    offset += regions[i].len;
+
+  /* The size of a file is fixed when it is created. */
+  sl_FsDel(ckptfile, 0);
+
+  RetVal = sl_FsOpen(ckptfile,
+      FS_MODE_OPEN_CREATE(offset, _FS_FILE_PUBLIC_WRITE | _FS_FILE_PUBLIC_READ),
+      NULL, &hFile);
+  if (0 != RetVal)
+    return RetVal;
+
+  offset = sizeof(ckpthdr_t);
+
+  for (i = 0; (i < count) && (0 == RetVal); i++) {
+    for (done = 0; (done < regions[i].len) && (0 == RetVal); done += n) {
+      n = regions[i].len - done;
+      if (n > CKPT_BUF_SIZE)
+        n = CKPT_BUF_SIZE;
+
+      /* The copy is what gets checked, even if the region keeps changing. */
+      memcpy(buf, (void*) (regions[i].addr + done), n);
+      chdr.check = CKSUMAdler32(chdr.check, buf, n);
+
+      RetVal = sl_FsWrite(hFile, offset, buf, n);
+      RetVal = ((int32_t) n == RetVal) ? 0 : ((0 > RetVal) ? RetVal : -1);
+      offset += n;
+    }
+  }
+
+  if (0 == RetVal) {
+    RetVal = sl_FsWrite(hFile, 0, (unsigned char*) &chdr, sizeof(ckpthdr_t));
+    RetVal = ((int32_t) sizeof(ckpthdr_t) == RetVal) ? 0 :
+        ((0 > RetVal) ? RetVal : -1);
+  }
+
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  if (0 != RetVal)
+    sl_FsDel(ckptfile, 0);
+
+  return RetVal;
+}
+
+/*
+ * Delete the checkpoint.
+ */
+void CKPTClear(void) {
+  sl_FsDel(ckptfile, 0);
+}
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,260 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Ckpt Ckpt
+ * \{
+ *
+ * \brief Checkpoint of the initialized application, restored at boot.
+ *
+ * ### Overview
+ * Some applications take longer to initialize (tables, certificates,
+ * stacks) than the bootloader takes to load them. Once initialized, such an
+ * application calls CKPTSave with the SRAM regions that hold its state
+ * (usually .bss and the heap) and a resume function. The regions are
+ * written to /sys/ckpt.bin, bound to the image by its whole digest (the
+ * image must be built with mkimg.py -d) and its load address.
+ *
+ * The regions must be past the payload and inside the SRAM of the image
+ * (imghdr_t::memlen): the code, the constants and the .data are checked
+ * against the digest and are never overwritten by a checkpoint. State kept
+ * in initialized variables starts from the values of the build.
+ *
+ * On the next boot, after the image is loaded, checked, relocated and
+ * patched, CKPTRestore reads the regions back over it and main enters the
+ * image through the resume vector at CKPT_ADDR: the stack pointer of the
+ * image and the resume function, instead of the reset handler. The resume
+ * function starts on a fresh stack and must set up the peripherals again,
+ * only the SRAM is restored. A checkpoint whose resume function is out of
+ * the payload, or whose regions are out of the SRAM past it, is deleted
+ * without being read. One that fails its
+ * Adler-32 check is deleted and the image is loaded again, once, as if there
+ * was none.
+ *
+ * A new image has a new digest, so its first boot is a normal one. An
+ * application whose saved state goes stale for other reasons (new patch file,
+ * new settings) calls CKPTClear.
+ *
+ * ckptvector_t::ticks holds the time the restore took, to be compared with
+ * the time of the initialization it replaced.
+ *
+ * Checkpoints are only built with BOOT_CKPT defined, in the bootloader and
+ * in the application. Without it the functions are macros: nothing is
+ * restored and CKPTSave fails.
+ *
+ * ### Requires
+ * - Driverlib;
+ * - Simplelink (Can be the TINY build).
+ * - Boot.
+ * - Cksum.
+ *
+ * ### Example
+ *
+ * \code
+ *  extern uint32_t __bss_start__, __heap_end__;
+ *
+ *  static void Resume(void) {
+ *    BoardInit();
+ *    MainLoop();
+ *  }
+ *
+ *  int main(void) {
+ *    ckptregion_t state = { (uint32_t) &__bss_start__,
+ *        (uint32_t) &__heap_end__ - (uint32_t) &__bss_start__ };
+ *
+ *    BoardInit();
+ *    SlowInit();
+ *    CKPTSave(&state, 1, Resume);
+ *    MainLoop();
+ *  }
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _CKPT_H_
+#define _CKPT_H_
+
+/*!
+ *	\file ckpt.h
+ *
+ *	\brief Constants, types and function prototypes of the checkpoints.
+ *
+ *	This file contains definitions used by the ckpt.c.
+ */
+
+/*!
+ *	\def CKPT_MAGIC
+ *
+ * 	\brief Magic number ("CKPT") of a checkpoint file.
+ */
+#define CKPT_MAGIC	0x54504B43
+
+/*!
+ *	\def CKPT_MAX_REGIONS
+ *
+ * 	\brief Maximum number of regions in a checkpoint.
+ */
+#define CKPT_MAX_REGIONS	4
+
+/*!
+ *	\struct ckptregion_t
+ *
+ *	\brief SRAM region saved in a checkpoint.
+ */
+typedef struct {
+  /*! Start address. */
+  uint32_t addr;
+  /*! Length in bytes. */
+  uint32_t len;
+} ckptregion_t;
+
+/*!
+ *	\struct ckpthdr_t
+ *
+ *	\brief Header of the checkpoint file, followed by the region contents.
+ */
+typedef struct {
+  /*! Must be CKPT_MAGIC. */
+  uint32_t magic;
+  /*! Digest algorithm of the image that saved it. */
+  uint32_t alg;
+  /*! Digest of the image that saved it. */
+  uint8_t digest[IMG_DIGEST_LEN];
+  /*! Address where the image was loaded. */
+  uint32_t base;
+  /*! Length of the image payload. */
+  uint32_t imglen;
+  /*! Address of the resume function. */
+  uint32_t resume;
+  /*! Number of entries in regions. */
+  uint32_t count;
+  /*! Saved regions, in the file order. */
+  ckptregion_t regions[CKPT_MAX_REGIONS];
+  /*! Adler-32 of the region contents (see cksum.h). */
+  uint32_t check;
+} ckpthdr_t;
+
+/*!
+ *	\struct ckptvector_t
+ *
+ *	\brief Resume vector at CKPT_ADDR, laid out like an interrupt vector.
+ */
+typedef struct {
+  /*! Initial stack pointer of the image. */
+  uint32_t sp;
+  /*! Resume function, 0 when no checkpoint was restored. */
+  uint32_t entry;
+  /*! Slow clock (32768Hz) ticks taken by the restore. */
+  uint32_t ticks;
+  /*! End of the SRAM of the loaded image. */
+  uint32_t memend;
+  /*! Digest algorithm of the loaded image, IMG_DIGEST_NONE if it can't be
+   * checkpointed. */
+  uint32_t alg;
+  /*! Digest of the loaded image. */
+  uint8_t digest[IMG_DIGEST_LEN];
+} ckptvector_t;
+
+/*!
+ *	\def CKPT
+ *
+ * 	\brief Pointer to the retained resume vector.
+ */
+#define CKPT	((volatile ckptvector_t*) CKPT_ADDR)
+
+#ifdef BOOT_CKPT
+
+/*!
+ *	\fn void CKPTReset(void)
+ *
+ * 	\brief Forget the vector of the previous boot, before an image is loaded.
+ */
+void CKPTReset(void);
+
+/*!
+ *	\fn int32_t CKPTRestore(const imghdr_t *hdr, uint32_t addr)
+ *
+ * 	\brief Restore the checkpoint of the image loaded at addr, if any.
+ *
+ * 	\param[in] hdr Header of the image.
+ * 	\param[in] addr Address where the image was loaded.
+ *
+ * 	\return 0 if restored or if there is nothing to restore, -1 if a bad
+ * 	checkpoint was deleted after overwriting the image.
+ */
+int32_t CKPTRestore(const imghdr_t *hdr, uint32_t addr);
+
+/*!
+ *	\fn uint32_t CKPTEntry(void)
+ *
+ * 	\brief Vector to pass to BOOTRun.
+ *
+ * 	\return CKPT_ADDR after a restore, the image base otherwise.
+ */
+uint32_t CKPTEntry(void);
+
+/*!
+ *	\fn int32_t CKPTSave(const ckptregion_t *regions, uint32_t count, void (*resume)(void))
+ *
+ * 	\brief Save a checkpoint of the running application.
+ *
+ * 	The NWP must be running.
+ *
+ * 	\param[in] regions SRAM regions to save, past the payload and inside the
+ * 	SRAM of the image.
+ * 	\param[in] count Number of regions (up to CKPT_MAX_REGIONS).
+ * 	\param[in] resume Function entered instead of the reset handler.
+ *
+ * 	\return 0 on success, -1 if the image can't be checkpointed or the SL
+ * 	error code.
+ */
+int32_t CKPTSave(const ckptregion_t *regions, uint32_t count,
+    void (*resume)(void));
+
+/*!
+ *	\fn void CKPTClear(void)
+ *
+ * 	\brief Delete the checkpoint.
+ */
+void CKPTClear(void);
+
+#else
+
+#define CKPTReset()
+#define CKPTRestore(hdr, addr)	0
+#define CKPTEntry()	(HANDOFF->base)
+#define CKPTSave(regions, count, resume)	(-1)
+#define CKPTClear()
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Cksum
+ * \{
+ */
+
+/*!
+ * 	\file cksum.c
+ *
+ * 	\brief Implementation of the checksum.
+ *
+ * 	This file implements Adler-32, with a word loop for the Cortex-M4.
+ */
+
+#include <stdint.h>
+#include "cksum.h"
+
+/*! Adler-32 modulus, the largest prime below 2^16. */
+#define CKSUM_BASE	65521
+
+#if defined(__ARM_ARCH_7EM__)
+
+/*
+ * Add the four bytes of w to a, and their position weighted sum to b.
+ */
+static inline void CKSUMWord(uint32_t w, uint32_t *a, uint32_t *b) {
+  uint32_t lo, hi;
+
+  /* Four times the sum before the word. */
+  *b += *a << 2;
+
+  __asm(
+      "usada8	%[a], %[w], %[zero], %[a]\n\t"
+      "uxtb16	%[lo], %[w]\n\t"
+      "uxtb16	%[hi], %[w], ror #8\n\t"
+      "smlad	%[b], %[lo], %[k02], %[b]\n\t"
+      "smlad	%[b], %[hi], %[k13], %[b]\n\t"
+      : [a] "+r" (*a), [b] "+r" (*b), [lo] "=&r" (lo), [hi] "=&r" (hi)
+      : [w] "r" (w), [zero] "r" (0), [k02] "r" (0x00020004),
+        [k13] "r" (0x00010003)
+  );
+}
+
+#endif
+
+/*
+ * Sums are only reduced every CKSUM_NMAX bytes.
+ */
+uint32_t CKSUMAdler32(uint32_t adler, const uint8_t *data, uint32_t len) {
+  uint32_t a = adler & 0xFFFF;
+  uint32_t b = adler >> 16;
+  uint32_t n;
+
+  while (len) {
+    n = (len < CKSUM_NMAX) ? len : CKSUM_NMAX;
+    len -= n;
+
+#if defined(__ARM_ARCH_7EM__)
+    /* Bytes up to the first aligned word. */
+    while (n && ((uint32_t) data & 3)) {
+      a += *data++;
+      b += a;
+      n--;
+    }
+
+    while (n >= 4) {
+      CKSUMWord(*(const uint32_t*) data, &a, &b);
+      data += 4;
+      n -= 4;
+    }
+#endif
+
+    while (n--) {
+      a += *data++;
+      b += a;
+    }
+
+    a %= CKSUM_BASE;
+    b %= CKSUM_BASE;
+  }
+
+  return (b << 16) | a;
+}
+
+/*!
+ * \}
+ */
@@ -0,0 +1,100 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Cksum Cksum
+ * \{
+ *
+ * \brief Adler-32 checksum using the Cortex-M4 SIMD instructions.
+ *
+ * ### Overview
+ * Images that only need to detect corruption (not tampering) can be checked
+ * with Adler-32 (IMG_DIGEST_ADLER32), which is much cheaper than a digest
+ * or a table CRC32 and needs no table in SRAM: about 3 cycles per byte on
+ * the Cortex-M4, against 10 for a table CRC32 and 34 for BLAKE2s.
+ *
+ * On the Cortex-M4 aligned data is processed one word at a time: USADA8
+ * adds the four bytes to the first sum and two SMLAD over the halves split
+ * by UXTB16 add the position weighted bytes (4, 3, 2, 1) to the second sum.
+ * The modulo is only taken every CKSUM_NMAX bytes. The result is the
+ * standard (zlib) Adler-32, so the same value is computed by the byte wise
+ * C code used on other targets, and by tools/mkimg.py.
+ *
+ * ### Example
+ *
+ * \code
+ *  uint32_t adler = CKSUM_ADLER_INIT;
+ *
+ *  adler = CKSUMAdler32(adler, data, len);
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _CKSUM_H_
+#define _CKSUM_H_
+
+/*!
+ *	\file cksum.h
+ *
+ *	\brief Constants and function prototypes of the checksum.
+ *
+ *	This file contains definitions used by the cksum.c.
+ */
+
+/*!
+ *	\def CKSUM_ADLER_INIT
+ *
+ * 	\brief Initial value of an Adler-32 checksum.
+ */
+#define CKSUM_ADLER_INIT	1
+
+/*!
+ *	\def CKSUM_NMAX
+ *
+ * 	\brief Bytes that can be added before the sums may overflow 32 bits.
+ */
+#define CKSUM_NMAX	5552
+
+/*!
+ *	\fn uint32_t CKSUMAdler32(uint32_t adler, const uint8_t *data, uint32_t len)
+ *
+ * 	\brief Update an Adler-32 checksum.
+ *
+ * 	\param[in] adler Current checksum, CKSUM_ADLER_INIT to start.
+ * 	\param[in] data Data to add.
+ * 	\param[in] len Number of bytes in data.
+ *
+ * 	\return The updated checksum.
+ */
+uint32_t CKSUMAdler32(uint32_t adler, const uint8_t *data, uint32_t len);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,173 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Confirm
+ * \{
+ */
+
+/*!
+ * 	\file confirm.c
+ *
+ * 	\brief Implementation of the confirmation API.
+ *
+ * 	This file implements the retained and durable confirmation of a trial
+ * 	boot.
+ */
+
+#include <stdint.h>
+#include "simplelink.h"
+#include "boot.h"
+#include "confirm.h"
+#include "backoff.h"
+#include "hibstate.h"
+#include "fs.h"
+
+/*!
+ * 	\var static unsigned char confirmfile[]
+ *
+ * 	\brief Path of the confirmation file.
+ *
+ * 	The file is saved as /sys/confirm.bin.
+ */
+static unsigned char confirmfile[] = "/sys/confirm.bin";
+
+/*!
+ * 	\def CONFIRM
+ *
+ * 	\brief Pointer to the retained confirmation record.
+ */
+#define CONFIRM	((volatile bootconfirm_t*) CONFIRM_ADDR)
+
+/*
+ * Check whether the retained record is valid for a trial.
+ */
+static int32_t CONFIRMValid(uint32_t trialid) {
+  return (CONFIRM_MAGIC == CONFIRM->magic) && (trialid == CONFIRM->trialid)
+      && (~trialid == CONFIRM->check);
+}
+
+/*
+ * Record the confirmation in the retained SRAM.
+ */
+void CONFIRMImage() {
+  uint32_t trialid;
+
+  if ((HANDOFF_MAGIC != HANDOFF->magic) || (0 == HANDOFF->trialid))
+    return;
+
+  trialid = HANDOFF->trialid;
+
+  /* The trial boot made it, the next failure starts a new backoff. */
+  BACKOFFDone();
+
+  /* The SRAM record is lost in hibernate, the OCR register is not. */
+  HIBSTATEConfirm(trialid);
+
+  if (CONFIRMValid(trialid))
+    return;
+
+  CONFIRM->magic = 0;
+  CONFIRM->trialid = trialid;
+  CONFIRM->check = ~trialid;
+  CONFIRM->synced = 0;
+  CONFIRM->magic = CONFIRM_MAGIC;
+}
+
+/*
+ * Confirmed but not in the flash yet.
+ */
+int32_t CONFIRMPending() {
+  return (HANDOFF_MAGIC == HANDOFF->magic) && CONFIRMValid(HANDOFF->trialid)
+      && !CONFIRM->synced;
+}
+
+/*
+ * Write the trial id to the confirmation file.
+ */
+int32_t CONFIRMSync() {
+  int32_t RetVal;
+  int32_t hFile;
+  uint32_t trialid;
+
+  if (!CONFIRMPending())
+    return 0;
+
+  trialid = CONFIRM->trialid;
+
+  /* Open the file, creating it on the first use. */
+  RetVal = sl_FsOpen(confirmfile, FS_MODE_OPEN_WRITE, NULL, &hFile);
+  if (0 != RetVal) {
+    RetVal = sl_FsOpen(confirmfile,
+        FS_MODE_OPEN_CREATE(16, _FS_FILE_PUBLIC_WRITE | _FS_FILE_PUBLIC_READ),
+        NULL, &hFile);
+    if (0 != RetVal)
+      return RetVal;
+  }
+
+  RetVal = sl_FsWrite(hFile, 0, (unsigned char*) &trialid, sizeof(trialid));
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  if ((int32_t) sizeof(trialid) != RetVal)
+    return -1;
+
+  CONFIRM->synced = 1;
+  return 0;
+}
+
+/*
+ * Look for a confirmation of the trial, retained or in the flash.
+ */
+int32_t CONFIRMCheck(uint32_t trialid) {
+  int32_t RetVal;
+  int32_t hFile;
+  uint32_t fileid = 0;
+
+  if (0 == trialid)
+    return 0;
+
+  if (CONFIRMValid(trialid))
+    return 1;
+
+  RetVal = sl_FsOpen(confirmfile, FS_MODE_OPEN_READ, NULL, &hFile);
+  if (0 != RetVal)
+    return 0;
+
+  RetVal = sl_FsRead(hFile, 0, (unsigned char*) &fileid, sizeof(fileid));
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  return ((int32_t) sizeof(fileid) == RetVal) && (trialid == fileid);
+}
+
+/*
+ * Forget any confirmation.
+ */
+void CONFIRMClear() {
+  CONFIRM->magic = 0;
+  sl_FsDel(confirmfile, 0);
+}
+
+/*!
+ * \}
+ */
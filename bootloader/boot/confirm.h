@@ -0,0 +1,159 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Confirm Confirm
+ * \{
+ *
+ * \brief Cheap confirmation of a trial boot by the application.
+ *
+ * ### Overview
+ * A new image runs on trial (BOOT_CHECKING) until it confirms itself. Instead
+ * of starting the NWP and rewriting boot.cfg early in its startup, the
+ * application calls CONFIRMImage, which only writes a record in the retained
+ * SRAM (CONFIRM_ADDR). The record is made durable later with CONFIRMSync,
+ * whenever the application has the NWP running anyway, by writing the trial
+ * id to the small /sys/confirm.bin file.
+ *
+ * Both are bound to the id of the trial boot (bootinfo_t::trialid), so a
+ * confirmation left by an older trial is never taken for the current one. On
+ * the next boot the bootloader accepts either of them (CONFIRMCheck), marks
+ * the image BOOT_OK in boot.cfg and removes them (CONFIRMClear):
+ * - Reset after CONFIRMImage: the retained record is still there.
+ * - Reset after CONFIRMSync: the file is there.
+ * - Hibernate after CONFIRMImage: the confirmation is also kept in the OCR
+ *   register (see hibstate.h), the image keeps running on every wake
+ *   without touching boot.cfg until the file is there.
+ * - Power loss before CONFIRMSync: the image was not confirmed, roll back.
+ *
+ * ### Requires
+ * - Simplelink (Can be the TINY build), only for CONFIRMSync.
+ * - HibState.
+ * - Backoff.
+ *
+ * ### Example
+ *
+ * \code
+ *  // Early in the application startup, after the self test.
+ *  CONFIRMImage();
+ *
+ *  // Later, once the NWP is running.
+ *  CONFIRMSync();
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _CONFIRM_H_
+#define _CONFIRM_H_
+
+/*!
+ *	\file confirm.h
+ *
+ *	\brief Constants, types and function prototypes of the confirmation API.
+ *
+ *	This file contains definitions used by the confirm.c.
+ */
+
+/*!
+ *	\def CONFIRM_MAGIC
+ *
+ * 	\brief Magic number ("CNFM") of a valid confirmation record.
+ */
+#define CONFIRM_MAGIC	0x4D464E43
+
+/*!
+ *	\struct bootconfirm_t
+ *
+ *	\brief Confirmation record kept in the retained SRAM at CONFIRM_ADDR.
+ */
+typedef struct {
+  /*! CONFIRM_MAGIC when the record is valid. */
+  uint32_t magic;
+  /*! Id of the confirmed trial. */
+  uint32_t trialid;
+  /*! Bitwise not of trialid, guards against random SRAM contents. */
+  uint32_t check;
+  /*! Not 0 once the confirmation was written to the flash. */
+  uint32_t synced;
+} bootconfirm_t;
+
+/*!
+ *	\fn void CONFIRMImage(void)
+ *
+ * 	\brief Confirm the running image.
+ *
+ * 	Records the confirmation in the retained SRAM and clears the boot
+ * 	backoff count (see backoff.h). Doesn't need the NWP and does nothing if
+ * 	the image is not on trial.
+ */
+void CONFIRMImage(void);
+
+/*!
+ *	\fn int32_t CONFIRMPending(void)
+ *
+ * 	\brief Check whether a confirmation still needs CONFIRMSync.
+ *
+ * 	\return 1 if the image was confirmed but not synced, 0 otherwise.
+ */
+int32_t CONFIRMPending(void);
+
+/*!
+ *	\fn int32_t CONFIRMSync(void)
+ *
+ * 	\brief Make the confirmation durable.
+ *
+ * 	Writes the trial id to /sys/confirm.bin. Must be called with the NWP
+ * 	running. Does nothing if there is no pending confirmation.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t CONFIRMSync(void);
+
+/*!
+ *	\fn int32_t CONFIRMCheck(uint32_t trialid)
+ *
+ * 	\brief Check whether a trial was confirmed (used by the bootloader).
+ *
+ * 	\param[in] trialid Id of the trial, from boot.cfg.
+ *
+ * 	\return 1 if confirmed, 0 otherwise.
+ */
+int32_t CONFIRMCheck(uint32_t trialid);
+
+/*!
+ *	\fn void CONFIRMClear(void)
+ *
+ * 	\brief Remove the retained record and the confirmation file.
+ */
+void CONFIRMClear(void);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,156 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Deadline
+ * \{
+ */
+
+/*!
+ * 	\file deadline.c
+ *
+ * 	\brief Implementation of the boot deadlines.
+ *
+ * 	This file implements the watchdog budgets of the boot stages.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "hw_types.h"
+#include "hw_memmap.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "wdt.h"
+#include "boot.h"
+#include "deadline.h"
+
+/*!
+ * 	\def DEADLINE
+ *
+ * 	\brief Pointer to the retained record.
+ */
+#define DEADLINE	((volatile deadlinestats_t*) DEADLINE_ADDR)
+
+/*! Budget of each stage in ms. */
+static const uint32_t budget[DEADLINE_STAGES] = { 0, DEADLINE_SL_START_MS,
+    DEADLINE_CFG_MS, DEADLINE_LOAD_MS, DEADLINE_LOAD_MS, DEADLINE_NETBOOT_MS,
+    DEADLINE_SL_STOP_MS };
+
+/*
+ * Reload the watchdog with a budget, starting it if needed.
+ */
+static void DEADLINEArm(uint32_t ms) {
+  uint32_t reload;
+
+  /* The SOC is reset on the second timeout, as in BOOTArmTrial. */
+  ms /= 2;
+  reload = (ms > 0xFFFFFFFF / WDT_TICKS_PER_MS) ? 0xFFFFFFFF :
+      ms * WDT_TICKS_PER_MS;
+
+  MAP_PRCMPeripheralClkEnable(PRCM_WDT, PRCM_RUN_MODE_CLK);
+  MAP_WatchdogUnlock(WDT_BASE);
+  MAP_WatchdogStallEnable(WDT_BASE);
+  MAP_WatchdogIntClear(WDT_BASE);
+  MAP_WatchdogReloadSet(WDT_BASE, reload);
+  MAP_WatchdogEnable(WDT_BASE);
+}
+
+/*
+ * Record the length of the running stage.
+ */
+static void DEADLINEEnd(void) {
+  uint32_t stage = DEADLINE->stage;
+  uint32_t ms;
+
+  if ((DEADLINE_NONE == stage) || (stage >= DEADLINE_STAGES))
+    return;
+
+  ms = (((uint32_t) MAP_PRCMSlowClkCtrGet() - DEADLINE->start) * 1000) / 32768;
+  if (ms > DEADLINE->maxms[stage])
+    DEADLINE->maxms[stage] = ms;
+
+  DEADLINE->stage = DEADLINE_NONE;
+}
+
+/*
+ * A stage still running after a watchdog reset overran.
+ */
+uint32_t DEADLINEOverrun() {
+  uint32_t stage;
+
+  if (DEADLINE_MAGIC != DEADLINE->magic) {
+    memset((void*) DEADLINE, 0, sizeof(deadlinestats_t));
+    DEADLINE->magic = DEADLINE_MAGIC;
+    return DEADLINE_NONE;
+  }
+
+  stage = DEADLINE->stage;
+  DEADLINE->stage = DEADLINE_NONE;
+
+  if ((DEADLINE_NONE == stage) || (stage >= DEADLINE_STAGES)
+      || (PRCM_WDT_RESET != MAP_PRCMSysResetCauseGet()))
+    return DEADLINE_NONE;
+
+  DEADLINE->overruns++;
+  DEADLINE->streak++;
+  DEADLINE->last = stage;
+
+  return stage;
+}
+
+/*
+ * Close the running stage and give the watchdog the budget of the next.
+ */
+void DEADLINEStart(uint32_t stage) {
+  DEADLINEEnd();
+
+  if ((DEADLINE_NONE == stage) || (stage >= DEADLINE_STAGES))
+    return;
+
+  DEADLINE->start = (uint32_t) MAP_PRCMSlowClkCtrGet();
+  DEADLINE->stage = stage;
+  DEADLINEArm(budget[stage]);
+}
+
+/*
+ * The boot made it, turn the watchdog off.
+ */
+void DEADLINEStop() {
+  DEADLINEEnd();
+  DEADLINE->streak = 0;
+
+  MAP_PRCMPeripheralReset(PRCM_WDT);
+}
+
+/*
+ * Copy the record.
+ */
+void DEADLINEStats(deadlinestats_t *stats) {
+  memcpy(stats, (const void*) DEADLINE, sizeof(deadlinestats_t));
+}
+
+/*!
+ * \}
+ */
@@ -0,0 +1,239 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Deadline Deadline
+ * \{
+ *
+ * \brief Bounded boot time, with a budget per boot stage.
+ *
+ * ### Overview
+ * A misbehaving NWP can block sl_Start, sl_FsOpen or sl_FsRead forever, and
+ * nothing would ever reset the device. The bootloader splits the boot in
+ * stages (sl_Start, boot.cfg access, image load, netboot, sl_Stop) and runs
+ * each one under the hardware watchdog, reloaded with the budget of the stage
+ * (DEADLINE_*_MS) by DEADLINEStart. The watchdog is the only timer that can
+ * bound a call that never returns: it resets the SOC when the budget runs
+ * out, whatever the CPU is doing.
+ *
+ * The running stage is kept in the retained SRAM (deadlinestats_t at
+ * DEADLINE_ADDR). After a watchdog reset with a stage still running,
+ * DEADLINEOverrun counts the overrun in the statistics and returns the stage,
+ * so main can take its recovery action:
+ * - sl_Start, boot.cfg or sl_Stop: retry, the reset already did it.
+ * - Custom image load: boot the factory image this time (alternate slot).
+ * - Factory image load: retry.
+ * - Netboot: boot from the flash this time.
+ *
+ * DEADLINEStop turns the watchdog off (a reset of the peripheral is the only
+ * way) before the image is started, BOOTArmTrial arms it again for a trial.
+ *
+ * The stage functions are only called by main, never from boot.c, which is
+ * also used by the application and must leave its watchdog alone.
+ *
+ * ### Requires
+ * - Driverlib;
+ * - Boot.
+ *
+ * ### Example
+ *
+ * \code
+ *  DEADLINEStart(DEADLINE_SL_START);
+ *  sl_Start(NULL, NULL, NULL);
+ *  DEADLINEStart(DEADLINE_CFG);
+ *  ...
+ *  DEADLINEStop();
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _DEADLINE_H_
+#define _DEADLINE_H_
+
+/*!
+ *	\file deadline.h
+ *
+ *	\brief Constants, types and function prototypes of the boot deadlines.
+ *
+ *	This file contains definitions used by the deadline.c.
+ */
+
+/*!
+ *	\def DEADLINE_ADDR
+ *
+ * 	\brief Address of the retained deadlinestats_t.
+ */
+#define DEADLINE_ADDR	(RETAINED_ADDR + 0x100)
+
+/*!
+ *	\def DEADLINE_MAGIC
+ *
+ * 	\brief Magic number ("DEAD") of a valid record.
+ */
+#define DEADLINE_MAGIC	0x44414544
+
+#ifndef DEADLINE_SL_START_MS
+/*!
+ *	\def DEADLINE_SL_START_MS
+ *
+ * 	\brief Budget of sl_Start in milliseconds.
+ */
+#define DEADLINE_SL_START_MS	5000
+#endif
+
+#ifndef DEADLINE_CFG_MS
+/*!
+ *	\def DEADLINE_CFG_MS
+ *
+ * 	\brief Budget of each boot.cfg read or write in milliseconds.
+ */
+#define DEADLINE_CFG_MS	2000
+#endif
+
+#ifndef DEADLINE_LOAD_MS
+/*!
+ *	\def DEADLINE_LOAD_MS
+ *
+ * 	\brief Budget of an image load in milliseconds.
+ */
+#define DEADLINE_LOAD_MS	5000
+#endif
+
+#ifndef DEADLINE_NETBOOT_MS
+/*!
+ *	\def DEADLINE_NETBOOT_MS
+ *
+ * 	\brief Budget of a netboot in milliseconds.
+ */
+#define DEADLINE_NETBOOT_MS	30000
+#endif
+
+#ifndef DEADLINE_SL_STOP_MS
+/*!
+ *	\def DEADLINE_SL_STOP_MS
+ *
+ * 	\brief Budget of sl_Stop in milliseconds.
+ */
+#define DEADLINE_SL_STOP_MS	1000
+#endif
+
+/*!
+ *	\enum deadlinestage_t
+ *
+ *	\brief Stages of the boot.
+ */
+typedef enum {
+  /*! No stage running. */
+  DEADLINE_NONE,
+  /*! sl_Start. */
+  DEADLINE_SL_START,
+  /*! boot.cfg read or write. */
+  DEADLINE_CFG,
+  /*! Load of the factory image. */
+  DEADLINE_LOAD_FACTORY,
+  /*! Load of the custom image. */
+  DEADLINE_LOAD_CUSTOM,
+  /*! Netboot (see netboot.h). */
+  DEADLINE_NETBOOT,
+  /*! sl_Stop. */
+  DEADLINE_SL_STOP,
+  /*! Number of stages. */
+  DEADLINE_STAGES
+} deadlinestage_t;
+
+/*!
+ *	\def DEADLINE_LOAD
+ *
+ * 	\brief Load stage of an image type.
+ */
+#define DEADLINE_LOAD(img)	(DEADLINE_LOAD_FACTORY + (img))
+
+/*!
+ *	\struct deadlinestats_t
+ *
+ *	\brief Retained record of the boot stages.
+ */
+typedef struct {
+  /*! DEADLINE_MAGIC when the record is valid. */
+  uint32_t magic;
+  /*! Stage running, DEADLINE_NONE once the boot is done. */
+  uint32_t stage;
+  /*! Slow clock (32768Hz) at the start of the stage. */
+  uint32_t start;
+  /*! Overruns since the record was created. */
+  uint32_t overruns;
+  /*! Boots in a row ended by an overrun. */
+  uint32_t streak;
+  /*! Stage of the last overrun. */
+  uint32_t last;
+  /*! Longest run of each stage in ms. */
+  uint32_t maxms[DEADLINE_STAGES];
+} deadlinestats_t;
+
+/*!
+ *	\fn uint32_t DEADLINEOverrun(void)
+ *
+ * 	\brief Check whether the last boot was cut by a deadline.
+ *
+ * 	Must be called at the start of the boot, before any stage. Counts the
+ * 	overrun in the statistics.
+ *
+ * 	\return The stage that overran, DEADLINE_NONE if none.
+ */
+uint32_t DEADLINEOverrun(void);
+
+/*!
+ *	\fn void DEADLINEStart(uint32_t stage)
+ *
+ * 	\brief End the running stage and start another one.
+ *
+ * 	\param[in] stage Stage to start (deadlinestage_t).
+ */
+void DEADLINEStart(uint32_t stage);
+
+/*!
+ *	\fn void DEADLINEStop(void)
+ *
+ * 	\brief End the running stage and turn the watchdog off.
+ */
+void DEADLINEStop(void);
+
+/*!
+ *	\fn void DEADLINEStats(deadlinestats_t *stats)
+ *
+ * 	\brief Get a copy of the record, for the application.
+ *
+ * 	\param[out] stats Structure to hold the statistics.
+ */
+void DEADLINEStats(deadlinestats_t *stats);
+
+#endif
+
+/*!
+ * \}
+ */
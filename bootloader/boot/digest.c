@@ -0,0 +1,109 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Digest
+ * \{
+ */
+
+/*!
+ * 	\file digest.c
+ *
+ * 	\brief Implementation of the image digest.
+ *
+ * 	This file dispatches the digest to the algorithm of the image.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "boot.h"
+#include "blake2s.h"
+#include "cksum.h"
+#include "digest.h"
+
+/*
+ * Start the algorithm.
+ */
+int32_t DIGESTInit(digestctx_t *ctx, uint32_t alg) {
+  ctx->alg = alg;
+
+  switch (alg) {
+  case IMG_DIGEST_NONE:
+    return 0;
+
+#ifdef BOOT_BLAKE2S
+  case IMG_DIGEST_BLAKE2S:
+    BLAKE2SInit(&ctx->blake2s, IMG_DIGEST_LEN);
+    return 0;
+#endif
+
+  case IMG_DIGEST_ADLER32:
+    ctx->adler = CKSUM_ADLER_INIT;
+    return 0;
+
+  default:
+    return -1;
+  }
+}
+
+/*
+ * Add data.
+ */
+void DIGESTUpdate(digestctx_t *ctx, const uint8_t *data, uint32_t len) {
+#ifdef BOOT_BLAKE2S
+  if (IMG_DIGEST_BLAKE2S == ctx->alg)
+    BLAKE2SUpdate(&ctx->blake2s, data, len);
+#endif
+
+  if (IMG_DIGEST_ADLER32 == ctx->alg)
+    ctx->adler = CKSUMAdler32(ctx->adler, data, len);
+}
+
+/*
+ * Finish and compare, the unused bytes of the digest must be 0.
+ */
+int32_t DIGESTCheck(digestctx_t *ctx, const uint8_t *digest) {
+  uint8_t value[IMG_DIGEST_LEN];
+
+  memset(value, 0, IMG_DIGEST_LEN);
+
+  if (IMG_DIGEST_NONE == ctx->alg)
+    return 0;
+
+#ifdef BOOT_BLAKE2S
+  if (IMG_DIGEST_BLAKE2S == ctx->alg)
+    BLAKE2SFinal(&ctx->blake2s, value);
+  else
+#endif
+  if (IMG_DIGEST_ADLER32 == ctx->alg)
+    memcpy(value, &ctx->adler, sizeof(uint32_t));
+  else
+    return -1;
+
+  return memcmp(value, digest, IMG_DIGEST_LEN) ? -1 : 0;
+}
+
+/*!
+ * \}
+ */
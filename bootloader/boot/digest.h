@@ -0,0 +1,127 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Digest Digest
+ * \{
+ *
+ * \brief Streaming check of the image digest (imghdr_t::digestalg).
+ *
+ * ### Overview
+ * Hides the algorithm selected by the image header from the loader, the
+ * scrubber and the image writer. The digest covers the payload as stored
+ * in the file (see IMG_STORED_LEN), so it can be computed while the bytes
+ * are read, written or unpacked.
+ *
+ * IMG_DIGEST_BLAKE2S is only known with BOOT_BLAKE2S defined, without it
+ * DIGESTInit refuses it like any unknown algorithm.
+ *
+ * ### Requires
+ * - Blake2s.
+ * - Cksum.
+ *
+ * ### Example
+ *
+ * \code
+ *  digestctx_t ctx;
+ *
+ *  if (0 == DIGESTInit(&ctx, hdr.digestalg)) {
+ *    DIGESTUpdate(&ctx, data, len);
+ *    ok = (0 == DIGESTCheck(&ctx, hdr.digest));
+ *  }
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _DIGEST_H_
+#define _DIGEST_H_
+
+/*!
+ *	\file digest.h
+ *
+ *	\brief Types and function prototypes of the image digest.
+ *
+ *	This file contains definitions used by the digest.c.
+ */
+
+/*!
+ *	\struct digestctx_t
+ *
+ *	\brief State of a running image digest.
+ */
+typedef struct {
+  /*! IMG_DIGEST_* algorithm. */
+  uint32_t alg;
+  /*! Running Adler-32. */
+  uint32_t adler;
+#ifdef BOOT_BLAKE2S
+  /*! Running BLAKE2s. */
+  blake2sctx_t blake2s;
+#endif
+} digestctx_t;
+
+/*!
+ *	\fn int32_t DIGESTInit(digestctx_t *ctx, uint32_t alg)
+ *
+ * 	\brief Start a digest.
+ *
+ * 	\param[out] ctx Digest state.
+ * 	\param[in] alg IMG_DIGEST_* algorithm.
+ *
+ * 	\return 0 on success, -1 for an unknown algorithm.
+ */
+int32_t DIGESTInit(digestctx_t *ctx, uint32_t alg);
+
+/*!
+ *	\fn void DIGESTUpdate(digestctx_t *ctx, const uint8_t *data, uint32_t len)
+ *
+ * 	\brief Add data to the digest.
+ *
+ * 	\param[in,out] ctx Digest state.
+ * 	\param[in] data Data to add.
+ * 	\param[in] len Number of bytes in data.
+ */
+void DIGESTUpdate(digestctx_t *ctx, const uint8_t *data, uint32_t len);
+
+/*!
+ *	\fn int32_t DIGESTCheck(digestctx_t *ctx, const uint8_t *digest)
+ *
+ * 	\brief Finish the digest and compare it.
+ *
+ * 	\param[in,out] ctx Digest state.
+ * 	\param[in] digest Expected value (imghdr_t::digest).
+ *
+ * 	\return 0 if it matches (always for IMG_DIGEST_NONE), -1 otherwise.
+ */
+int32_t DIGESTCheck(digestctx_t *ctx, const uint8_t *digest);
+
+#endif
+
+/*!
+ * \}
+ */
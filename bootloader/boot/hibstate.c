@@ -0,0 +1,192 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup HibState
+ * \{
+ */
+
+/*!
+ * 	\file hibstate.c
+ *
+ * 	\brief Implementation of the hibernate state.
+ *
+ * 	This file implements the boot state word kept in the OCR register.
+ */
+
+#ifdef BOOT_HIBSTATE
+
+#include <stdint.h>
+#include <string.h>
+#include "hw_types.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "boot.h"
+#include "hibstate.h"
+
+/*
+ * CRC-8 (polynomial 0x07) of the upper 24 bits of a word.
+ */
+static uint32_t HIBSTATECrc(uint32_t word) {
+  uint32_t crc = 0xFF;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < 3; i++) {
+    crc ^= (word >> (24 - 8 * i)) & 0xFF;
+    for (j = 0; j < 8; j++)
+      crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) & 0xFF : (crc << 1) & 0xFF;
+  }
+
+  return crc;
+}
+
+/*
+ * Pack the fields and add the check.
+ */
+uint32_t HIBSTATEEncode(const hibstate_t *state) {
+  uint32_t word = (HIBSTATE_MAGIC << 28) | ((state->status & 3) << 26)
+      | ((state->bootimg & 1) << 25) | ((state->confirmed & 1) << 24)
+      | ((state->netboot & 1) << 23) | ((state->slot & 1) << 22)
+      | ((state->tag & 0x3FFF) << 8);
+
+  return word | HIBSTATECrc(word);
+}
+
+/*
+ * Check and unpack the fields.
+ */
+int32_t HIBSTATEDecode(uint32_t word, hibstate_t *state) {
+  if ((HIBSTATE_MAGIC != (word >> 28)) || (HIBSTATECrc(word) != (word & 0xFF)))
+    return -1;
+
+  state->status = (word >> 26) & 3;
+  state->bootimg = (word >> 25) & 1;
+  state->confirmed = (word >> 24) & 1;
+  state->netboot = (word >> 23) & 1;
+  state->slot = (word >> 22) & 1;
+  state->tag = (word >> 8) & 0x3FFF;
+
+  return 0;
+}
+
+/*
+ * Read the register.
+ */
+static int32_t HIBSTATEGet(hibstate_t *state) {
+  return HIBSTATEDecode(MAP_PRCMOCRRegisterRead(HIBSTATE_OCR), state);
+}
+
+/*
+ * Read the register at boot, nothing survives a power on.
+ */
+static int32_t HIBSTATEBootGet(hibstate_t *state) {
+  if (PRCM_POWER_ON == MAP_PRCMSysResetCauseGet())
+    return -1;
+
+  return HIBSTATEGet(state);
+}
+
+/*
+ * Save a configuration written to the flash.
+ */
+void HIBSTATESave(const bootinfo_t *bootinfo) {
+  hibstate_t state;
+  hibstate_t old;
+
+  state.status = bootinfo->status;
+  state.bootimg = bootinfo->bootimg;
+  state.confirmed = 0;
+  state.netboot = (0 != bootinfo->netaddr);
+  state.slot = bootinfo->customslot;
+  state.tag = HIBSTATE_TAG(bootinfo->trialid);
+
+  /* Saving the same state again keeps its confirmation. */
+  if ((0 == HIBSTATEGet(&old)) && (old.status == state.status)
+      && (old.bootimg == state.bootimg) && (old.netboot == state.netboot)
+      && (old.slot == state.slot) && (old.tag == state.tag))
+    state.confirmed = old.confirmed;
+
+  MAP_PRCMOCRRegisterWrite(HIBSTATE_OCR, HIBSTATEEncode(&state));
+}
+
+/*
+ * A plain BOOT_OK needs nothing else from boot.cfg.
+ */
+int32_t HIBSTATEReadCfg(bootinfo_t *bootinfo) {
+  hibstate_t state;
+
+  /* After a reset the application may have changed boot.cfg behind the
+   * bootloader (through the NWP, or a flash tool), only a wake is trusted. */
+  if ((PRCM_HIB_EXIT != MAP_PRCMSysResetCauseGet())
+      || (0 != HIBSTATEGet(&state)) || (BOOT_OK != state.status)
+      || state.netboot)
+    return -1;
+
+  memset(bootinfo, 0, sizeof(bootinfo_t));
+  bootinfo->status = BOOT_OK;
+  bootinfo->bootimg = (imgtype_t) state.bootimg;
+  bootinfo->customslot = state.slot;
+  BOOTSelectSlot(state.slot);
+
+  return 0;
+}
+
+/*
+ * Set the confirmed bit of the current trial.
+ */
+void HIBSTATEConfirm(uint32_t trialid) {
+  hibstate_t state;
+
+  if ((0 != HIBSTATEGet(&state)) || (BOOT_CHECKING != state.status)
+      || (HIBSTATE_TAG(trialid) != state.tag) || state.confirmed)
+    return;
+
+  state.confirmed = 1;
+  MAP_PRCMOCRRegisterWrite(HIBSTATE_OCR, HIBSTATEEncode(&state));
+}
+
+/*
+ * Check the confirmed bit of a trial.
+ */
+int32_t HIBSTATEConfirmed(uint32_t trialid) {
+  hibstate_t state;
+
+  return (0 == HIBSTATEBootGet(&state)) && (BOOT_CHECKING == state.status)
+      && (HIBSTATE_TAG(trialid) == state.tag) && state.confirmed;
+}
+
+/*
+ * Zero never decodes.
+ */
+void HIBSTATEClear() {
+  MAP_PRCMOCRRegisterWrite(HIBSTATE_OCR, 0);
+}
+
+#endif
+
+/*!
+ * \}
+ */
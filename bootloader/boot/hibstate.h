@@ -0,0 +1,222 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup HibState HibState
+ * \{
+ *
+ * \brief Boot state kept in a hibernate retained OCR register.
+ *
+ * ### Overview
+ * The SRAM is lost in hibernate, so the retained records (boothandoff_t,
+ * confirm.h) don't survive the mode the sensor nodes spend most of their
+ * time in, and carrying the boot state across a wake would need boot.cfg
+ * reads and writes on every cycle.
+ *
+ * Instead, a copy of the boot state is packed in one 32 bit word and kept in
+ * an OCR register of the hibernate domain (HIBSTATE_OCR), which survives
+ * hibernate and resets but not a power cycle:
+ *
+ * 	- [31:28] HIBSTATE_MAGIC.
+ * 	- [27:26] bootinfo_t::status.
+ * 	- [25] bootinfo_t::bootimg.
+ * 	- [24] Trial confirmed by the application (CONFIRMImage).
+ * 	- [23] Netboot configured (bootinfo_t::netaddr not 0).
+ * 	- [22] bootinfo_t::customslot.
+ * 	- [21:8] HIBSTATE_TAG of bootinfo_t::trialid.
+ * 	- [7:0] CRC-8 of the bits above.
+ *
+ * BOOTWriteCfg and BOOTDeleteCfg keep the word in step with boot.cfg. A
+ * word with a bad check, or any word after a power on reset, is ignored and
+ * the state comes from the flash as before.
+ *
+ * With a valid word the bootloader doesn't open boot.cfg for a BOOT_OK wake
+ * from hibernate, and a trial confirmed before the hibernate keeps running
+ * without a boot.cfg write. Other resets always read boot.cfg, which may
+ * have been changed without BOOTWriteCfg (by a flash tool, for example).
+ * The confirmation becomes durable when the application calls CONFIRMSync.
+ *
+ * The word is only used with BOOT_HIBSTATE defined. Without it the
+ * functions are macros that keep nothing, and every boot reads boot.cfg.
+ *
+ * ### Requires
+ * - Driverlib;
+ * - Boot.
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _HIBSTATE_H_
+#define _HIBSTATE_H_
+
+/*!
+ *	\file hibstate.h
+ *
+ *	\brief Constants, types and function prototypes of the hibernate state.
+ *
+ *	This file contains definitions used by the hibstate.c.
+ */
+
+#ifndef HIBSTATE_OCR
+/*!
+ *	\def HIBSTATE_OCR
+ *
+ * 	\brief Index of the OCR register used for the boot state.
+ */
+#define HIBSTATE_OCR	1
+#endif
+
+/*!
+ *	\def HIBSTATE_MAGIC
+ *
+ * 	\brief Value of the 4 upper bits of a valid word.
+ */
+#define HIBSTATE_MAGIC	0xB
+
+/*!
+ *	\def HIBSTATE_TAG
+ *
+ * 	\brief Part of a trial id kept in the word (bit 0 of the ids is always 1).
+ */
+#define HIBSTATE_TAG(trialid)	(((trialid) >> 1) & 0x3FFF)
+
+/*!
+ *	\struct hibstate_t
+ *
+ *	\brief Decoded boot state word.
+ */
+typedef struct {
+  /*! Boot status (bootstatus_t). */
+  uint32_t status;
+  /*! Image to boot (imgtype_t). */
+  uint32_t bootimg;
+  /*! 1 if the trial was confirmed. */
+  uint32_t confirmed;
+  /*! 1 if netboot is configured. */
+  uint32_t netboot;
+  /*! Slot of the custom image. */
+  uint32_t slot;
+  /*! HIBSTATE_TAG of the trial id. */
+  uint32_t tag;
+} hibstate_t;
+
+#ifdef BOOT_HIBSTATE
+
+/*!
+ *	\fn uint32_t HIBSTATEEncode(const hibstate_t *state)
+ *
+ * 	\brief Pack a state in a word, with its magic and check.
+ *
+ * 	\param[in] state State to pack.
+ *
+ * 	\return The word.
+ */
+uint32_t HIBSTATEEncode(const hibstate_t *state);
+
+/*!
+ *	\fn int32_t HIBSTATEDecode(uint32_t word, hibstate_t *state)
+ *
+ * 	\brief Unpack a word.
+ *
+ * 	\param[in] word Word to unpack.
+ * 	\param[out] state Decoded state.
+ *
+ * 	\return 0 if the word is valid, -1 otherwise.
+ */
+int32_t HIBSTATEDecode(uint32_t word, hibstate_t *state);
+
+/*!
+ *	\fn void HIBSTATESave(const bootinfo_t *bootinfo)
+ *
+ * 	\brief Keep a boot configuration in the OCR register.
+ *
+ * 	The trial is saved as not confirmed, unless the same state was already
+ * 	in the register. BOOTWriteCfg clears the register first.
+ *
+ * 	\param[in] bootinfo Configuration, as written to boot.cfg.
+ */
+void HIBSTATESave(const bootinfo_t *bootinfo);
+
+/*!
+ *	\fn int32_t HIBSTATEReadCfg(bootinfo_t *bootinfo)
+ *
+ * 	\brief Get a BOOT_OK configuration from the OCR register.
+ *
+ * 	Only plain BOOT_OK states, and only on a wake from hibernate
+ * 	(PRCM_HIB_EXIT), are returned. Any other state needs the fields of
+ * 	boot.cfg that are not in the word.
+ *
+ * 	\param[out] bootinfo Configuration, the fields not in the word are 0.
+ *
+ * 	\return 0 on success, -1 if boot.cfg must be read.
+ */
+int32_t HIBSTATEReadCfg(bootinfo_t *bootinfo);
+
+/*!
+ *	\fn void HIBSTATEConfirm(uint32_t trialid)
+ *
+ * 	\brief Mark the trial as confirmed in the OCR register.
+ *
+ * 	Does nothing if the word is not valid or is about another trial.
+ *
+ * 	\param[in] trialid Id of the trial.
+ */
+void HIBSTATEConfirm(uint32_t trialid);
+
+/*!
+ *	\fn int32_t HIBSTATEConfirmed(uint32_t trialid)
+ *
+ * 	\brief Check whether a trial was confirmed before the last reset.
+ *
+ * 	\param[in] trialid Id of the trial (bootinfo_t::trialid).
+ *
+ * 	\return 1 if confirmed, 0 otherwise.
+ */
+int32_t HIBSTATEConfirmed(uint32_t trialid);
+
+/*!
+ *	\fn void HIBSTATEClear(void)
+ *
+ * 	\brief Invalidate the word.
+ */
+void HIBSTATEClear(void);
+
+#else
+
+#define HIBSTATESave(bootinfo)
+#define HIBSTATEReadCfg(bootinfo)	(-1)
+#define HIBSTATEConfirm(trialid)
+#define HIBSTATEConfirmed(trialid)	0
+#define HIBSTATEClear()
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,407 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup ImgWr
+ * \{
+ */
+
+/*!
+ * 	\file imgwr.c
+ *
+ * 	\brief Implementation of the image writer.
+ *
+ * 	This file implements the staged writes and the digest check of a new
+ * 	custom image.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "hw_types.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "blake2s.h"
+#include "digest.h"
+#include "imgwr.h"
+#include "scrub.h"
+#include "cfg.h"
+#include "fs.h"
+
+/*!
+ * 	\def IMGWR_FLAGS
+ *
+ * 	\brief Flags used to create the image file.
+ */
+#ifdef BOOT_SECURE
+#define IMGWR_FLAGS	(_FS_FILE_OPEN_FLAG_SECURE \
+    | _FS_FILE_OPEN_FLAG_NO_SIGNATURE_TEST | _FS_FILE_PUBLIC_WRITE \
+    | _FS_FILE_PUBLIC_READ)
+#else
+#define IMGWR_FLAGS	(_FS_FILE_PUBLIC_WRITE | _FS_FILE_PUBLIC_READ)
+#endif
+
+/*!
+ * 	\struct imgwrstate_t
+ *
+ * 	\brief State of the update.
+ */
+typedef struct {
+  /*! Handle of the image file, -1 when closed. */
+  int32_t hFile;
+  /*! Slot being written. */
+  uint32_t slot;
+  /*! Bytes received so far. */
+  uint32_t offset;
+  /*! Bytes already written to the flash. */
+  uint32_t flushed;
+  /*! Bytes waiting in buf. */
+  uint32_t buflen;
+  /*! Header of the image, valid after sizeof(imghdr_t) bytes. */
+  imghdr_t hdr;
+  /*! Running digest. */
+  digestctx_t ctx;
+  /*! Slow clock at IMGWRBegin. */
+  uint32_t start;
+  /*! Set when the image is complete but the configuration is not updated. */
+  uint32_t pending;
+  /*! Argument of IMGWREnd. */
+  int32_t check;
+  /*! Staging buffer. */
+  unsigned char buf[IMGWR_BUF_SIZE];
+} imgwrstate_t;
+
+/*! State of the update. */
+static imgwrstate_t state = { .hFile = -1 };
+
+/*! Counters of the last update. */
+static imgwrstats_t stats;
+
+/*
+ * Write the staging buffer to the flash.
+ */
+static int32_t IMGWRFlush(void) {
+  int32_t RetVal;
+
+  if (0 == state.buflen)
+    return 0;
+
+  RetVal = sl_FsWrite(state.hFile, state.flushed, state.buf, state.buflen);
+  stats.writes++;
+
+  if (1 == stats.writes)
+    stats.firstticks = (uint32_t) MAP_PRCMSlowClkCtrGet() - state.start;
+
+  if (RetVal != (int32_t) state.buflen)
+    return (0 > RetVal) ? RetVal : -1;
+
+  state.flushed += state.buflen;
+  state.buflen = 0;
+  return 0;
+}
+
+/*
+ * Feed the payload bytes of data (at offset in the file) to the digest.
+ */
+static void IMGWRDigest(const unsigned char *data, uint32_t offset,
+    uint32_t len) {
+  uint32_t start = IMG_PAYLOAD_OFF(&state.hdr);
+  uint32_t end = start + IMG_STORED_LEN(&state.hdr);
+
+  if ((offset + len <= start) || (offset >= end))
+    return;
+
+  if (offset < start) {
+    data += start - offset;
+    len -= start - offset;
+    offset = start;
+  }
+
+  if (offset + len > end)
+    len = end - offset;
+
+  DIGESTUpdate(&state.ctx, data, len);
+}
+
+/*
+ * Start the digest once the header is complete.
+ */
+static void IMGWRHeader(void) {
+  if ((IMG_MAGIC != state.hdr.magic) || (state.hdr.hdrlen < sizeof(imghdr_t))) {
+    /* Raw image or older header, nothing to check. */
+    memset(&state.hdr, 0, sizeof(imghdr_t));
+    return;
+  }
+
+  /* An unknown algorithm fails in DIGESTCheck. */
+  DIGESTInit(&state.ctx, state.hdr.digestalg);
+}
+
+/*
+ * Check whether a slot was prepared for at least len bytes.
+ */
+static int32_t IMGWRReady(unsigned char *name, uint32_t len) {
+  SlFsFileInfo_t FileInfo;
+
+  if (0 != sl_FsGetInfo(name, 0, &FileInfo))
+    return 0;
+
+  /* Nothing was written since it was created. */
+  return (0 == FileInfo.FileLen) && (FileInfo.AllocatedLen >= len);
+}
+
+/*
+ * Get the slot the custom image is not in.
+ */
+static int32_t IMGWRSpare(uint32_t *slot) {
+  bootinfo_t bootinfo;
+  int32_t RetVal;
+
+  RetVal = CFGRead(&bootinfo);
+  if (0 != RetVal)
+    return RetVal;
+
+  /* An unknown slot is read as slot 0 (BOOTSelectSlot). */
+  *slot = (1 == bootinfo.customslot) ? 0 : 1;
+  return 0;
+}
+
+/*
+ * Make the new image the custom image, on trial if asked.
+ */
+static int32_t IMGWREdit(bootinfo_t *bootinfo, void *arg) {
+  imgwrstate_t *imgwr = arg;
+
+  bootinfo->customslot = imgwr->slot;
+
+  /* The new image was not scrubbed yet. */
+  bootinfo->scrubok &= ~SCRUB_BIT(IMG_CUSTOM);
+  bootinfo->scrubbad &= ~SCRUB_BIT(IMG_CUSTOM);
+
+  if (imgwr->check) {
+    bootinfo->status = BOOT_CHECK;
+    bootinfo->bootimg = IMG_CUSTOM;
+  }
+
+  return 0;
+}
+
+/*
+ * Claim the spare slot, or replace it by an empty file of len bytes.
+ */
+int32_t IMGWRBegin(uint32_t len) {
+  unsigned char *name;
+  int32_t RetVal;
+
+  IMGWRAbort();
+
+  /* The scrubber may be reading the slot. */
+  SCRUBReset();
+
+  memset(&stats, 0, sizeof(imgwrstats_t));
+  memset(&state.hdr, 0, sizeof(imghdr_t));
+  state.offset = 0;
+  state.flushed = 0;
+  state.buflen = 0;
+  state.start = (uint32_t) MAP_PRCMSlowClkCtrGet();
+
+  RetVal = IMGWRSpare(&state.slot);
+  if (0 != RetVal)
+    return RetVal;
+
+  name = BOOTSlotName(state.slot);
+
+  if (IMGWRReady(name, len)) {
+    /* Already allocated and erased by IMGWRPrepare. */
+    stats.prepared = 1;
+    RetVal = sl_FsOpen(name, FS_MODE_OPEN_WRITE, NULL, &state.hFile);
+  }
+  else {
+    /* The size of a file is fixed when it is created. */
+    sl_FsDel(name, 0);
+
+    RetVal = sl_FsOpen(name, FS_MODE_OPEN_CREATE(len, IMGWR_FLAGS), NULL,
+        &state.hFile);
+  }
+
+  if (0 != RetVal)
+    state.hFile = -1;
+
+  return RetVal;
+}
+
+/*
+ * Stage the data, writing the flash when the buffer is full.
+ */
+int32_t IMGWRWrite(const unsigned char *data, uint32_t len) {
+  uint32_t n;
+  int32_t RetVal;
+
+  if (0 > state.hFile)
+    return -1;
+
+  while (len) {
+    n = IMGWR_BUF_SIZE - state.buflen;
+    if (n > len)
+      n = len;
+
+    /* Collect the header from the first bytes. */
+    if (state.offset < sizeof(imghdr_t)) {
+      if (n > sizeof(imghdr_t) - state.offset)
+        n = sizeof(imghdr_t) - state.offset;
+
+      memcpy((unsigned char*) &state.hdr + state.offset, data, n);
+
+      if (state.offset + n == sizeof(imghdr_t))
+        IMGWRHeader();
+    }
+    else {
+      IMGWRDigest(data, state.offset, n);
+    }
+
+    memcpy(state.buf + state.buflen, data, n);
+    state.buflen += n;
+    state.offset += n;
+    stats.bytes += n;
+    data += n;
+    len -= n;
+
+    if (IMGWR_BUF_SIZE == state.buflen) {
+      RetVal = IMGWRFlush();
+      if (0 != RetVal) {
+        IMGWRAbort();
+        return RetVal;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Check the digest and hand the image to the bootloader.
+ */
+int32_t IMGWREnd(int32_t check) {
+  int32_t RetVal;
+
+  /* Called again after CFG_BUSY, only the configuration is left. */
+  if (!state.pending) {
+    if (0 > state.hFile)
+      return -1;
+
+    RetVal = IMGWRFlush();
+    if (0 != RetVal) {
+      IMGWRAbort();
+      return RetVal;
+    }
+
+    sl_FsClose(state.hFile, NULL, NULL, 0);
+    state.hFile = -1;
+    stats.ticks = (uint32_t) MAP_PRCMSlowClkCtrGet() - state.start;
+
+    if ((IMG_DIGEST_NONE != state.hdr.digestalg)
+        && ((state.offset < IMG_PAYLOAD_OFF(&state.hdr)
+            + IMG_STORED_LEN(&state.hdr))
+            || DIGESTCheck(&state.ctx, state.hdr.digest))) {
+      sl_FsDel(BOOTSlotName(state.slot), 0);
+      return -1;
+    }
+
+    state.pending = 1;
+  }
+
+  state.check = check;
+
+  RetVal = CFGUpdate(IMGWREdit, &state);
+  if (CFG_BUSY == RetVal)
+    return RetVal;
+
+  state.pending = 0;
+
+  /* IMG_CUSTOM is another file now. */
+  SCRUBReset();
+
+  return RetVal;
+}
+
+/*
+ * Close and delete the partial image, or the one waiting for the
+ * configuration; the custom image is untouched.
+ */
+void IMGWRAbort() {
+  if (0 <= state.hFile) {
+    sl_FsClose(state.hFile, NULL, NULL, 0);
+    state.hFile = -1;
+  }
+  else if (!state.pending) {
+    return;
+  }
+
+  state.pending = 0;
+  sl_FsDel(BOOTSlotName(state.slot), 0);
+}
+
+/*
+ * Allocate and erase the spare slot ahead of the next update.
+ */
+int32_t IMGWRPrepare(uint32_t maxlen) {
+  unsigned char *name;
+  uint32_t slot;
+  int32_t hFile;
+  int32_t RetVal;
+
+  if ((0 <= state.hFile) || state.pending)
+    return -1;
+
+  RetVal = IMGWRSpare(&slot);
+  if (0 != RetVal)
+    return RetVal;
+
+  name = BOOTSlotName(slot);
+  if (IMGWRReady(name, maxlen))
+    return 0;
+
+  sl_FsDel(name, 0);
+
+  RetVal = sl_FsOpen(name, FS_MODE_OPEN_CREATE(maxlen, IMGWR_FLAGS), NULL,
+      &hFile);
+  if (0 != RetVal)
+    return RetVal;
+
+  sl_FsClose(hFile, NULL, NULL, 0);
+  return 0;
+}
+
+/*
+ * Get the counters.
+ */
+void IMGWRStats(imgwrstats_t *imgwrstats) {
+  *imgwrstats = stats;
+}
+
+/*!
+ * \}
+ */
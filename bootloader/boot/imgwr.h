@@ -0,0 +1,213 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup ImgWr ImgWr
+ * \{
+ *
+ * \brief Writes a new custom image received by the application.
+ *
+ * ### Overview
+ * The update path of the applications: the image is received in pieces of
+ * any size (from a socket, for example) and passed to IMGWRWrite. The
+ * pieces are staged in a IMGWR_BUF_SIZE buffer, so the flash is written in
+ * large blocks whatever the size of the network reads.
+ *
+ * The header of the image is taken from the first bytes and the payload
+ * digest (imghdr_t::digestalg) is computed while the data goes by, so no
+ * read back is needed. IMGWREnd checks it and, if asked, sets the boot
+ * configuration to BOOT_CHECK so the new image is started on trial at the
+ * next reset. An image that doesn't match its digest is deleted.
+ *
+ * The image is written to the custom image slot that is not in use (see
+ * boot.h), so the current custom image stays intact until IMGWREnd switches
+ * bootinfo_t::customslot. Creating the file makes the NWP allocate and
+ * erase its whole size, seconds for a large image, before the first byte
+ * is written. IMGWRPrepare does that ahead of time, from the idle loop or
+ * right after the image is confirmed, for the largest image expected; the
+ * next IMGWRBegin then only opens the slot.
+ *
+ * The configuration is read and updated through the configuration service
+ * (Cfg), so the update can run in a task of its own. If another task is
+ * writing the configuration IMGWREnd returns CFG_BUSY and is called again;
+ * the image is already checked and only the configuration is left. Switching
+ * the slot restarts the scrubber (SCRUBReset).
+ *
+ * IMGWRStats gives the bytes and the flash writes of the last update and
+ * the time it took (slow clock), to measure the update throughput on the
+ * target.
+ *
+ * ### Requires
+ * - Driverlib.
+ * - Simplelink (Can be the TINY build).
+ * - Boot.
+ * - Cfg.
+ * - Scrub.
+ * - Blake2s.
+ * - Cksum.
+ *
+ * ### Example
+ *
+ * \code
+ *  CFGInit();
+ *
+ *  // After CONFIRMImage, or when idle.
+ *  IMGWRPrepare(IMG_MAX_LEN);
+ *
+ *  IMGWRBegin(len);
+ *
+ *  while ((n = recv(sock, buf, sizeof(buf), 0)) > 0)
+ *    if (0 != IMGWRWrite(buf, n))
+ *      break;
+ *
+ *  while (CFG_BUSY == (RetVal = IMGWREnd(1)))
+ *    osi_Sleep(1);
+ *
+ *  if (0 == RetVal)
+ *    PRCMSOCReset();
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _IMGWR_H_
+#define _IMGWR_H_
+
+/*!
+ *	\file imgwr.h
+ *
+ *	\brief Constants, types and function prototypes of the image writer.
+ *
+ *	This file contains definitions used by the imgwr.c.
+ */
+
+/*!
+ *	\def IMGWR_BUF_SIZE
+ *
+ * 	\brief Size of the staging buffer, bytes per flash write.
+ */
+#ifndef IMGWR_BUF_SIZE
+#define IMGWR_BUF_SIZE	1024
+#endif
+
+/*!
+ *	\struct imgwrstats_t
+ *
+ *	\brief Counters of the last update.
+ */
+typedef struct {
+  /*! Bytes received. */
+  uint32_t bytes;
+  /*! Calls to sl_FsWrite. */
+  uint32_t writes;
+  /*! Slow clock (32768Hz) ticks from IMGWRBegin to IMGWREnd. */
+  uint32_t ticks;
+  /*! Slow clock ticks from IMGWRBegin to the end of the first write. */
+  uint32_t firstticks;
+  /*! 1 if the slot was prepared by IMGWRPrepare. */
+  uint32_t prepared;
+} imgwrstats_t;
+
+/*!
+ *	\fn int32_t IMGWRBegin(uint32_t len)
+ *
+ * 	\brief Start writing a new custom image.
+ *
+ * 	The spare slot is opened if IMGWRPrepare made it ready for len bytes,
+ * 	otherwise it is deleted and created again.
+ *
+ * 	\param[in] len Size of the image file in bytes.
+ *
+ * 	\return 0 on success, -1 if CFGInit was not called, SL error code
+ * 	otherwise.
+ */
+int32_t IMGWRBegin(uint32_t len);
+
+/*!
+ *	\fn int32_t IMGWRWrite(const unsigned char *data, uint32_t len)
+ *
+ * 	\brief Write the next bytes of the image.
+ *
+ * 	\param[in] data Image bytes.
+ * 	\param[in] len Number of bytes in data.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t IMGWRWrite(const unsigned char *data, uint32_t len);
+
+/*!
+ *	\fn int32_t IMGWREnd(int32_t check)
+ *
+ * 	\brief Finish the image and check its digest.
+ *
+ * 	The slot written becomes the custom image slot, through CFGUpdate.
+ *
+ * 	\param[in] check If not 0, set the boot configuration to BOOT_CHECK.
+ *
+ * 	\return 0 on success, CFG_BUSY if another task is writing the
+ * 	configuration (call it again, or IMGWRAbort), SL error code or -1
+ * 	otherwise (the image is deleted if its digest doesn't match).
+ */
+int32_t IMGWREnd(int32_t check);
+
+/*!
+ *	\fn void IMGWRAbort(void)
+ *
+ * 	\brief Stop writing and delete the partial image.
+ *
+ * 	Also deletes an image IMGWREnd could not hand over (CFG_BUSY).
+ */
+void IMGWRAbort(void);
+
+/*!
+ *	\fn int32_t IMGWRPrepare(uint32_t maxlen)
+ *
+ * 	\brief Allocate and erase the spare slot for the next update.
+ *
+ * 	Does nothing if it is already prepared for maxlen bytes or more.
+ *
+ * 	\param[in] maxlen Largest image file expected, in bytes.
+ *
+ * 	\return 0 on success, -1 during an update or if CFGInit was not called,
+ * 	the SL error code otherwise.
+ */
+int32_t IMGWRPrepare(uint32_t maxlen);
+
+/*!
+ *	\fn void IMGWRStats(imgwrstats_t *imgwrstats)
+ *
+ * 	\brief Get the counters of the last update.
+ *
+ * 	\param[out] imgwrstats Structure to hold the counters.
+ */
+void IMGWRStats(imgwrstats_t *imgwrstats);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,419 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup KV
+ * \{
+ */
+
+/*!
+ * 	\file kv.c
+ *
+ * 	\brief Implementation of the KV store.
+ *
+ * 	This file implements the record log, the index and the compaction.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "simplelink.h"
+#include "kv.h"
+#include "fs.h"
+
+/*!
+ * 	\var static unsigned char kvfile[]
+ *
+ * 	\brief Path of the store file.
+ *
+ * 	The file is saved as /sys/kv.bin.
+ */
+static unsigned char kvfile[] = "/sys/kv.bin";
+
+/*!
+ * 	\struct kvindex_t
+ *
+ * 	\brief Index entry, the latest record of a key.
+ */
+typedef struct {
+  /*! Key. */
+  char key[KV_KEY_LEN];
+  /*! Offset of the record in the log. */
+  uint32_t off;
+} kvindex_t;
+
+/*! Copy of the log, word aligned for the record headers. */
+static uint32_t kvlog[KV_FILE_SIZE / 4];
+
+/*! Bytes used in the log. */
+static uint32_t used;
+
+/*! Bytes of the log already written in the current session. */
+static uint32_t flushed;
+
+/*! Index of the live keys. */
+static kvindex_t kvindex[KV_MAX_KEYS];
+
+/*! Number of entries in the index. */
+static uint32_t nkeys;
+
+/*! Handle of the write session, -1 if there is none. */
+static int32_t hWrite = -1;
+
+/*! Not 0 after KVOpen. */
+static int32_t loaded;
+
+/*! Statistics. */
+static kvstats_t stats;
+
+/*!
+ * 	\def KVREC
+ *
+ * 	\brief Pointer to the record at an offset of the log.
+ */
+#define KVREC(off)	((kvrec_t*) ((unsigned char*) kvlog + (off)))
+
+/*
+ * Size of a record in the log.
+ */
+static uint32_t KVRecLen(uint16_t vallen) {
+  if (KV_DELETED == vallen)
+    return sizeof(kvrec_t);
+
+  return sizeof(kvrec_t) + ((vallen + 3) & ~3);
+}
+
+/*
+ * CRC32 (IEEE, bitwise) of the key, length and value of a record.
+ */
+static uint32_t KVCrc(kvrec_t *rec) {
+  const unsigned char *p;
+  uint32_t crc = 0xFFFFFFFF;
+  uint32_t len;
+  uint32_t i;
+  uint32_t bit;
+
+  for (i = 0; i < 3; i++) {
+    switch (i) {
+    case 0:
+      p = (const unsigned char*) rec->key;
+      len = KV_KEY_LEN;
+      break;
+
+    case 1:
+      p = (const unsigned char*) &rec->vallen;
+      len = sizeof(rec->vallen);
+      break;
+
+    default:
+      p = (const unsigned char*) (rec + 1);
+      len = (KV_DELETED == rec->vallen) ? 0 : rec->vallen;
+      break;
+    }
+
+    while (len--) {
+      crc ^= *p++;
+      for (bit = 0; bit < 8; bit++)
+        crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+  }
+
+  return ~crc;
+}
+
+/*
+ * Pad a key to KV_KEY_LEN.
+ */
+static void KVKey(char *out, const char *key) {
+  memset(out, 0, KV_KEY_LEN);
+  strncpy(out, key, KV_KEY_LEN);
+}
+
+/*
+ * Find a key in the index.
+ */
+static int32_t KVFind(const char *key) {
+  uint32_t i;
+
+  for (i = 0; i < nkeys; i++) {
+    if (0 == memcmp(kvindex[i].key, key, KV_KEY_LEN))
+      return i;
+  }
+
+  return -1;
+}
+
+/*
+ * Update the index with the record at off.
+ */
+static int32_t KVApply(uint32_t off) {
+  kvrec_t *rec = KVREC(off);
+  int32_t slot = KVFind(rec->key);
+
+  if (KV_DELETED == rec->vallen) {
+    /* Remove the key, moving the last entry to its place. */
+    if (0 <= slot)
+      kvindex[slot] = kvindex[--nkeys];
+    return 0;
+  }
+
+  if (0 > slot) {
+    if (KV_MAX_KEYS == nkeys)
+      return -1;
+
+    slot = nkeys++;
+    memcpy(kvindex[slot].key, rec->key, KV_KEY_LEN);
+  }
+
+  kvindex[slot].off = off;
+  return 0;
+}
+
+/*
+ * Drop the old records from the log (RAM only).
+ */
+static void KVCompact(void) {
+  uint32_t src;
+  uint32_t dst = 0;
+  uint32_t len;
+  int32_t slot;
+
+  for (src = 0; src < used; src += len) {
+    len = KVRecLen(KVREC(src)->vallen);
+    slot = KVFind(KVREC(src)->key);
+
+    /* Keep only the latest record of the live keys. */
+    if ((0 > slot) || (kvindex[slot].off != src))
+      continue;
+
+    if (dst != src)
+      memmove(KVREC(dst), KVREC(src), len);
+
+    kvindex[slot].off = dst;
+    dst += len;
+  }
+
+  if (dst != used)
+    stats.compactions++;
+
+  used = dst;
+}
+
+/*
+ * Write the new part of the log, starting a session if needed.
+ */
+static int32_t KVFlush(void) {
+  int32_t RetVal;
+
+  if (0 > hWrite) {
+    /* The file is rewritten in each session, write only the live records. */
+    KVCompact();
+
+    RetVal = sl_FsOpen(kvfile, FS_MODE_OPEN_WRITE, NULL, &hWrite);
+    if (0 != RetVal) {
+      RetVal = sl_FsOpen(kvfile,
+          FS_MODE_OPEN_CREATE(KV_FILE_SIZE, _FS_FILE_OPEN_FLAG_COMMIT |
+              _FS_FILE_PUBLIC_WRITE | _FS_FILE_PUBLIC_READ), NULL, &hWrite);
+      if (0 != RetVal) {
+        hWrite = -1;
+        return RetVal;
+      }
+    }
+
+    flushed = 0;
+  }
+
+  if (flushed == used)
+    return 0;
+
+  RetVal = sl_FsWrite(hWrite, flushed, (unsigned char*) KVREC(flushed),
+      used - flushed);
+  if (RetVal != (int32_t) (used - flushed))
+    return (0 > RetVal) ? RetVal : -1;
+
+  stats.written += used - flushed;
+  flushed = used;
+  return 0;
+}
+
+/*
+ * Append a record and write it.
+ */
+static int32_t KVAppend(const char *key, const void *value, uint16_t vallen) {
+  kvrec_t *rec;
+  char padded[KV_KEY_LEN];
+  uint32_t len = KVRecLen(vallen);
+
+  if (!loaded)
+    return -1;
+
+  KVKey(padded, key);
+
+  /* Check for room in the index before touching the log. */
+  if ((KV_DELETED != vallen) && (0 > KVFind(padded)) && (KV_MAX_KEYS == nkeys))
+    return -1;
+
+  /* Full, compact and start a new session. */
+  if (used + len > sizeof(kvlog)) {
+    KVSync();
+    KVCompact();
+
+    if (used + len > sizeof(kvlog))
+      return -1;
+  }
+
+  rec = KVREC(used);
+  memset(rec, 0, len);
+  memcpy(rec->key, padded, KV_KEY_LEN);
+  rec->magic = KV_MAGIC;
+  rec->vallen = vallen;
+  if (KV_DELETED != vallen)
+    memcpy(rec + 1, value, vallen);
+  rec->crc = KVCrc(rec);
+
+  KVApply(used);
+  used += len;
+
+  stats.puts++;
+  stats.logical += len;
+
+  return KVFlush();
+}
+
+/*
+ * Read the log and build the index.
+ */
+int32_t KVOpen() {
+  int32_t RetVal;
+  int32_t hFile;
+  uint32_t off = 0;
+  uint32_t len;
+  uint32_t size = 0;
+  kvrec_t *rec;
+
+  KVSync();
+
+  used = 0;
+  nkeys = 0;
+  loaded = 1;
+
+  /* No file yet, empty store. */
+  RetVal = sl_FsOpen(kvfile, FS_MODE_OPEN_READ, NULL, &hFile);
+  if (0 != RetVal)
+    return 0;
+
+  RetVal = sl_FsRead(hFile, 0, (unsigned char*) kvlog, sizeof(kvlog));
+  sl_FsClose(hFile, NULL, NULL, 0);
+  if (0 > RetVal)
+    return RetVal;
+
+  size = RetVal;
+
+  /* Apply the records up to the first invalid (torn) one. */
+  while (off + sizeof(kvrec_t) <= size) {
+    rec = KVREC(off);
+    if (KV_MAGIC != rec->magic)
+      break;
+
+    len = KVRecLen(rec->vallen);
+    if ((off + len > size) || (KVCrc(rec) != rec->crc) || (0 != KVApply(off)))
+      break;
+
+    off += len;
+  }
+
+  used = off;
+  return 0;
+}
+
+/*
+ * Copy the value of a key.
+ */
+int32_t KVGet(const char *key, void *value, uint32_t len) {
+  char padded[KV_KEY_LEN];
+  kvrec_t *rec;
+  int32_t slot;
+
+  if (!loaded)
+    return -1;
+
+  stats.gets++;
+
+  KVKey(padded, key);
+  slot = KVFind(padded);
+  if (0 > slot)
+    return -1;
+
+  rec = KVREC(kvindex[slot].off);
+  if ((NULL != value) && (0 < len))
+    memcpy(value, rec + 1, (len < rec->vallen) ? len : rec->vallen);
+
+  return rec->vallen;
+}
+
+/*
+ * Append a record with the new value.
+ */
+int32_t KVPut(const char *key, const void *value, uint32_t len) {
+  if (len >= KV_DELETED)
+    return -1;
+
+  return KVAppend(key, value, len);
+}
+
+/*
+ * Append a record that deletes the key.
+ */
+int32_t KVDelete(const char *key) {
+  char padded[KV_KEY_LEN];
+
+  KVKey(padded, key);
+  if (loaded && (0 > KVFind(padded)))
+    return 0;
+
+  return KVAppend(key, NULL, KV_DELETED);
+}
+
+/*
+ * Close the write session, committing it.
+ */
+int32_t KVSync() {
+  int32_t RetVal = 0;
+
+  if (0 <= hWrite)
+    RetVal = sl_FsClose(hWrite, NULL, NULL, 0);
+
+  hWrite = -1;
+  return RetVal;
+}
+
+/*
+ * Copy the statistics.
+ */
+void KVStats(kvstats_t *out) {
+  *out = stats;
+}
+
+/*!
+ * \}
+ */
@@ -0,0 +1,240 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup KV KV
+ * \{
+ *
+ * \brief Log-structured key-value settings store.
+ *
+ * ### Overview
+ * Small settings of the application are kept as records appended to a
+ * single pre-allocated SimpleLink file, instead of one small file per
+ * setting rewritten on every change. The boot configuration is not kept
+ * here (see boot.h), the bootloader doesn't link the store.
+ *
+ * Each record is a kvrec_t (fixed size key, value length and CRC32) followed
+ * by the value, padded to 4 bytes. A newer record of a key replaces the older
+ * ones, and a record with KV_DELETED as length removes the key. KVOpen scans
+ * the file, drops a torn record at the end (bad CRC) and builds the index in
+ * RAM. When the file is full, the live records are compacted.
+ *
+ * The CC3200 file system discards the contents of a file when it is opened
+ * for writing, so the store keeps a copy of the log in RAM and writes in
+ * sessions: the first KVPut after KVOpen or KVSync opens the file, writes
+ * the compacted log and then appends the records as they come. KVSync closes
+ * the file, which commits the session. The file is created fail-safe, so a
+ * reset in the middle of a session keeps the last committed version.
+ *
+ * So a KVPut is not durable until KVSync returns, and every session costs a
+ * rewrite of all the live records. Batch the changes that belong together
+ * between two KVSync calls instead of syncing after each put. A single
+ * setting synced on every change costs as much as its own file: the store
+ * pays off with many settings, read from RAM after one KVOpen, and changes
+ * batched (make kvbench in tools/host).
+ *
+ * KVStats counts the bytes requested by the puts and the bytes written to
+ * the flash, giving the write amplification.
+ *
+ * ### Requires
+ * - Simplelink (Can be the TINY build).
+ *
+ * ### Example
+ *
+ * \code
+ *  uint32_t interval = 60;
+ *
+ *  KVOpen();
+ *
+ *  if (0 > KVGet("interval", &interval, sizeof(interval)))
+ *    KVPut("interval", &interval, sizeof(interval));
+ *
+ *  KVSync();
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _KV_H_
+#define _KV_H_
+
+/*!
+ *	\file kv.h
+ *
+ *	\brief Constants, types and function prototypes of the KV store.
+ *
+ *	This file contains definitions used by the kv.c.
+ */
+
+/*!
+ *	\def KV_KEY_LEN
+ *
+ * 	\brief Size of a key, shorter keys are padded with '\\0'.
+ */
+#define KV_KEY_LEN	16
+
+#ifndef KV_FILE_SIZE
+/*!
+ *	\def KV_FILE_SIZE
+ *
+ * 	\brief Size of the store file, also kept in RAM.
+ */
+#define KV_FILE_SIZE	2048
+#endif
+
+#ifndef KV_MAX_KEYS
+/*!
+ *	\def KV_MAX_KEYS
+ *
+ * 	\brief Maximum number of keys in the store.
+ */
+#define KV_MAX_KEYS	16
+#endif
+
+/*!
+ *	\def KV_MAGIC
+ *
+ * 	\brief Marker ("KV") at the start of every record.
+ */
+#define KV_MAGIC	0x564B
+
+/*!
+ *	\def KV_DELETED
+ *
+ * 	\brief Value length of a record that deletes its key.
+ */
+#define KV_DELETED	0xFFFF
+
+/*!
+ *	\struct kvrec_t
+ *
+ *	\brief Record header, followed by the value.
+ */
+typedef struct {
+  /*! Must be KV_MAGIC. */
+  uint16_t magic;
+  /*! Length of the value, or KV_DELETED. */
+  uint16_t vallen;
+  /*! CRC32 of the key, vallen and value. */
+  uint32_t crc;
+  /*! Key. */
+  char key[KV_KEY_LEN];
+} kvrec_t;
+
+/*!
+ *	\struct kvstats_t
+ *
+ *	\brief Store statistics.
+ */
+typedef struct {
+  /*! Number of KVGet calls. */
+  uint32_t gets;
+  /*! Number of KVPut and KVDelete calls. */
+  uint32_t puts;
+  /*! Bytes of the records put (header and value). */
+  uint32_t logical;
+  /*! Bytes written to the flash. */
+  uint32_t written;
+  /*! Number of compactions. */
+  uint32_t compactions;
+} kvstats_t;
+
+/*!
+ *	\fn int32_t KVOpen(void)
+ *
+ * 	\brief Load the store.
+ *
+ * 	Reads /sys/kv.bin and builds the index. A missing file is an empty store.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t KVOpen(void);
+
+/*!
+ *	\fn int32_t KVGet(const char *key, void *value, uint32_t len)
+ *
+ * 	\brief Get the value of a key.
+ *
+ * 	\param[in] key Key, up to KV_KEY_LEN characters.
+ * 	\param[out] value Buffer to hold the value, can be NULL.
+ * 	\param[in] len Size of the buffer, the value is truncated to it.
+ *
+ * 	\return Length of the value, -1 if the key doesn't exist.
+ */
+int32_t KVGet(const char *key, void *value, uint32_t len);
+
+/*!
+ *	\fn int32_t KVPut(const char *key, const void *value, uint32_t len)
+ *
+ * 	\brief Set the value of a key.
+ *
+ * 	The record is written to the flash right away, but it is only committed
+ * 	by KVSync: it is lost if the device resets before.
+ *
+ * 	\param[in] key Key, up to KV_KEY_LEN characters.
+ * 	\param[in] value Value.
+ * 	\param[in] len Length of the value.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t KVPut(const char *key, const void *value, uint32_t len);
+
+/*!
+ *	\fn int32_t KVDelete(const char *key)
+ *
+ * 	\brief Remove a key.
+ *
+ * 	\param[in] key Key, up to KV_KEY_LEN characters.
+ *
+ * 	\return 0 on success (or if the key doesn't exist), SL error code or -1
+ * 	otherwise.
+ */
+int32_t KVDelete(const char *key);
+
+/*!
+ *	\fn int32_t KVSync(void)
+ *
+ * 	\brief Commit the records written since the last sync.
+ *
+ * 	\return 0 on success, SL error code otherwise.
+ */
+int32_t KVSync(void);
+
+/*!
+ *	\fn void KVStats(kvstats_t *stats)
+ *
+ * 	\brief Get the store statistics.
+ *
+ * 	\param[out] stats Structure to hold the statistics.
+ */
+void KVStats(kvstats_t *stats);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,186 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Netboot
+ * \{
+ */
+
+/*!
+ * 	\file netboot.c
+ *
+ * 	\brief Implementation of the network boot.
+ *
+ * 	This file implements the client of the chunked image protocol.
+ */
+
+#include <stdint.h>
+#include "hw_types.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "netboot.h"
+
+/*!
+ * 	\def NETBOOT_RECV_MAX
+ *
+ * 	\brief Largest single sl_Recv.
+ */
+#define NETBOOT_RECV_MAX	1460
+
+/*! Set when the NWP got an IP address. */
+static volatile uint32_t ipacquired;
+
+/*
+ * Receive exactly len bytes.
+ */
+static int32_t NETBOOTRecv(int16_t sd, unsigned char *buf, uint32_t len) {
+  int16_t RetVal;
+  uint32_t n;
+
+  while (len) {
+    n = (len < NETBOOT_RECV_MAX) ? len : NETBOOT_RECV_MAX;
+
+    RetVal = sl_Recv(sd, buf, (int16_t) n, 0);
+    if (0 >= RetVal)
+      return (0 > RetVal) ? RetVal : -1;
+
+    buf += RetVal;
+    len -= RetVal;
+  }
+
+  return 0;
+}
+
+/*
+ * Wait for the IP address, the events are handled by the simplelink loop.
+ */
+static int32_t NETBOOTWaitIp(void) {
+  uint32_t start = (uint32_t) MAP_PRCMSlowClkCtrGet();
+
+  while (!ipacquired) {
+    _SlNonOsMainLoopTask();
+
+    if ((uint32_t) MAP_PRCMSlowClkCtrGet() - start
+        > NETBOOT_CONNECT_MS * 32768 / 1000)
+      return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Send the request and receive the chunks on a connected socket.
+ */
+static int32_t NETBOOTSession(int16_t sd, uint32_t addr, uint32_t maxlen) {
+  uint32_t magic = NETBOOT_MAGIC;
+  uint32_t total = 0;
+  uint32_t len;
+  int32_t RetVal;
+
+  RetVal = sl_Send(sd, &magic, sizeof(magic), 0);
+  if ((int32_t) sizeof(magic) != RetVal)
+    return (0 > RetVal) ? RetVal : -1;
+
+  for (;;) {
+    RetVal = NETBOOTRecv(sd, (unsigned char*) &len, sizeof(len));
+    if (0 != RetVal)
+      return RetVal;
+
+    if (0 == len)
+      return (int32_t) total;
+
+    if (len > maxlen - total)
+      return -1;
+
+    /* The data goes straight to its place in the SRAM. */
+    RetVal = NETBOOTRecv(sd, (unsigned char*) addr + total, len);
+    if (0 != RetVal)
+      return RetVal;
+
+    total += len;
+  }
+}
+
+/*
+ * Connect to the server and fetch the image.
+ */
+int32_t NETBOOTFetch(uint32_t ip, uint16_t port, uint32_t addr,
+    uint32_t maxlen) {
+  SlSockAddrIn_t server;
+  SlTimeval_t timeout;
+  int32_t RetVal;
+  int16_t sd;
+
+  RetVal = NETBOOTWaitIp();
+  if (0 != RetVal)
+    return RetVal;
+
+  sd = sl_Socket(SL_AF_INET, SL_SOCK_STREAM, SL_IPPROTO_TCP);
+  if (0 > sd)
+    return sd;
+
+  timeout.tv_sec = NETBOOT_RECV_MS / 1000;
+  timeout.tv_usec = (NETBOOT_RECV_MS % 1000) * 1000;
+  sl_SetSockOpt(sd, SL_SOL_SOCKET, SL_SO_RCVTIMEO, &timeout,
+      sizeof(SlTimeval_t));
+
+  server.sin_family = SL_AF_INET;
+  server.sin_port = sl_Htons(port);
+  server.sin_addr.s_addr = sl_Htonl(ip);
+
+  RetVal = sl_Connect(sd, (SlSockAddr_t*) &server, sizeof(SlSockAddrIn_t));
+  if (0 <= RetVal)
+    RetVal = NETBOOTSession(sd, addr, maxlen);
+
+  sl_Close(sd);
+  return RetVal;
+}
+
+/*
+ * Fetch the image to BASE_ADDR and prepare it.
+ */
+int32_t NETBOOTLoad(uint32_t ip, uint16_t port) {
+  int32_t RetVal;
+
+  RetVal = NETBOOTFetch(ip, port, BASE_ADDR, RETAINED_ADDR - BASE_ADDR);
+  if (0 > RetVal)
+    return RetVal;
+
+  return BOOTLoadMem(BASE_ADDR, (uint32_t) RetVal, BASE_ADDR);
+}
+
+/*
+ * Note the IP address.
+ */
+void NETBOOTNetAppEvent(SlNetAppEvent_t *event) {
+  if ((NULL != event) && (SL_NETAPP_IPV4_IPACQUIRED_EVENT == event->Event))
+    ipacquired = 1;
+}
+
+/*!
+ * \}
+ */
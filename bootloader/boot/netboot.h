@@ -0,0 +1,135 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Netboot Netboot
+ * \{
+ *
+ * \brief Load the image from a server in the local network.
+ *
+ * ### Overview
+ * Lab boards boot a new build without writing it to the serial flash. When
+ * the bootloader is built with BOOT_NETBOOT, bootinfo_t::netaddr is not 0
+ * and the boot status is BOOT_OK, it waits for the NWP to connect to the
+ * access point (the NWP must have a profile and the auto connect policy),
+ * fetches the image file from the server straight into the SRAM and starts
+ * it with BOOTLoadMem. If anything fails, the normal boot from the flash
+ * goes on.
+ *
+ * The protocol is a TCP stream. The bootloader sends NETBOOT_MAGIC, the
+ * server answers with the image file in chunks, each one a little endian
+ * uint32_t length followed by the data, and a chunk of length 0 at the end.
+ * tools/netboot.py is a server for it.
+ *
+ * Netbooted images are not on trial and must be linked for BASE_ADDR (they
+ * can't be relocated and have no extra files).
+ *
+ * ### Requires
+ * - Driverlib.
+ * - Simplelink (Non TINY build).
+ * - Boot.
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _NETBOOT_H_
+#define _NETBOOT_H_
+
+/*!
+ *	\file netboot.h
+ *
+ *	\brief Constants and function prototypes of the network boot.
+ *
+ *	This file contains definitions used by the netboot.c.
+ */
+
+/*!
+ *	\def NETBOOT_MAGIC
+ *
+ * 	\brief Request sent to the server ("NBOT").
+ */
+#define NETBOOT_MAGIC	0x544F424E
+
+/*!
+ *	\def NETBOOT_CONNECT_MS
+ *
+ * 	\brief Time to wait for an IP address.
+ */
+#ifndef NETBOOT_CONNECT_MS
+#define NETBOOT_CONNECT_MS	10000
+#endif
+
+/*!
+ *	\def NETBOOT_RECV_MS
+ *
+ * 	\brief Receive timeout of the socket.
+ */
+#ifndef NETBOOT_RECV_MS
+#define NETBOOT_RECV_MS	2000
+#endif
+
+/*!
+ *	\fn int32_t NETBOOTFetch(uint32_t ip, uint16_t port, uint32_t addr, uint32_t maxlen)
+ *
+ * 	\brief Fetch the image file from the server into the SRAM.
+ *
+ * 	\param[in] ip IPv4 address of the server.
+ * 	\param[in] port TCP port of the server.
+ * 	\param[in] addr Where to put the file.
+ * 	\param[in] maxlen Space available at addr.
+ *
+ * 	\return Length of the file, SL error code or -1 otherwise.
+ */
+int32_t NETBOOTFetch(uint32_t ip, uint16_t port, uint32_t addr,
+    uint32_t maxlen);
+
+/*!
+ *	\fn int32_t NETBOOTLoad(uint32_t ip, uint16_t port)
+ *
+ * 	\brief Fetch the image file to BASE_ADDR and prepare it to run.
+ *
+ * 	\param[in] ip IPv4 address of the server.
+ * 	\param[in] port TCP port of the server.
+ *
+ * 	\return 0 on success, SL error code or -1 otherwise.
+ */
+int32_t NETBOOTLoad(uint32_t ip, uint16_t port);
+
+/*!
+ *	\fn void NETBOOTNetAppEvent(SlNetAppEvent_t *event)
+ *
+ * 	\brief Must be called from SimpleLinkNetAppEventHandler.
+ *
+ * 	\param[in] event NetApp event.
+ */
+void NETBOOTNetAppEvent(SlNetAppEvent_t *event);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,184 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Patch
+ * \{
+ */
+
+/*!
+ * 	\file patch.c
+ *
+ * 	\brief Implementation of the patch table.
+ *
+ * 	This file implements the per-device patches applied at load time.
+ */
+
+#ifdef BOOT_PATCH
+
+#include <stdint.h>
+#include "simplelink.h"
+#include "boot.h"
+#include "bcache.h"
+#include "cksum.h"
+#include "patch.h"
+#include "fs.h"
+
+/*!
+ * 	\var static unsigned char patchfile[]
+ *
+ * 	\brief Path of the patch file.
+ *
+ * 	The file is saved as /sys/patch.bin.
+ */
+static unsigned char patchfile[] = "/sys/patch.bin";
+
+/*!
+ * 	\def PATCH_BATCH
+ *
+ * 	\brief Records read from the file at once.
+ */
+#define PATCH_BATCH	16
+
+/*
+ * Check that a record falls inside one of the regions.
+ */
+static int32_t PATCHInRegion(const patchrec_t *rec, const imgregion_t *regions,
+    uint32_t count, imghdr_t *hdr) {
+  uint32_t start;
+  uint32_t i;
+
+  if ((rec->offset & 3) || (rec->offset > hdr->imglen - 4))
+    return 0;
+
+  for (i = 0; i < count; i++) {
+    start = regions[i].addr - hdr->linkaddr;
+    if ((rec->offset >= start) && (rec->offset - start <= regions[i].len - 4))
+      return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Read the records, checking them all or writing them to the image.
+ */
+static int32_t PATCHRecords(int32_t hPatch, const patchhdr_t *phdr,
+    const imgregion_t *regions, uint32_t count, imghdr_t *hdr, uint32_t addr,
+    int32_t write) {
+  patchrec_t recs[PATCH_BATCH];
+  uint32_t adler = CKSUM_ADLER_INIT;
+  uint32_t done = 0;
+  uint32_t n;
+  uint32_t i;
+  int32_t RetVal;
+
+  while (done < phdr->count) {
+    n = phdr->count - done;
+    if (n > PATCH_BATCH)
+      n = PATCH_BATCH;
+
+    RetVal = sl_FsRead(hPatch, sizeof(patchhdr_t) + done * sizeof(patchrec_t),
+        (unsigned char*) recs, n * sizeof(patchrec_t));
+    if ((int32_t) (n * sizeof(patchrec_t)) != RetVal)
+      return (0 > RetVal) ? RetVal : -1;
+
+    for (i = 0; i < n; i++) {
+      if (!PATCHInRegion(&recs[i], regions, count, hdr))
+        return -1;
+
+      if (write)
+        *(uint32_t*) (addr + recs[i].offset) = recs[i].value;
+    }
+
+    adler = CKSUMAdler32(adler, (const uint8_t*) recs, n * sizeof(patchrec_t));
+    done += n;
+  }
+
+  return (adler == phdr->check) ? 0 : -1;
+}
+
+/*
+ * Check the whole patch file, then apply it.
+ */
+int32_t PATCHApply(int32_t hFile, imghdr_t *hdr, uint32_t addr) {
+  imgregion_t regions[BOOT_MAX_REGIONS];
+  patchhdr_t phdr;
+  uint32_t size = hdr->regioncount * sizeof(imgregion_t);
+  uint32_t i;
+  int32_t hPatch;
+  int32_t RetVal;
+
+  HANDOFF->patches = 0;
+
+  if (0 == hdr->regioncount)
+    return 0;
+
+  if (hdr->regioncount > BOOT_MAX_REGIONS)
+    return -1;
+
+  RetVal = BCACHERead(hFile, hdr->regionoff, (unsigned char*) regions, size);
+  if ((int32_t) size != RetVal)
+    return -1;
+
+  /* The regions must be inside the payload. */
+  for (i = 0; i < hdr->regioncount; i++) {
+    if ((regions[i].addr & 3) || (regions[i].len < 4)
+        || (regions[i].addr < hdr->linkaddr)
+        || (regions[i].addr - hdr->linkaddr > hdr->imglen)
+        || (regions[i].len > hdr->imglen - (regions[i].addr - hdr->linkaddr)))
+      return -1;
+  }
+
+  RetVal = sl_FsOpen(patchfile, FS_MODE_OPEN_READ, NULL, &hPatch);
+  if (0 != RetVal)
+    return 0;
+
+  RetVal = sl_FsRead(hPatch, 0, (unsigned char*) &phdr, sizeof(patchhdr_t));
+  if ((int32_t) sizeof(patchhdr_t) != RetVal) {
+    RetVal = (0 > RetVal) ? RetVal : -1;
+  }
+  else if ((PATCH_MAGIC != phdr.magic) || (phdr.count > PATCH_MAX_RECORDS)) {
+    RetVal = -1;
+  }
+  else {
+    /* Nothing is written unless every record is good. */
+    RetVal = PATCHRecords(hPatch, &phdr, regions, hdr->regioncount, hdr, addr,
+        0);
+    if (0 == RetVal)
+      RetVal = PATCHRecords(hPatch, &phdr, regions, hdr->regioncount, hdr,
+          addr, 1);
+  }
+
+  sl_FsClose(hPatch, NULL, NULL, 0);
+
+  HANDOFF->patches = (0 == RetVal) ? (int32_t) phdr.count : RetVal;
+  return 0;
+}
+
+#endif
+
+/*!
+ * \}
+ */
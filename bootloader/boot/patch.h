@@ -0,0 +1,153 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Patch Patch
+ * \{
+ *
+ * \brief Per-device constants written into the image at load time.
+ *
+ * ### Overview
+ * Per-device parameters (calibration, keys, addresses) would otherwise need
+ * a build of the image per device or a file read early in the application.
+ * Instead, the image declares patchable regions in its header (imgregion_t,
+ * tools/mkimg.py -p) and each device keeps a small patch file,
+ * /sys/patch.bin, with (offset, value) records (tools/mkpatch.py).
+ *
+ * The bootloader applies the records right after the image is loaded, its
+ * digest checked and its relocations applied, and before it is started. The
+ * offsets are relative to the start of the payload, so the same file works at
+ * any load address, and every record must fall inside a declared region.
+ * The values are written as they are, they are not relocated.
+ *
+ * The whole file is checked before the first record is written: a file with
+ * a bad checksum or a record outside the regions is not applied at all, and
+ * the image boots with the values it was built with. A missing file is not
+ * an error. The outcome is left in boothandoff_t::patches.
+ *
+ * Images loaded from the SRAM (BOOTLoadMem) are not patched.
+ *
+ * Patches are only applied with BOOT_PATCH defined. Without it PATCHApply
+ * is a macro, the regions keep the values of the build and
+ * boothandoff_t::patches is 0.
+ *
+ * ### Requires
+ * - Boot.
+ * - BCache.
+ * - Cksum.
+ *
+ * ### Example
+ *
+ * \code
+ *  // Application, right after start.
+ *  if (0 > HANDOFF->patches)
+ *    report the broken patch file;
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _PATCH_H_
+#define _PATCH_H_
+
+/*!
+ *	\file patch.h
+ *
+ *	\brief Constants, types and function prototypes of the patch table.
+ *
+ *	This file contains definitions used by the patch.c.
+ */
+
+/*!
+ *	\def PATCH_MAGIC
+ *
+ * 	\brief Magic number ("PTCH") of a patch file.
+ */
+#define PATCH_MAGIC	0x48435450
+
+/*!
+ *	\def PATCH_MAX_RECORDS
+ *
+ * 	\brief Maximum number of records in a patch file.
+ */
+#define PATCH_MAX_RECORDS	128
+
+/*!
+ *	\struct patchhdr_t
+ *
+ *	\brief Header of the patch file, followed by count patchrec_t.
+ */
+typedef struct {
+  /*! Must be PATCH_MAGIC. */
+  uint32_t magic;
+  /*! Number of records. */
+  uint32_t count;
+  /*! Adler-32 of the records (see cksum.h). */
+  uint32_t check;
+} patchhdr_t;
+
+/*!
+ *	\struct patchrec_t
+ *
+ *	\brief Word written into the image.
+ */
+typedef struct {
+  /*! Offset from the start of the payload, word aligned. */
+  uint32_t offset;
+  /*! Value of the word. */
+  uint32_t value;
+} patchrec_t;
+
+#ifdef BOOT_PATCH
+
+/*!
+ *	\fn int32_t PATCHApply(int32_t hFile, imghdr_t *hdr, uint32_t addr)
+ *
+ * 	\brief Apply the patch file to an image loaded at addr.
+ *
+ * 	Sets boothandoff_t::patches to the number of records applied, or to the
+ * 	error of the patch file.
+ *
+ * 	\param[in] hFile Open image file, to read the region table.
+ * 	\param[in] hdr Header of the image.
+ * 	\param[in] addr Address where the image was loaded.
+ *
+ * 	\return 0 on success, -1 if the region table of the image is invalid.
+ */
+int32_t PATCHApply(int32_t hFile, imghdr_t *hdr, uint32_t addr);
+
+#else
+
+#define PATCHApply(hFile, hdr, addr)	0
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,231 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Scrub
+ * \{
+ */
+
+/*!
+ * 	\file scrub.c
+ *
+ * 	\brief Implementation of the image scrubber.
+ *
+ * 	This file implements the resumable check of the idle image.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "simplelink.h"
+#include "boot.h"
+#include "blake2s.h"
+#include "digest.h"
+#include "scrub.h"
+#include "cfg.h"
+#include "fs.h"
+
+/*!
+ * 	\struct scrubstate_t
+ *
+ * 	\brief Progress of the check, kept between calls.
+ */
+typedef struct {
+  /*! Set while an image is being checked. */
+  uint32_t running;
+  /*! Image being checked. */
+  imgtype_t img;
+  /*! Header of the image. */
+  imghdr_t hdr;
+  /*! Payload bytes already checked. */
+  uint32_t offset;
+  /*! Payload bytes in the file. */
+  uint32_t len;
+  /*! Running digest. */
+  digestctx_t ctx;
+  /*! Result not recorded yet, SCRUB_RUNNING if none. */
+  int32_t result;
+} scrubstate_t;
+
+/*! State of the scrubber. */
+static scrubstate_t state;
+
+/*
+ * Set the bits of the image to the result, CFG_UNCHANGED if they already are.
+ */
+static int32_t SCRUBEdit(bootinfo_t *bootinfo, void *arg) {
+  scrubstate_t *scrub = arg;
+  uint32_t ok, bad;
+
+  ok = bootinfo->scrubok & ~SCRUB_BIT(scrub->img);
+  bad = bootinfo->scrubbad & ~SCRUB_BIT(scrub->img);
+
+  if (SCRUB_OK == scrub->result)
+    ok |= SCRUB_BIT(scrub->img);
+  else if (SCRUB_BAD == scrub->result)
+    bad |= SCRUB_BIT(scrub->img);
+
+  if ((ok == bootinfo->scrubok) && (bad == bootinfo->scrubbad))
+    return CFG_UNCHANGED;
+
+  bootinfo->scrubok = ok;
+  bootinfo->scrubbad = bad;
+  return 0;
+}
+
+/*
+ * Record the result in the boot configuration, on the next call if another
+ * task is writing it.
+ */
+static int32_t SCRUBRecord(int32_t result) {
+  int32_t RetVal;
+
+  state.result = result;
+
+  RetVal = CFGUpdate(SCRUBEdit, &state);
+  if (CFG_BUSY == RetVal)
+    return SCRUB_RUNNING;
+
+  state.result = SCRUB_RUNNING;
+  return (0 > RetVal) ? RetVal : result;
+}
+
+/*
+ * Read the header and start the digest of the image.
+ */
+static int32_t SCRUBBegin(int32_t hFile) {
+  int32_t RetVal;
+
+  memset(&state.hdr, 0, sizeof(imghdr_t));
+  RetVal = sl_FsRead(hFile, 0, (unsigned char*) &state.hdr, sizeof(imghdr_t));
+  if (0 > RetVal)
+    return SCRUB_BAD;
+
+  if ((IMG_MAGIC != state.hdr.magic) || (state.hdr.hdrlen < IMG_HDR_MINLEN))
+    return SCRUB_SKIPPED;
+
+  /* Fields unknown to an older header are 0. */
+  if (state.hdr.hdrlen < sizeof(imghdr_t))
+    memset((unsigned char*) &state.hdr + state.hdr.hdrlen, 0,
+        sizeof(imghdr_t) - state.hdr.hdrlen);
+
+  if ((IMG_DIGEST_NONE == state.hdr.digestalg)
+      || (0 != DIGESTInit(&state.ctx, state.hdr.digestalg)))
+    return SCRUB_SKIPPED;
+
+  state.offset = 0;
+  state.len = IMG_STORED_LEN(&state.hdr);
+  state.running = 1;
+  return SCRUB_RUNNING;
+}
+
+/*
+ * Compare the digest once the whole payload was read.
+ */
+static int32_t SCRUBEnd(void) {
+  return DIGESTCheck(&state.ctx, state.hdr.digest) ? SCRUB_BAD : SCRUB_OK;
+}
+
+/*
+ * Check up to budget bytes, recording the result at the end of the image.
+ */
+int32_t SCRUBStep(uint32_t budget, imgtype_t *img) {
+  unsigned char buf[SCRUB_CHUNK];
+  bootinfo_t bootinfo;
+  int32_t hFile;
+  int32_t RetVal;
+  int32_t result = SCRUB_RUNNING;
+  uint32_t len;
+
+  if (SCRUB_RUNNING != state.result) {
+    *img = state.img;
+    return SCRUBRecord(state.result);
+  }
+
+  if (!state.running) {
+    RetVal = CFGRead(&bootinfo);
+    if (0 != RetVal)
+      return RetVal;
+
+    state.img = (IMG_FACTORY == bootinfo.bootimg) ? IMG_CUSTOM : IMG_FACTORY;
+  }
+
+  *img = state.img;
+
+  RetVal = BOOTOpenImg(state.img, &hFile);
+  if (0 != RetVal) {
+    state.running = 0;
+    return RetVal;
+  }
+
+  if (!state.running)
+    result = SCRUBBegin(hFile);
+
+  while ((SCRUB_RUNNING == result) && budget) {
+    len = state.len - state.offset;
+    if (len > SCRUB_CHUNK)
+      len = SCRUB_CHUNK;
+    if (len > budget)
+      len = budget;
+
+    if (0 == len) {
+      result = SCRUBEnd();
+      break;
+    }
+
+    RetVal = sl_FsRead(hFile, IMG_PAYLOAD_OFF(&state.hdr) + state.offset, buf,
+        len);
+    if (RetVal != (int32_t) len) {
+      result = SCRUB_BAD;
+      break;
+    }
+
+    DIGESTUpdate(&state.ctx, buf, len);
+
+    state.offset += len;
+    budget -= len;
+
+    if (state.offset == state.len)
+      result = SCRUBEnd();
+  }
+
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  if (SCRUB_RUNNING == result)
+    return result;
+
+  state.running = 0;
+  return SCRUBRecord(result);
+}
+
+/*
+ * Forget the progress.
+ */
+void SCRUBReset() {
+  state.running = 0;
+  state.result = SCRUB_RUNNING;
+}
+
+/*!
+ * \}
+ */
@@ -0,0 +1,168 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Scrub Scrub
+ * \{
+ *
+ * \brief Background check of the images that are not running.
+ *
+ * ### Overview
+ * A damaged /sys/factory.bin is otherwise only found when a rollback needs
+ * it. The application calls SCRUBStep from its idle loop; each call reads at
+ * most a given number of bytes of the image that is not running and feeds
+ * them to the digest of its header (imghdr_t::digestalg). When the whole
+ * payload was read the result is stored in the boot configuration
+ * (bootinfo_t::scrubok and bootinfo_t::scrubbad, written only when they
+ * change) and returned, so the application can repair or download the image
+ * again long before it is needed.
+ *
+ * The configuration is read and updated through the configuration service
+ * (Cfg), so the scrubber can run in a task of its own. If another task is
+ * writing the configuration, the result is recorded and returned by the next
+ * call.
+ *
+ * The scrub is resumable: the position and the running digest are kept in
+ * SRAM between calls and the file is only open during a call. Images without
+ * a header or a digest can't be checked and are skipped.
+ *
+ * The bootloader clears the bits of the custom image when a new one is
+ * started (BOOT_CHECK). A rollback (BOOT_ERR, or a trial not confirmed) to
+ * a factory image marked as damaged is refused: the custom image, unless
+ * marked as damaged too, gets a new trial instead. Each failed trial counts
+ * for the backoff (Backoff), so after BACKOFF_MAX_TRIES of them its
+ * recovery state tries the factory image anyway. scrubok is not used to
+ * skip the digest check on load, the image may change after the scrub.
+ *
+ * ### Requires
+ * - Simplelink (Can be the TINY build).
+ * - Boot.
+ * - Cfg.
+ * - Blake2s.
+ * - Cksum.
+ *
+ * ### Example
+ *
+ * \code
+ *  imgtype_t img;
+ *
+ *  CFGInit();
+ *
+ *  // Idle loop, about 10ms of flash reads per call.
+ *  if (SCRUB_BAD == SCRUBStep(4096, &img))
+ *    RequestImage(img);
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _SCRUB_H_
+#define _SCRUB_H_
+
+/*!
+ *	\file scrub.h
+ *
+ *	\brief Constants and function prototypes of the image scrubber.
+ *
+ *	This file contains definitions used by the scrub.c.
+ */
+
+/*!
+ *	\def SCRUB_BIT
+ *
+ * 	\brief Bit of an image (imgtype_t) in bootinfo_t::scrubok and
+ * 	bootinfo_t::scrubbad.
+ */
+#define SCRUB_BIT(img)	(1u << (img))
+
+/*!
+ *	\def SCRUB_CHUNK
+ *
+ * 	\brief Size of the reads of the scrubber (buffer in the stack).
+ */
+#ifndef SCRUB_CHUNK
+#define SCRUB_CHUNK	256
+#endif
+
+/*!
+ *	\def SCRUB_RUNNING
+ *
+ * 	\brief The image is still being checked.
+ */
+#define SCRUB_RUNNING	0
+
+/*!
+ *	\def SCRUB_OK
+ *
+ * 	\brief The image was checked and is intact.
+ */
+#define SCRUB_OK	1
+
+/*!
+ *	\def SCRUB_BAD
+ *
+ * 	\brief The image is damaged or can't be read.
+ */
+#define SCRUB_BAD	2
+
+/*!
+ *	\def SCRUB_SKIPPED
+ *
+ * 	\brief The image has no digest and can't be checked.
+ */
+#define SCRUB_SKIPPED	3
+
+/*!
+ *	\fn int32_t SCRUBStep(uint32_t budget, imgtype_t *img)
+ *
+ * 	\brief Check the next slice of the image that is not running.
+ *
+ * 	\param[in] budget Maximum number of payload bytes to read.
+ * 	\param[out] img Image the result is about.
+ *
+ * 	\return SCRUB_RUNNING, SCRUB_OK, SCRUB_BAD or SCRUB_SKIPPED. A negative
+ * 	SL error code if the image doesn't exist or the boot configuration can't
+ * 	be accessed, -1 if CFGInit was not called.
+ */
+int32_t SCRUBStep(uint32_t budget, imgtype_t *img);
+
+/*!
+ *	\fn void SCRUBReset(void)
+ *
+ * 	\brief Restart the check from the beginning of the image.
+ *
+ * 	Must be called when an image file is rewritten while it is scrubbed, or
+ * 	when bootinfo_t::customslot changes (done by ImgWr). A result not
+ * 	recorded yet is dropped.
+ */
+void SCRUBReset(void);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Stage
+ * \{
+ */
+
+/*!
+ * 	\file stage.c
+ *
+ * 	\brief Implementation of the staged images.
+ *
+ * 	This file implements the retained descriptor of a staged image.
+ */
+
+#ifdef BOOT_STAGE
+
+#include <stdint.h>
+#include <string.h>
+#include "boot.h"
+#include "blake2s.h"
+#include "stage.h"
+
+/*!
+ * 	\def STAGE
+ *
+ * 	\brief Pointer to the retained descriptor.
+ */
+#define STAGE	((stagedesc_t*) STAGE_ADDR)
+
+/*
+ * Digest of the staged file.
+ */
+static void STAGEDigest(uint32_t addr, uint32_t len, uint8_t *digest) {
+  blake2sctx_t ctx;
+
+  BLAKE2SInit(&ctx, BLAKE2S_OUTLEN);
+  BLAKE2SUpdate(&ctx, (const uint8_t*) addr, len);
+  BLAKE2SFinal(&ctx, digest);
+}
+
+/*
+ * Fill the descriptor.
+ */
+int32_t STAGEImage(uint32_t addr, uint32_t len, uint32_t flags) {
+  if ((addr < STAGE_MIN_ADDR) || (addr >= RETAINED_ADDR)
+      || (len > RETAINED_ADDR - addr))
+    return -1;
+
+  STAGE->magic = 0;
+  STAGE->addr = addr;
+  STAGE->len = len;
+  STAGE->flags = flags;
+  STAGEDigest(addr, len, STAGE->digest);
+  STAGE->magic = STAGE_MAGIC;
+
+  return 0;
+}
+
+/*
+ * Check the descriptor and the staged file, then load it.
+ */
+int32_t STAGELoad() {
+  stagedesc_t desc;
+  uint8_t digest[BLAKE2S_OUTLEN];
+
+  if (STAGE_MAGIC != STAGE->magic)
+    return -1;
+
+  desc = *STAGE;
+
+  /* Cleared first, a staged image that hangs is not started again. */
+  if (desc.flags & STAGE_FLAG_ONESHOT)
+    STAGEClear();
+
+  if ((desc.addr < STAGE_MIN_ADDR) || (desc.addr >= RETAINED_ADDR)
+      || (desc.len > RETAINED_ADDR - desc.addr))
+    return -1;
+
+  STAGEDigest(desc.addr, desc.len, digest);
+  if (memcmp(digest, desc.digest, BLAKE2S_OUTLEN))
+    return -1;
+
+  return BOOTLoadMem(desc.addr, desc.len, BASE_ADDR);
+}
+
+/*
+ * Invalidate the descriptor.
+ */
+void STAGEClear() {
+  STAGE->magic = 0;
+}
+
+#endif
+
+/*!
+ * \}
+ */
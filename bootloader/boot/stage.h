@@ -0,0 +1,167 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Stage Stage
+ * \{
+ *
+ * \brief Run an image from the SRAM once, without writing the flash.
+ *
+ * ### Overview
+ * For A/B experiments and factory tests the application can boot an image
+ * without writing it to the serial flash or touching boot.cfg. It places
+ * the whole image file (as built by tools/mkimg.py, linked for BASE_ADDR)
+ * anywhere between STAGE_MIN_ADDR and RETAINED_ADDR, describes it with
+ * STAGEImage and resets the MCU.
+ *
+ * The descriptor (stagedesc_t) is kept in the retained SRAM at STAGE_ADDR
+ * and carries the BLAKE2s of the staged file. On the next boot STAGELoad
+ * checks it and moves the image to BASE_ADDR before the NWP is even
+ * started, so there is no sl_Start and no flash read. With
+ * STAGE_FLAG_ONESHOT the descriptor is cleared before the image is checked,
+ * so any later boot goes back to the normal image selection.
+ *
+ * The staged image is not on trial.
+ *
+ * Staged images are only built with BOOT_STAGE defined, in the bootloader
+ * and in the application. Without it the functions are macros: STAGEImage
+ * fails and STAGELoad finds nothing.
+ *
+ * ### Requires
+ * - Boot.
+ * - Blake2s.
+ *
+ * ### Example
+ *
+ * \code
+ *  // Application, image file received at buf.
+ *  STAGEImage((uint32_t) buf, len, STAGE_FLAG_ONESHOT);
+ *  PRCMSOCReset();
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _STAGE_H_
+#define _STAGE_H_
+
+/*!
+ *	\file stage.h
+ *
+ *	\brief Constants, types and function prototypes of the staged images.
+ *
+ *	This file contains definitions used by the stage.c.
+ */
+
+/*!
+ *	\def STAGE_MAGIC
+ *
+ * 	\brief Magic number ("STGE") of a valid descriptor.
+ */
+#define STAGE_MAGIC	0x45475453
+
+/*!
+ *	\def STAGE_MIN_ADDR
+ *
+ * 	\brief Lowest address of a staged image.
+ *
+ * 	The ROM loader copies the bootloader to BASE_ADDR on every reset, so the
+ * 	first 16KB of the application window are not kept.
+ */
+#define STAGE_MIN_ADDR	(BASE_ADDR + 0x4000)
+
+/*!
+ *	\def STAGE_FLAG_ONESHOT
+ *
+ * 	\brief Boot the staged image only once.
+ */
+#define STAGE_FLAG_ONESHOT	0x0001
+
+/*!
+ *	\struct stagedesc_t
+ *
+ *	\brief Descriptor of the staged image, at STAGE_ADDR.
+ */
+typedef struct {
+  /*! STAGE_MAGIC when the descriptor is valid. */
+  uint32_t magic;
+  /*! Address of the staged image file. */
+  uint32_t addr;
+  /*! Length of the staged image file. */
+  uint32_t len;
+  /*! STAGE_FLAG_* bits. */
+  uint32_t flags;
+  /*! BLAKE2s of the staged image file. */
+  uint8_t digest[32];
+} stagedesc_t;
+
+#ifdef BOOT_STAGE
+
+/*!
+ *	\fn int32_t STAGEImage(uint32_t addr, uint32_t len, uint32_t flags)
+ *
+ * 	\brief Describe an image file staged in the SRAM.
+ *
+ * 	The application must reset the MCU afterwards.
+ *
+ * 	\param[in] addr Address of the image file.
+ * 	\param[in] len Length of the image file.
+ * 	\param[in] flags STAGE_FLAG_* bits.
+ *
+ * 	\return 0 on success, -1 if the image is not in the staging area.
+ */
+int32_t STAGEImage(uint32_t addr, uint32_t len, uint32_t flags);
+
+/*!
+ *	\fn int32_t STAGELoad(void)
+ *
+ * 	\brief Check the staged image and move it to BASE_ADDR.
+ *
+ * 	\return 0 if there is a valid staged image ready to run, -1 otherwise.
+ */
+int32_t STAGELoad(void);
+
+/*!
+ *	\fn void STAGEClear(void)
+ *
+ * 	\brief Forget the staged image.
+ */
+void STAGEClear(void);
+
+#else
+
+#define STAGEImage(addr, len, flags)	(-1)
+#define STAGELoad()	(-1)
+#define STAGEClear()
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,149 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Unpack
+ * \{
+ */
+
+/*!
+ * 	\file unpack.c
+ *
+ * 	\brief Implementation of the chunk decoders.
+ *
+ * 	This file implements the RLE and LZ77 decoders of packed images.
+ */
+
+#ifdef BOOT_PACKED
+
+#include <stdint.h>
+#include <string.h>
+#include "boot.h"
+#include "unpack.h"
+
+/*
+ * Run-length decoder.
+ */
+static int32_t UNPACKRle(const uint8_t *in, const uint8_t *inend,
+    uint8_t *out, uint8_t *outend) {
+  uint32_t n;
+  uint8_t c;
+
+  while (in < inend) {
+    c = *in++;
+
+    if (c < 0x80) {
+      n = c + 1;
+      if ((n > (uint32_t) (inend - in)) || (n > (uint32_t) (outend - out)))
+        return -1;
+
+      memcpy(out, in, n);
+      in += n;
+    }
+    else {
+      n = c - 0x80 + 3;
+      if ((in == inend) || (n > (uint32_t) (outend - out)))
+        return -1;
+
+      memset(out, *in++, n);
+    }
+
+    out += n;
+  }
+
+  return (out == outend) ? 0 : -1;
+}
+
+/*
+ * LZ77 decoder, the output before out (down to start) is the window.
+ */
+static int32_t UNPACKLz(const uint8_t *in, const uint8_t *inend, uint8_t *out,
+    uint8_t *outend, const uint8_t *start) {
+  const uint8_t *from;
+  uint32_t dist;
+  uint32_t n;
+  uint8_t c;
+
+  while (in < inend) {
+    c = *in++;
+
+    if (c < 0x80) {
+      n = c + 1;
+      if ((n > (uint32_t) (inend - in)) || (n > (uint32_t) (outend - out)))
+        return -1;
+
+      memcpy(out, in, n);
+      in += n;
+      out += n;
+      continue;
+    }
+
+    n = (c & 0x7F) + 3;
+    if ((2 > inend - in) || (n > (uint32_t) (outend - out)))
+      return -1;
+
+    dist = in[0] | (in[1] << 8);
+    in += 2;
+
+    if ((0 == dist) || (dist > (uint32_t) (out - start)))
+      return -1;
+
+    /* The copy may overlap its own output, go byte by byte. */
+    from = out - dist;
+    while (n--)
+      *out++ = *from++;
+  }
+
+  return (out == outend) ? 0 : -1;
+}
+
+/*
+ * Dispatch to the codec of the chunk.
+ */
+int32_t UNPACKChunk(uint32_t codec, const uint8_t *in, uint32_t len,
+    uint8_t *out, uint32_t rawlen, const uint8_t *start) {
+  switch (codec) {
+  case IMG_CODEC_RAW:
+    if (len != rawlen)
+      return -1;
+
+    memcpy(out, in, len);
+    return 0;
+
+  case IMG_CODEC_RLE:
+    return UNPACKRle(in, in + len, out, out + rawlen);
+
+  case IMG_CODEC_LZ:
+    return UNPACKLz(in, in + len, out, out + rawlen, start);
+
+  default:
+    return -1;
+  }
+}
+
+#endif
+
+/*!
+ * \}
+ */
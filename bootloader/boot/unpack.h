@@ -0,0 +1,91 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Unpack Unpack
+ * \{
+ *
+ * \brief Decoders of the chunks of a packed image (IMG_FLAG_PACKED).
+ *
+ * ### Overview
+ * No single codec fits a whole image: code compresses with LZ, tables and
+ * zero filled data with run-length coding, and compressed assets are better
+ * left raw. The codec is chosen per chunk by tools/mkimg.py. Both codecs are
+ * byte oriented and decode straight into the destination, without tables or
+ * extra buffers:
+ *
+ * - IMG_CODEC_RLE: a control byte c below 0x80 is followed by c + 1 literal
+ *   bytes, otherwise the next byte is repeated c - 0x80 + 3 times.
+ * - IMG_CODEC_LZ: a control byte c below 0x80 is followed by c + 1 literal
+ *   bytes, otherwise it copies (c & 0x7F) + 3 bytes from a little endian
+ *   uint16_t distance back in the output. Matches may reach into the chunks
+ *   already unpacked.
+ *
+ * The decoders are only built with BOOT_PACKED defined, the loader refuses
+ * packed images without it.
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _UNPACK_H_
+#define _UNPACK_H_
+
+/*!
+ *	\file unpack.h
+ *
+ *	\brief Function prototypes of the chunk decoders.
+ *
+ *	This file contains definitions used by the unpack.c.
+ */
+
+#ifdef BOOT_PACKED
+
+/*!
+ *	\fn int32_t UNPACKChunk(uint32_t codec, const uint8_t *in, uint32_t len, uint8_t *out, uint32_t rawlen, const uint8_t *start)
+ *
+ * 	\brief Decode a chunk.
+ *
+ * 	\param[in] codec IMG_CODEC_* of the chunk.
+ * 	\param[in] in Chunk as stored.
+ * 	\param[in] len Length of in.
+ * 	\param[out] out Destination of the chunk.
+ * 	\param[in] rawlen Unpacked length of the chunk.
+ * 	\param[in] start Start of the payload, the limit of the LZ distances.
+ *
+ * 	\return 0 if exactly rawlen bytes were produced from len bytes, -1
+ * 	otherwise.
+ */
+int32_t UNPACKChunk(uint32_t codec, const uint8_t *in, uint32_t len,
+    uint8_t *out, uint32_t rawlen, const uint8_t *start);
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
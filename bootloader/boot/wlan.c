@@ -0,0 +1,158 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Wlan
+ * \{
+ */
+
+/*!
+ * 	\file wlan.c
+ *
+ * 	\brief Implementation of the NWP handover.
+ *
+ * 	This file keeps the NWP running for the images that take it over and
+ * 	lets their host driver skip its reset.
+ */
+
+#include <stdint.h>
+#include "hw_types.h"
+#include "hw_ints.h"
+#include "interrupt.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "simplelink.h"
+#include "source/driver.h"
+#include "boot.h"
+#include "wlan.h"
+
+#ifdef BOOT_WLAN
+/*
+ * Slow clock ticks since the start of the boot, never 0.
+ */
+static uint32_t WLANTicks(void) {
+  uint32_t ticks = (uint32_t) MAP_PRCMSlowClkCtrGet() - WLAN->start;
+
+  return ticks ? ticks : 1;
+}
+
+/*
+ * Forget the previous boot.
+ */
+void WLANStart(void) {
+  WLAN->magic = 0;
+  WLAN->start = (uint32_t) MAP_PRCMSlowClkCtrGet();
+  WLAN->connticks = 0;
+  WLAN->ipticks = 0;
+  WLAN->ip = 0;
+}
+
+/*
+ * Connection events.
+ */
+void WLANWlanEvent(SlWlanEvent_t *event) {
+  if (NULL == event)
+    return;
+
+  if (SL_WLAN_CONNECT_EVENT == event->Event) {
+    WLAN->connticks = WLANTicks();
+  }
+  else if (SL_WLAN_DISCONNECT_EVENT == event->Event) {
+    WLAN->connticks = 0;
+    WLAN->ipticks = 0;
+  }
+}
+
+/*
+ * IP address events.
+ */
+void WLANNetAppEvent(SlNetAppEvent_t *event) {
+  if ((NULL == event) || (SL_NETAPP_IPV4_IPACQUIRED_EVENT != event->Event))
+    return;
+
+  WLAN->ip = event->EventData.ipAcquiredV4.ip;
+  WLAN->ipticks = WLANTicks();
+}
+
+/*
+ * Leave the NWP running for the images that ask for it.
+ */
+int32_t WLANHandover(void) {
+  if ((HANDOFF_MAGIC != HANDOFF->magic) || !(HANDOFF->flags & IMG_FLAG_WLAN))
+    return 0;
+
+  /* The NWP keeps raising its interrupt, the image has no handler for it
+   * until its sl_Start registers one. */
+  MAP_IntDisable(INT_NWPIC);
+  MAP_IntPendClear(INT_NWPIC);
+
+  WLAN->magic = WLAN_MAGIC;
+  return 1;
+}
+#endif
+
+/*
+ * The reset of sl_Start is a disable followed by an enable, the enable
+ * adopts the NWP.
+ */
+void WLANDeviceEnable(void) {
+  if (WLAN_MAGIC == WLAN->magic) {
+    WLAN->magic = WLAN_ADOPTED;
+    return;
+  }
+
+  NwpPowerOn();
+}
+
+/*
+ * Power the NWP off, unless it is being adopted.
+ */
+void WLANDeviceDisable(void) {
+  if (WLAN_MAGIC == WLAN->magic)
+    return;
+
+  WLAN->magic = 0;
+  NwpPowerOff();
+}
+
+/*
+ * Check the adoption.
+ */
+int32_t WLANAdopted(void) {
+  return WLAN_ADOPTED == WLAN->magic;
+}
+
+/*
+ * Release the object sl_Start keeps for the init event, a running NWP doesn't
+ * send it.
+ */
+void WLANStartDone(void) {
+  if (WLANAdopted())
+    _SlDrvReleasePoolObj(g_pCB->FunctionParams.AsyncExt.ActionIndex);
+}
+
+/*!
+ * \}
+ */
@@ -0,0 +1,235 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Wlan Wlan
+ * \{
+ *
+ * \brief Handover of a running, connecting NWP to the application.
+ *
+ * ### Overview
+ * With an auto connect policy (set once by the application with
+ * sl_WlanPolicySet), the NWP starts to connect to its stored profiles as
+ * soon as the bootloader calls sl_Start, before the image is loaded. The
+ * bootloader used to throw that away with sl_Stop, and the application
+ * connected again from its own sl_Start, seconds later.
+ *
+ * An image built with IMG_FLAG_WLAN (mkimg.py -w) gets the NWP still
+ * running. The connection events seen by the bootloader are kept in the
+ * wlanhandoff_t record at WLAN_ADDR, since the application will not get
+ * them again.
+ *
+ * The host driver of the application resets the NWP in sl_Start, through
+ * the sl_DeviceDisable and sl_DeviceEnable macros of its user.h. They must
+ * be mapped to WLANDeviceDisable and WLANDeviceEnable, which leave a handed
+ * over NWP alone once. A running NWP doesn't send its init event again, so
+ * sl_Start must be given an init callback (without one it waits for the
+ * event forever) and the callback is not called. WLANAdopted tells which case
+ * it was.
+ *
+ * sl_Start also keeps a driver object for the init event, released by the
+ * event. An adopted NWP never sends it, so WLANStartDone must be called right
+ * after sl_Start, before any other SimpleLink call; otherwise the object leaks
+ * and a later sl_Stop can't get its own. WLANStartDone uses the internals of
+ * the host driver of the SDK (source/driver.h).
+ *
+ * The bootloader disables and clears the NWP interrupt (INT_NWPIC) before it
+ * starts the image, the sl_Start of the application enables it again.
+ *
+ * The bootloader only hands the NWP over with BOOT_WLAN defined. Without it
+ * the NWP is always stopped and nothing is adopted; the functions of the
+ * application are built either way.
+ *
+ * ### Requires
+ * - Driverlib;
+ * - Simplelink (Can be the TINY build).
+ * - Boot.
+ *
+ * ### Example
+ *
+ * \code
+ *  // user.h of the application:
+ *  #define sl_DeviceEnable()   WLANDeviceEnable()
+ *  #define sl_DeviceDisable()  WLANDeviceDisable()
+ *
+ *  sl_Start(NULL, NULL, InitDone);
+ *
+ *  if (WLANAdopted()) {
+ *    // The init event will not come.
+ *    WLANStartDone();
+ *
+ *    if (WLAN->ipticks)
+ *      UseAddress(WLAN->ip);
+ *  }
+ *  else {
+ *    WaitForInitDone();
+ *  }
+ * \endcode
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _WLAN_H_
+#define _WLAN_H_
+
+/*!
+ *	\file wlan.h
+ *
+ *	\brief Constants, types and function prototypes of the NWP handover.
+ *
+ *	This file contains definitions used by the wlan.c.
+ */
+
+/*!
+ *	\def WLAN_MAGIC
+ *
+ * 	\brief The NWP was left running by the bootloader ("WLAN").
+ */
+#define WLAN_MAGIC	0x4E414C57
+
+/*!
+ *	\def WLAN_ADOPTED
+ *
+ * 	\brief The NWP was taken over by the application's sl_Start ("WADO").
+ */
+#define WLAN_ADOPTED	0x4F444157
+
+/*!
+ *	\struct wlanhandoff_t
+ *
+ *	\brief NWP handover record, at WLAN_ADDR.
+ */
+typedef struct {
+  /*! WLAN_MAGIC, WLAN_ADOPTED or 0 when the NWP was stopped. */
+  uint32_t magic;
+  /*! Slow clock (32768Hz) when the boot started. */
+  uint32_t start;
+  /*! Slow clock ticks from start to the connection, 0 if not yet. */
+  uint32_t connticks;
+  /*! Slow clock ticks from start to the IP address, 0 if not yet. */
+  uint32_t ipticks;
+  /*! IPv4 address, valid with ipticks. */
+  uint32_t ip;
+} wlanhandoff_t;
+
+/*!
+ *	\def WLAN
+ *
+ * 	\brief Pointer to the retained handover record.
+ */
+#define WLAN	((volatile wlanhandoff_t*) WLAN_ADDR)
+
+#ifdef BOOT_WLAN
+/*!
+ *	\fn void WLANStart(void)
+ *
+ * 	\brief Clear the record at the start of the boot.
+ */
+void WLANStart(void);
+
+/*!
+ *	\fn void WLANWlanEvent(SlWlanEvent_t *event)
+ *
+ * 	\brief Record the WLAN events received by the bootloader.
+ *
+ * 	\param[in] event Event from SimpleLinkWlanEventHandler.
+ */
+void WLANWlanEvent(SlWlanEvent_t *event);
+
+/*!
+ *	\fn void WLANNetAppEvent(SlNetAppEvent_t *event)
+ *
+ * 	\brief Record the NetApp events received by the bootloader.
+ *
+ * 	\param[in] event Event from SimpleLinkNetAppEventHandler.
+ */
+void WLANNetAppEvent(SlNetAppEvent_t *event);
+
+/*!
+ *	\fn int32_t WLANHandover(void)
+ *
+ * 	\brief Check whether the loaded image takes over the NWP.
+ *
+ * 	The NWP interrupt is disabled and cleared for an image that takes it
+ * 	over.
+ *
+ * 	\return 1 if the NWP must be left running, 0 if it must be stopped.
+ */
+int32_t WLANHandover(void);
+
+#else
+
+#define WLANStart()	(WLAN->magic = 0)
+#define WLANWlanEvent(event)	((void) (event))
+#define WLANNetAppEvent(event)	((void) (event))
+#define WLANHandover()	0
+
+#endif
+
+/*!
+ *	\fn void WLANDeviceEnable(void)
+ *
+ * 	\brief sl_DeviceEnable of the application.
+ *
+ * 	Powers the NWP on, unless it was handed over and not adopted yet.
+ */
+void WLANDeviceEnable(void);
+
+/*!
+ *	\fn void WLANDeviceDisable(void)
+ *
+ * 	\brief sl_DeviceDisable of the application.
+ *
+ * 	Powers the NWP off, unless it was handed over and not adopted yet.
+ */
+void WLANDeviceDisable(void);
+
+/*!
+ *	\fn int32_t WLANAdopted(void)
+ *
+ * 	\brief Check whether sl_Start took over a running NWP.
+ *
+ * 	\return 1 if it did, 0 if the NWP was started again.
+ */
+int32_t WLANAdopted(void);
+
+/*!
+ *	\fn void WLANStartDone(void)
+ *
+ * 	\brief Finish the sl_Start of an adopted NWP.
+ *
+ * 	Releases the driver object sl_Start keeps for the init event. Must be
+ * 	called once, right after sl_Start and before any other SimpleLink call.
+ * 	Does nothing if the NWP was not adopted.
+ */
+void WLANStartDone(void);
+
+#endif
+
+/*!
+ * \}
+ */
@@ -47,14 +47,36 @@
 #include "simplelink.h"
 
 #include "boot.h"
+#include "backoff.h"
+#include "ckpt.h"
+#include "confirm.h"
+#include "deadline.h"
+#include "hibstate.h"
+#include "scrub.h"
+#include "stage.h"
+#include "wlan.h"
+#ifdef BOOT_NETBOOT
+#include "netboot.h"
+#endif
 
 #include "rom.h"
 #include "rom_map.h"
 #include "print.h"
+#include "prof.h"
 
 // Interrupt Vector from startup.asm.
 extern void* intVector;
 
+/*
+ * A boot stage failed after sl_Start: close boot.cfg and stop the NWP before
+ * the backoff hibernate.
+ */
+static void BOOTFail(void) {
+  BOOTClose();
+  sl_Stop(0);
+  BACKOFFFail();
+}
+
 /*!
  *  \fn int main (void)
  *
@@ -66,11 +88,19 @@ extern void* intVector;
 int main() {
   int32_t RetVal; // Used to check return values.
   bootinfo_t bootinfo; // Bootinfo structure.
+  int32_t trial = 0; // New image on trial.
+  uint32_t overrun; // Stage cut by its deadline in the last boot.
 
   // Initializes the board.
   MAP_IntVTableBaseSet((int32_t) &intVector);
   PRCMCC3200MCUInit();
 
+  // Start sampling the boot path (only with BOOT_PROFILE).
+  PROFStart();
+
+  // Time the connection from here, for the images that take over the NWP.
+  WLANStart();
+
   // Initializes the PRINT with a baud rate of 115200.
   PRINTInit(115200);
 
@@ -79,43 +109,100 @@ int main() {
   PRINT("------------------ Akenge  Bootloader ------------------\r\n");
   PRINT("--------------------------------------------------------\r\n");
   PRINT("\r\n");
+
+  // Count this attempt, it is cleared once the image is started, or once it
+  // confirms itself for a trial.
+  if (0 != BACKOFFBegin())
+    PRINT("- Last boot failed\r\n");
+
+  // Check whether the last boot was reset by a stage deadline. The stages
+  // that are just retried wait for their turn like any other failure.
+  overrun = DEADLINEOverrun();
+  if ((DEADLINE_NONE != overrun) && (DEADLINE_LOAD(IMG_CUSTOM) != overrun)
+      && (DEADLINE_NETBOOT != overrun)) {
+    PRINT("- Last boot overran a deadline\r\n");
+    BACKOFFFail();
+  }
+
+  // A staged image runs straight from the SRAM, without the NWP.
+  if (0 == STAGELoad()) {
+    PRINT("Running Staged Image\r\n");
+    PRINTClose();
+    PROFStop();
+    BACKOFFDone();
+    BOOTRun((void*) HANDOFF->base);
+  }
+
   PRINT("- Initializing Simplelink ...");
 
-  // Start NWP to get access to flash.
+  // Start NWP to get access to flash. From here on every stage runs under
+  // the watchdog.
+  DEADLINEStart(DEADLINE_SL_START);
   if (0 > sl_Start(NULL, NULL, NULL)) {
     PRINT("FAIL\r\n");
-    PRCMSOCReset();
+    BOOTFail();
   }
 
   PRINT("OK\r\n");
 
-  // Check if boot configuration exists.
-  if (!BOOTExistCfg()) {
-
-    PRINT("- boot.cfg not found, creating new ...");
+  DEADLINEStart(DEADLINE_CFG);
 
-    // If it doesn't exist, create the file to boot from factory.bin.
+  // Too many failed boots in a row, leave boot.cfg alone and only try the
+  // factory image.
+  if (BACKOFFRecovery()) {
+    PRINT("- Recovery state, factory image only\r\n");
     bootinfo.bootimg = IMG_FACTORY;
     bootinfo.status = BOOT_OK;
-    RetVal = BOOTWriteCfg(&bootinfo);
+    bootinfo.trialid = 0;
+    bootinfo.scrubok = 0;
+    bootinfo.scrubbad = 0;
+    bootinfo.netaddr = 0;
+    bootinfo.netport = 0;
+    bootinfo.customslot = 0;
+  }
+  // After a hibernate a BOOT_OK state is still in the OCR register, boot.cfg
+  // doesn't need to be opened.
+  else if (0 == HIBSTATEReadCfg(&bootinfo)) {
+    PRINT("- Boot config kept in hibernate\r\n");
+  }
+  else {
+    // Check if boot configuration exists.
+    if (!BOOTExistCfg()) {
+
+      PRINT("- boot.cfg not found, creating new ...");
+
+      // If it doesn't exist, create the file to boot from factory.bin.
+      bootinfo.bootimg = IMG_FACTORY;
+      bootinfo.status = BOOT_OK;
+      bootinfo.trialid = 0;
+      bootinfo.scrubok = 0;
+      bootinfo.scrubbad = 0;
+      bootinfo.netaddr = 0;
+      bootinfo.netport = 0;
+      bootinfo.customslot = 0;
+      RetVal = BOOTWriteCfg(&bootinfo);
+
+      // Failed to create file, try again later.
+      if (0 != RetVal) {
+        PRINT("FAIL\r\n");
+        BOOTFail();
+      }
+      PRINT("OK\r\n");
+    }
+
+    PRINT("- Loading boot config ...");
 
-    // Failed to create file, Reset SOC.
+    // Read configuration.
+    RetVal = BOOTReadCfg(&bootinfo);
     if (0 != RetVal) {
       PRINT("FAIL\r\n");
-      PRCMSOCReset();
+      BOOTFail();
     }
     PRINT("OK\r\n");
-  }
-
-  PRINT("- Loading boot config ...");
 
-  // Read configuration.
-  RetVal = BOOTReadCfg(&bootinfo);
-  if (0 != RetVal) {
-    PRINT("FAIL\r\n");
-    PRCMSOCReset();
+    // Keep it in the OCR register for the next wake.
+    HIBSTATESave(&bootinfo);
   }
-  PRINT("OK\r\n");
 
   PRINT("- Boot status: ");
 
@@ -125,7 +212,31 @@ int main() {
   // Last Boot OK.
   case BOOT_OK:
     PRINT("BOOT_OK\r\n");
-    BOOTLoadImg(bootinfo.bootimg);
+
+#ifdef BOOT_NETBOOT
+    // Lab boards get the image from a server, falling back to the flash, or
+    // straight from the flash if the netboot overran last time.
+    if ((0 != bootinfo.netaddr) && (DEADLINE_NETBOOT != overrun)) {
+      DEADLINEStart(DEADLINE_NETBOOT);
+
+      if (0 == NETBOOTLoad(bootinfo.netaddr, (uint16_t) bootinfo.netport)) {
+        PRINT("- Netboot OK\r\n");
+        break;
+      }
+    }
+#endif
+
+    // The custom image didn't load in time last boot, use the factory image
+    // for this one.
+    if ((DEADLINE_LOAD(IMG_CUSTOM) == overrun)
+        && (IMG_CUSTOM == bootinfo.bootimg)) {
+      PRINT("- Custom image load overran, booting the factory image\r\n");
+      bootinfo.bootimg = IMG_FACTORY;
+    }
+
+    DEADLINEStart(DEADLINE_LOAD(bootinfo.bootimg));
+    if (0 != BOOTLoadImg(bootinfo.bootimg))
+      BOOTFail();
     break;
 
     // New Firmware Available.
@@ -133,25 +244,104 @@ int main() {
     PRINT("BOOT_CHECK\r\n");
     bootinfo.status = BOOT_CHECKING;
 
+    // New id for this trial, the slow clock counter is never reset.
+    bootinfo.trialid = (uint32_t) MAP_PRCMSlowClkCtrGet() | 1;
+    CONFIRMClear();
+
+    // The scrub results were about the previous custom image.
+    bootinfo.scrubok &= ~SCRUB_BIT(IMG_CUSTOM);
+    bootinfo.scrubbad &= ~SCRUB_BIT(IMG_CUSTOM);
+
+    DEADLINEStart(DEADLINE_CFG);
     if (0 != BOOTWriteCfg(&bootinfo))
-      PRCMSOCReset();
+      BOOTFail();
 
+    DEADLINEStart(DEADLINE_LOAD(IMG_CUSTOM));
     if (0 != BOOTLoadImg(IMG_CUSTOM))
-      PRCMSOCReset();
+      BOOTFail();
+
+    HANDOFF->trialid = bootinfo.trialid;
+    trial = 1;
     break;
 
-    // Something wrong during last boot, go back to factory image.
+    // Image on trial, check if it was confirmed before the reset.
   case BOOT_CHECKING:
+    if (CONFIRMCheck(bootinfo.trialid)) {
+      PRINT("BOOT_CONFIRMED\r\n");
+      bootinfo.status = BOOT_OK;
+      bootinfo.trialid = 0;
+
+      DEADLINEStart(DEADLINE_CFG);
+      if (0 != BOOTWriteCfg(&bootinfo))
+        BOOTFail();
+
+      CONFIRMClear();
+
+      DEADLINEStart(DEADLINE_LOAD(bootinfo.bootimg));
+      if (0 != BOOTLoadImg(bootinfo.bootimg))
+        BOOTFail();
+      break;
+    }
+
+    // Confirmed before a hibernate, keep running it without writing the
+    // flash. It stays on trial until the application calls CONFIRMSync.
+    if (HIBSTATEConfirmed(bootinfo.trialid)) {
+      PRINT("BOOT_CONFIRMED (hibernate)\r\n");
+
+      DEADLINEStart(DEADLINE_LOAD(bootinfo.bootimg));
+      if (0 != BOOTLoadImg(bootinfo.bootimg))
+        BOOTFail();
+
+      HANDOFF->trialid = bootinfo.trialid;
+      break;
+    }
+
+    // Not confirmed: something wrong during last boot, go back to factory
+    // image.
+    // Fall through.
   case BOOT_ERR:
+    if ((PRCM_WDT_RESET == MAP_PRCMSysResetCauseGet())
+        && (DEADLINE_NONE == overrun))
+      PRINT("TRIAL TIMEOUT, ");
+
     PRINT("BOOT_ERR\r\n");
+
+    // The scrubber found the factory image damaged, a rollback would not
+    // start. Give the custom image a new trial instead: each failed trial
+    // counts for the backoff, whose recovery state still tries the factory
+    // image.
+    if ((bootinfo.scrubbad & SCRUB_BIT(IMG_FACTORY))
+        && !(bootinfo.scrubbad & SCRUB_BIT(IMG_CUSTOM))
+        && (IMG_CUSTOM == bootinfo.bootimg)) {
+      PRINT("- Factory image damaged, retrying the custom image\r\n");
+      bootinfo.status = BOOT_CHECKING;
+      bootinfo.trialid = (uint32_t) MAP_PRCMSlowClkCtrGet() | 1;
+      CONFIRMClear();
+
+      DEADLINEStart(DEADLINE_CFG);
+      if (0 != BOOTWriteCfg(&bootinfo))
+        BOOTFail();
+
+      DEADLINEStart(DEADLINE_LOAD(IMG_CUSTOM));
+      if (0 != BOOTLoadImg(IMG_CUSTOM))
+        BOOTFail();
+
+      HANDOFF->trialid = bootinfo.trialid;
+      trial = 1;
+      break;
+    }
+
     bootinfo.bootimg = IMG_FACTORY;
     bootinfo.status = BOOT_OK;
+    bootinfo.trialid = 0;
 
+    DEADLINEStart(DEADLINE_CFG);
     if (0 != BOOTWriteCfg(&bootinfo))
-      PRCMSOCReset();
+      BOOTFail();
 
+    DEADLINEStart(DEADLINE_LOAD(IMG_FACTORY));
     if (0 != BOOTLoadImg(IMG_FACTORY))
-      PRCMSOCReset();
+      BOOTFail();
     break;
 
     // Unknow status (corrupted file maybe?).
@@ -164,8 +354,17 @@ int main() {
 
   PRINT("- Stop NWP...");
 
-  // Stop NWP.
-  sl_Stop(0);
+  DEADLINEStart(DEADLINE_SL_STOP);
+
+  // Close the files kept open by the boot functions.
+  BOOTClose();
+
+  // Stop NWP, unless the image takes it over still connecting.
+  if (!WLANHandover())
+    sl_Stop(0);
+
+  // The boot is over, the watchdog goes off (or to the trial below).
+  DEADLINEStop();
 
   PRINT("OK\r\n");
 
@@ -177,11 +376,29 @@ int main() {
   else
     PRINT("Custom Image\r\n");
 
+#ifdef BOOT_CKPT
+  if (CKPT_ADDR == CKPTEntry())
+    PRINT("- Resuming checkpoint\r\n");
+#endif
+
   // Turn-off the UART module.
   PRINTClose();
 
-  // Run loaded image.
-  BOOTRun((void*) BASE_ADDR);
+  // Stop the profiler before the application owns the SysTick.
+  PROFStop();
+
+  // The new image must confirm itself before the watchdog expires.
+  if (trial)
+    BOOTArmTrial(HANDOFF->trialms);
+
+  // The boot made it, the next failure starts a new backoff. An image on
+  // trial clears the count with CONFIRMImage, one that faults at once must
+  // not look like a good boot.
+  if (!trial)
+    BACKOFFDone();
+
+  // Run loaded image, from its checkpoint if one was restored.
+  BOOTRun((void*) CKPTEntry());
 
   // Should never reach here. If so, reset soc
   PRCMSOCReset();
@@ -189,10 +406,11 @@ int main() {
   return -1;
 }
 
-// Simplelink Hooks, not used by the bootloader but required by the simplelink.
+// Simplelink Hooks, required by the simplelink. The WLAN and NetApp events
+// are kept for the images that take over the NWP, and used by the netboot.
 void SimpleLinkWlanEventHandler(SlWlanEvent_t *pWlanEvent) {
 
-  UNUSED(pWlanEvent);
+  WLANWlanEvent(pWlanEvent);
 }
 
 void SimpleLinkHttpServerCallback(SlHttpServerEvent_t *pHttpEvent,
@@ -203,7 +421,11 @@ void SimpleLinkHttpServerCallback(SlHttpServerEvent_t *pHttpEvent,
 }
 void SimpleLinkNetAppEventHandler(SlNetAppEvent_t *pNetAppEvent) {
 
-  UNUSED(pNetAppEvent);
+  WLANNetAppEvent(pNetAppEvent);
+
+#ifdef BOOT_NETBOOT
+  NETBOOTNetAppEvent(pNetAppEvent);
+#endif
 }
 void SimpleLinkSockEventHandler(SlSockEvent_t *pSock) {
 
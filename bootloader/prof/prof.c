@@ -0,0 +1,141 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \addtogroup Prof
+ * \{
+ */
+
+/*!
+ * 	\file prof.c
+ *
+ * 	\brief Implementation of the profiler.
+ *
+ * 	This file implements the SysTick handler that stores the samples.
+ */
+
+#ifdef BOOT_PROFILE
+
+#include <stdint.h>
+
+#include "hw_types.h"
+#include "hw_nvic.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "systick.h"
+
+#include "boot.h"
+#include "prof.h"
+
+/*!
+ * 	\def PROF
+ *
+ * 	\brief Pointer to the sample buffer.
+ */
+#define PROF	((volatile profbuf_t*) PROF_ADDR)
+
+/*!
+ * 	\def SYSTICK_TICKS_PER_US
+ *
+ * 	\brief SysTick (core clock, 80MHz) ticks per microsecond.
+ */
+#define SYSTICK_TICKS_PER_US	80
+
+/*! SysTick interrupts per sample, doubled each time the buffer fills up. */
+static uint32_t skip;
+
+/*! SysTick interrupts since the last sample. */
+static uint32_t ticks;
+
+/*
+ * Store a sample, frame is the exception stack frame (r0-r3, r12, lr, pc,
+ * xpsr).
+ */
+void PROFSample(uint32_t *frame) __attribute__((used));
+void PROFSample(uint32_t *frame) {
+  uint32_t count = PROF->count;
+  uint32_t i;
+
+  if (++ticks < skip)
+    return;
+
+  ticks = 0;
+
+  /* Full, keep every other sample and halve the sampling rate. */
+  if (PROF_MAX_SAMPLES == count) {
+    for (i = 0; i < PROF_MAX_SAMPLES / 2; i++)
+      PROF->samples[i] = PROF->samples[2 * i];
+
+    count = PROF_MAX_SAMPLES / 2;
+    skip *= 2;
+    PROF->period *= 2;
+  }
+
+  PROF->samples[count].pc = frame[6];
+  PROF->samples[count].lr = frame[5];
+  PROF->count = count + 1;
+}
+
+/*
+ * The bootloader only uses the MSP, pass the stacked frame to PROFSample.
+ */
+__attribute__((naked)) void PROFSysTickHandler(void) {
+  __asm(
+      "	mrs        r0, msp\n\r"
+      "	b          PROFSample\n\r"
+  );
+}
+
+/*
+ * Clear the buffer and start the SysTick.
+ */
+void PROFStart() {
+  PROF->magic = 0;
+  PROF->count = 0;
+  PROF->period = PROF_PERIOD_US;
+  PROF->reserved = 0;
+  skip = 1;
+  ticks = 0;
+
+  MAP_SysTickPeriodSet(PROF_PERIOD_US * SYSTICK_TICKS_PER_US);
+  MAP_SysTickIntEnable();
+  MAP_SysTickEnable();
+}
+
+/*
+ * Stop the SysTick and drop a pending interrupt.
+ */
+void PROFStop() {
+  MAP_SysTickIntDisable();
+  MAP_SysTickDisable();
+  HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PENDSTCLR;
+
+  PROF->magic = PROF_MAGIC;
+}
+
+#endif
+
+/*!
+ * \}
+ */
@@ -0,0 +1,164 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \defgroup Prof Prof
+ * \{
+ *
+ * \brief SysTick PC sampler for the boot path.
+ *
+ * ### Overview
+ * When the bootloader is built with BOOT_PROFILE defined, the SysTick
+ * interrupt samples the interrupted PC and LR from PROFStart (start of main)
+ * to PROFStop (right before BOOTRun). The samples are kept in the retained
+ * SRAM at PROF_ADDR, so they can be dumped by the application or a debugger
+ * after the boot, for example:
+ *
+ * \code
+ *  (gdb) dump binary memory prof.bin 0x2003FC00 0x20040000
+ *  $ tools/profold.py Bootloader.elf prof.bin > boot.folded
+ *  $ flamegraph.pl boot.folded > boot.svg
+ * \endcode
+ *
+ * When the buffer is full, every other sample is dropped and the sampling
+ * period is doubled, so the whole boot is always covered.
+ *
+ * Without BOOT_PROFILE the functions are empty macros, this file compiles to
+ * nothing and the vector table keeps its two entries.
+ *
+ * \copyright Akenge Engenharia
+ *
+ * \bug None known.
+ * \}
+ */
+
+#ifndef _PROF_H_
+#define _PROF_H_
+
+/*!
+ *	\file prof.h
+ *
+ *	\brief Constants, types and function prototypes of the profiler.
+ *
+ *	This file contains definitions used by the prof.c.
+ */
+
+/*!
+ *	\def PROF_ADDR
+ *
+ * 	\brief Address of the profbuf_t buffer (last 1KB of the retained SRAM).
+ */
+#define PROF_ADDR	(RETAINED_ADDR + 0x400)
+
+/*!
+ *	\def PROF_MAGIC
+ *
+ * 	\brief Magic number ("PROF") of a valid sample buffer.
+ */
+#define PROF_MAGIC	0x464F5250
+
+/*!
+ *	\def PROF_MAX_SAMPLES
+ *
+ * 	\brief Number of samples that fit in the 1KB buffer.
+ */
+#define PROF_MAX_SAMPLES	126
+
+#ifndef PROF_PERIOD_US
+/*!
+ *	\def PROF_PERIOD_US
+ *
+ * 	\brief Initial sampling period in microseconds.
+ */
+#define PROF_PERIOD_US	1000
+#endif
+
+/*!
+ *	\struct profsample_t
+ *
+ *	\brief One sample, taken from the exception stack frame.
+ */
+typedef struct {
+  /*! Interrupted PC. */
+  uint32_t pc;
+  /*! LR at the interrupt, the caller for leaf functions. */
+  uint32_t lr;
+} profsample_t;
+
+/*!
+ *	\struct profbuf_t
+ *
+ *	\brief Sample buffer at PROF_ADDR.
+ */
+typedef struct {
+  /*! PROF_MAGIC once the profiler was stopped. */
+  uint32_t magic;
+  /*! Number of valid samples. */
+  uint32_t count;
+  /*! Current sampling period in microseconds. */
+  uint32_t period;
+  /*! Reserved, 0. */
+  uint32_t reserved;
+  /*! Samples in time order. */
+  profsample_t samples[PROF_MAX_SAMPLES];
+} profbuf_t;
+
+#ifdef BOOT_PROFILE
+
+/*!
+ *	\fn void PROFStart(void)
+ *
+ * 	\brief Clear the buffer and start sampling.
+ */
+void PROFStart(void);
+
+/*!
+ *	\fn void PROFStop(void)
+ *
+ * 	\brief Stop sampling and mark the buffer valid.
+ *
+ * 	Must be called before running the application, so it never gets a
+ * 	SysTick interrupt meant for the bootloader.
+ */
+void PROFStop(void);
+
+/*!
+ *	\fn void PROFSysTickHandler(void)
+ *
+ * 	\brief SysTick handler, referenced by the vector table in startup.asm.
+ */
+void PROFSysTickHandler(void);
+
+#else
+
+#define PROFStart()
+#define PROFStop()
+
+#endif
+
+#endif
+
+/*!
+ * \}
+ */
@@ -31,7 +31,7 @@
  *  bootloader in the SRAM and the function to run and image from another
  *  position in memory.
  *
- *  Version: 1.0.2
+ *  Version: 1.0.3
  *
  *  Author: David Krepsky
  */
@@ -65,6 +65,13 @@
  */
 .extern  BOOTRun
 
+#ifdef BOOT_PROFILE
+/*
+ * External SysTick handler of the profiler.
+ */
+.extern  PROFSysTickHandler
+#endif
+
 /*!
  *  \brief Interrupt vector
  *
@@ -83,6 +90,27 @@ intVector: .global intVector
      */
     .word   Relocator+0x4001
 
+#ifdef BOOT_PROFILE
+    /*
+     *  System exceptions up to the SysTick, used by the profiler (prof.h).
+     *  Only reached after main has set the VTOR to the relocated table.
+     */
+    .word   0                   // NMI
+    .word   0                   // Hard fault
+    .word   0                   // MPU fault
+    .word   0                   // Bus fault
+    .word   0                   // Usage fault
+    .word   0
+    .word   0
+    .word   0
+    .word   0
+    .word   0                   // SVCall
+    .word   0                   // Debug monitor
+    .word   0
+    .word   0                   // PendSV
+    .word   PROFSysTickHandler  // SysTick
+#endif
+
 
 .text
 
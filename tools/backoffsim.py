@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""Estimate the battery life of a node under boot faults (see backoff.h).
+
+Each boot attempt fails with the given probability. Without the backoff a
+failure resets the SOC at once; with it the node hibernates BACKOFF_BASE_MS,
+doubled for each failure in a row up to BACKOFF_MAX_MS, and after
+BACKOFF_MAX_TRIES failures only the factory image is tried (with the same
+fault rate in this model). A good boot runs
+the application for its duty cycle and hibernates until the next wake.
+
+The default currents are typical CC3200 figures, measure the real board.
+
+Usage: backoffsim.py [-p RATE]... [--mah MAH] [--days DAYS]
+"""
+
+import argparse
+import random
+import sys
+
+BACKOFF_BASE_MS = 1000
+BACKOFF_MAX_MS = 3600000
+BACKOFF_MAX_TRIES = 8
+
+
+def backoff_delay(failures):
+    """Hibernate time in ms, same as BACKOFFDelay."""
+    ms = BACKOFF_BASE_MS
+    while failures > 1 and ms < BACKOFF_MAX_MS:
+        ms *= 2
+        failures -= 1
+    return min(ms, BACKOFF_MAX_MS)
+
+
+def simulate(args, rate, backoff, rng):
+    """Return (hours until the battery is empty, boot attempts)."""
+    charge = args.mah * 3600.0  # mA s
+    horizon = args.days * 86400.0
+    t = 0.0
+    attempts = 0
+    failures = 0
+
+    while charge > 0 and t < horizon:
+        attempts += 1
+        charge -= args.boot_ma * args.boot_s
+        t += args.boot_s
+
+        if rng.random() >= rate:
+            failures = 0
+            charge -= args.app_ma * args.app_s + args.hib_ua / 1000.0 * args.sleep_s
+            t += args.app_s + args.sleep_s
+            continue
+
+        failures += 1
+        if backoff:
+            wait = backoff_delay(failures) / 1000.0
+            charge -= args.hib_ua / 1000.0 * wait
+            t += wait
+
+    return t / 3600.0, attempts
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-p', '--rate', type=float, action='append',
+                        help='fault rate per boot (default: 0 0.1 0.5 0.9 1)')
+    parser.add_argument('--mah', type=float, default=1000,
+                        help='battery capacity (default: 1000)')
+    parser.add_argument('--days', type=float, default=3650,
+                        help='longest time simulated (default: 3650)')
+    parser.add_argument('--boot-ma', type=float, default=30,
+                        help='current while booting (default: 30)')
+    parser.add_argument('--boot-s', type=float, default=1.5,
+                        help='length of a boot attempt (default: 1.5)')
+    parser.add_argument('--app-ma', type=float, default=40,
+                        help='current of the application (default: 40)')
+    parser.add_argument('--app-s', type=float, default=2,
+                        help='run time per wake (default: 2)')
+    parser.add_argument('--sleep-s', type=float, default=600,
+                        help='hibernate time between wakes (default: 600)')
+    parser.add_argument('--hib-ua', type=float, default=4,
+                        help='current in hibernate (default: 4)')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    print('%-6s %14s %14s %12s' % ('rate', 'no backoff (h)', 'backoff (h)',
+                                    'boots/day'))
+    for rate in args.rate or [0, 0.1, 0.5, 0.9, 1]:
+        plain = simulate(args, rate, False, random.Random(args.seed))
+        slow = simulate(args, rate, True, random.Random(args.seed))
+        print('%-6g %14.1f %14.1f %12.1f' %
+              (rate, plain[0], slow[0], slow[1] / (slow[0] / 24)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
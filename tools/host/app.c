@@ -0,0 +1,65 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file app.c
+ *
+ * 	\brief Stand-in application for the host benchmarks.
+ *
+ * 	Linked at BASE_ADDR for the host CPU, only to give mkimg.py an ELF with
+ * 	code, a compressible table and a .bss when no application ELF is given
+ * 	(make bench APP=...). It is never run. Its own code is small, so the
+ * 	Cortex-M4 code of the bootloader (APP_CODE) is included as data to give
+ * 	the codecs of mkimg.py -z real code to pack.
+ */
+
+#include <stdint.h>
+
+/*! Cortex-M4 code. */
+__asm(".section .rodata\n"
+    ".balign 4\n"
+    ".incbin \"" APP_CODE "\"\n"
+    ".previous");
+
+/*! Text, as in the messages of an application. */
+const char text[8192] = "Akenge bootloader host benchmark application";
+
+/*! Mostly empty table, as in the calibration data of an application. */
+uint32_t table[4096] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+/*! Buffers. */
+uint8_t buffer[16384];
+
+int _start(void) {
+  uint32_t sum = 0;
+  uint32_t i;
+
+  for (i = 0; i < sizeof(buffer); i++)
+    buffer[i] = text[i % sizeof(text)] ^ table[i % 4096];
+
+  for (i = 0; i < sizeof(buffer); i++)
+    sum += buffer[i];
+
+  return sum;
+}
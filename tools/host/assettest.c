@@ -0,0 +1,302 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file assettest.c
+ *
+ * 	\brief Asset store (asset.h): lookups, and SRAM saved against latency.
+ *
+ * 	An asset file laid out as tools/mkassets.py does holds a set of
+ * 	certificates, web pages and tables. Every asset must be found and read
+ * 	back, while a name not in the file must not be found, even when its
+ * 	FNV-1a id is the one of a packed asset: the colliding pair is searched
+ * 	among generated names.
+ *
+ * 	Then the SRAM the assets would take linked into the image is set
+ * 	against the SRAM of the store (the block cache) and the time of an
+ * 	access under the NWP cost model: ASSETFind and the whole asset read in
+ * 	ASSET_PIECE pieces, with the cache cold (right after ASSETOpen) and
+ * 	warm. make assetbench runs it with the default cache, without
+ * 	BOOT_BCACHE and with 8 blocks of 256 bytes.
+ *
+ * 	Usage: assettest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simplelink.h"
+#include "bcache.h"
+#include "asset.h"
+#include "host.h"
+
+/*! Bytes read at once, as a web server sending a page would. */
+#define ASSET_PIECE	256
+
+/*! Names tried for an id collision, and the slots of their table. */
+#define ASSET_TRIES	(1 << 20)
+#define ASSET_SLOTS	(1 << 22)
+
+/*! Largest asset file. */
+#define ASSET_FILE_MAX	65536
+
+static int32_t failures;
+
+/*! Assets of the file, the contents are generated. */
+static struct {
+  const char *name;
+  uint32_t length;
+} assets[] = { { "ca.der", 1219 }, { "client.der", 947 }, { "client.key",
+    1192 }, { "index.html", 4310 }, { "style.css", 2250 }, { "app.js", 6021 },
+    { "logo.png", 3187 }, { "favicon.ico", 1150 }, { "setup.html", 2761 }, {
+        "status.json", 388 }, { "sine.tbl", 1024 }, { "crc.tbl", 1024 }, {
+        "cal.bin", 512 }, { "strings.en", 1630 }, { "strings.pt", 1702 }, {
+        "license.txt", 1079 } };
+
+#define ASSET_COUNT	(sizeof(assets) / sizeof(assets[0]))
+
+/*! The two names of the collision found, the first one is packed. */
+static char packed[16];
+static char other[16];
+
+static void TestExpect(const char *what, int32_t ok) {
+  printf("%-56s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+/*
+ * Byte of an asset.
+ */
+static uint8_t TestByte(uint32_t asset, uint32_t i) {
+  return (uint8_t) (i * 31 + asset * 7 + (i >> 8));
+}
+
+/*
+ * Find two generated names with the same id.
+ */
+static int32_t TestCollision(void) {
+  uint32_t *slots = calloc(ASSET_SLOTS, sizeof(uint32_t));
+  char name[16];
+  uint32_t id;
+  uint32_t slot;
+  uint32_t i;
+
+  for (i = 1; slots && (i < ASSET_TRIES); i++) {
+    snprintf(name, sizeof(name), "n%u", i);
+    id = ASSETId(name);
+
+    for (slot = id % ASSET_SLOTS; slots[slot]; slot = (slot + 1) % ASSET_SLOTS) {
+      snprintf(packed, sizeof(packed), "n%u", slots[slot]);
+      if (ASSETId(packed) == id) {
+        strcpy(other, name);
+        free(slots);
+        return 0;
+      }
+    }
+
+    slots[slot] = i;
+  }
+
+  free(slots);
+  return -1;
+}
+
+/*
+ * Lay out the asset file as mkassets.py: the header, the index sorted by
+ * id, the names and the data, word aligned. The name of the collision is
+ * packed too, as an empty asset.
+ */
+static void TestPack(void) {
+  static uint8_t file[ASSET_FILE_MAX];
+  assethdr_t *hdr = (assethdr_t*) file;
+  assetentry_t *index = (assetentry_t*) (file + sizeof(assethdr_t));
+  const char *name[ASSET_COUNT + 1];
+  uint32_t length[ASSET_COUNT + 1];
+  uint32_t order[ASSET_COUNT + 1];
+  uint32_t count = ASSET_COUNT + 1;
+  uint32_t nameoff;
+  uint32_t offset;
+  uint32_t tmp;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < ASSET_COUNT; i++) {
+    name[i] = assets[i].name;
+    length[i] = assets[i].length;
+  }
+
+  name[ASSET_COUNT] = packed;
+  length[ASSET_COUNT] = 0;
+
+  for (i = 0; i < count; i++)
+    order[i] = i;
+
+  for (i = 0; i < count; i++) {
+    for (j = i + 1; j < count; j++) {
+      if (ASSETId(name[order[j]]) < ASSETId(name[order[i]])) {
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+      }
+    }
+  }
+
+  hdr->magic = ASSET_MAGIC;
+  hdr->count = count;
+
+  nameoff = sizeof(assethdr_t) + count * sizeof(assetentry_t);
+  offset = nameoff;
+  for (i = 0; i < count; i++)
+    offset += strlen(name[i]);
+
+  offset = (offset + 3) & ~3u;
+
+  for (i = 0; i < count; i++) {
+    index[i].id = ASSETId(name[order[i]]);
+    index[i].offset = offset;
+    index[i].length = length[order[i]];
+    index[i].nameoff = nameoff;
+    index[i].namelen = strlen(name[order[i]]);
+
+    memcpy(file + nameoff, name[order[i]], index[i].namelen);
+    nameoff += index[i].namelen;
+
+    for (j = 0; j < index[i].length; j++)
+      file[offset + j] = TestByte(order[i], j);
+
+    offset += (index[i].length + 3) & ~3u;
+  }
+
+  NWPPut("/sys/assets.bin", file, offset);
+}
+
+/*
+ * Find and read an asset whole. Returns 0 if it is the one packed.
+ */
+static int32_t TestAccess(uint32_t i) {
+  uint8_t buf[ASSET_PIECE];
+  asset_t asset;
+  uint32_t done;
+  int32_t n;
+  int32_t j;
+
+  if ((0 != ASSETFind(assets[i].name, &asset))
+      || (assets[i].length != asset.length))
+    return -1;
+
+  for (done = 0; done < asset.length; done += n) {
+    n = ASSETRead(&asset, done, buf, sizeof(buf));
+    if (0 >= n)
+      return -1;
+
+    for (j = 0; j < n; j++) {
+      if (TestByte(i, done + j) != buf[j])
+        return -1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Simulated time of an access to every asset, and NWP reads.
+ */
+static double TestPass(uint32_t *reads) {
+  nwpstats_t nwp;
+  uint64_t start;
+  uint32_t i;
+
+  NWPClear();
+  start = HOSTUs;
+
+  for (i = 0; i < ASSET_COUNT; i++)
+    TestAccess(i);
+
+  NWPStats(&nwp);
+  *reads = nwp.reads;
+
+  return (double) (HOSTUs - start) / ASSET_COUNT;
+}
+
+int main() {
+  asset_t asset;
+  uint32_t total = 0;
+  uint32_t reads;
+  uint32_t cache = 0;
+  uint32_t ok = 0;
+  double cold;
+  double warm;
+  uint32_t i;
+
+  HOSTInit();
+
+  if (0 != TestCollision()) {
+    printf("no id collision among %u names\n", ASSET_TRIES);
+    return 2;
+  }
+
+  TestPack();
+
+  TestExpect("asset file opened", 0 == ASSETOpen());
+
+  for (i = 0; i < ASSET_COUNT; i++) {
+    total += assets[i].length;
+    ok += (0 == TestAccess(i));
+  }
+
+  TestExpect("every asset found and read back", ASSET_COUNT == ok);
+  TestExpect("packed name of the collision found",
+      0 == ASSETFind(packed, &asset));
+
+  printf("%s and %s: id 0x%08x\n", packed, other, ASSETId(packed));
+  TestExpect("unpacked name with a packed id not found",
+      0 != ASSETFind(other, &asset));
+  TestExpect("unpacked name not found", 0 != ASSETFind("missing", &asset));
+  TestExpect("prefix of a packed name not found",
+      0 != ASSETFind("index.htm", &asset));
+
+#ifdef BOOT_BCACHE
+  cache = BCACHE_BLOCKS * BCACHE_BLOCK_SIZE;
+  printf("cache %u blocks of %u bytes\n", BCACHE_BLOCKS, BCACHE_BLOCK_SIZE);
+#else
+  printf("no cache (BOOT_BCACHE not set)\n");
+#endif
+
+  ASSETOpen();
+  cold = TestPass(&reads);
+  printf("%u assets, %u bytes: %u bytes of SRAM linked in, %u with the"
+      " store\n", (uint32_t) ASSET_COUNT, total, total, cache);
+  printf("access: %.0f us, %.1f NWP reads cold", cold,
+      (double) reads / ASSET_COUNT);
+
+  warm = TestPass(&reads);
+  printf(", %.0f us, %.1f NWP reads warm\n", warm,
+      (double) reads / ASSET_COUNT);
+  ASSETClose();
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
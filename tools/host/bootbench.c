@@ -0,0 +1,499 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file bootbench.c
+ *
+ * 	\brief Boot time and NWP calls per boot state.
+ *
+ * 	Each boot (bootflow.c) runs after a reset from the given state, with a
+ * 	factory and a custom image of BENCH_IMG_LEN, under the NWP cost model
+ * 	(nwp.c): the first boot, which creates boot.cfg, the factory and custom
+ * 	images, a trial and the boot after its confirmation. Every state is
+ * 	booted with the boot.cfg handle kept open from BOOTExistCfg to
+ * 	BOOTReadCfg and with it reopened (HOSTReopenCfg), and, in a BOOT_SECURE
+ * 	build, with plain and secure images.
+ *
+ * 	Then the NWP transactions of each boot are counted with images that
+ * 	use the tables read through the block cache (bcache.h): a header, a
+ * 	relocation entry every BENCH_RELOC_STEP words and BENCH_FILES extra
+ * 	files. The boot loads them at their link address, so the relocations
+ * 	are only read by an application loading the image at BENCH_RELOC_ADDR
+ * 	(BOOTLoadImgAt). The image files given (mkimg.py) are booted as the
+ * 	factory image too. The model has no CPU time, so the decoding of packed
+ * 	chunks and the digest are added from Cortex-M4 estimates (BENCH_*_NS),
+ * 	to compare packed images with raw and single codec ones.
+ *
+ * 	Last, the relocation throughput: the load at BENCH_RELOC_ADDR against
+ * 	the same load at the link address, with a relocation every 1, 8 and 64
+ * 	words.
+ *
+ * 	The build options come from the Makefile (FEATURES), make bootbench
+ * 	runs the default build, a BOOT_SECURE one and one without
+ * 	BOOT_BCACHE.
+ *
+ * 	Usage: bootbench [image.bin...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "cksum.h"
+#include "confirm.h"
+#include "host.h"
+
+/*! Length of the images. */
+#define BENCH_IMG_LEN	32768
+
+/*! Words between relocations of the headered image. */
+#define BENCH_RELOC_STEP	8
+
+/*! Words between relocations of the images built, see BenchReloc. */
+static uint32_t relocstep = BENCH_RELOC_STEP;
+
+/*! Extra files of the headered image, and their length. */
+#define BENCH_FILES	2
+#define BENCH_FILE_LEN	256
+
+/*! Decoding time per byte produced, the CODEC_NS of mkimg.py. */
+#define BENCH_RLE_NS	40
+#define BENCH_LZ_NS	80
+
+/*! Digest time per byte stored, at 80MHz (see cksumbench.c). */
+#define BENCH_BLAKE2S_NS	424
+#define BENCH_ADLER32_NS	38
+
+/*! Where an application loads the headered image, away from BASE_ADDR. */
+#define BENCH_RELOC_ADDR	(BASE_ADDR + 0x10000)
+
+/*! Largest headered image file. */
+#define BENCH_FILE_MAX	(sizeof(imghdr_t) + BENCH_FILES * sizeof(imgfile_t) \
+    + BENCH_IMG_LEN + BENCH_IMG_LEN / 4 * sizeof(uint16_t))
+
+/*! Boot states measured. */
+typedef enum {
+  BENCH_FIRST = 0,
+  BENCH_FACTORY,
+  BENCH_CUSTOM,
+  BENCH_TRIAL,
+  BENCH_CONFIRMED,
+  BENCH_STATES
+} benchstate_t;
+
+static const char *statename[BENCH_STATES] = { "first boot", "factory",
+    "custom", "trial", "confirmed" };
+
+/*! State set up by AppSetup. */
+static bootinfo_t state;
+
+/*
+ * The application sets the boot state and resets.
+ */
+static int32_t AppSetup(void) {
+  bootinfo_t bootinfo;
+
+  if (0 != BOOTReadCfg(&bootinfo))
+    return -1;
+
+  bootinfo.status = state.status;
+  bootinfo.bootimg = state.bootimg;
+  if (0 != BOOTWriteCfg(&bootinfo))
+    return -1;
+
+  BOOTClose();
+  PRCMSOCReset();
+  return -1;
+}
+
+/*
+ * The image on trial confirms itself and resets.
+ */
+static int32_t AppConfirm(void) {
+  CONFIRMImage();
+  CONFIRMSync();
+  PRCMSOCReset();
+  return -1;
+}
+
+/*
+ * Relocatable image with extra files, linked at BASE_ADDR. Returns the
+ * length of the file.
+ */
+static uint32_t BenchHdrImage(uint8_t *file) {
+  imghdr_t *hdr = (imghdr_t*) file;
+  imgfile_t *files = (imgfile_t*) (file + sizeof(imghdr_t));
+  uint8_t *payload = (uint8_t*) &files[BENCH_FILES];
+  uint16_t *relocs = (uint16_t*) (payload + BENCH_IMG_LEN);
+  uint32_t adler;
+  uint32_t i;
+
+  memset(file, 0, BENCH_FILE_MAX);
+  hdr->magic = IMG_MAGIC;
+  hdr->hdrlen = sizeof(imghdr_t);
+  hdr->flags = IMG_FLAG_RELOC;
+  hdr->linkaddr = BASE_ADDR;
+  hdr->imglen = BENCH_IMG_LEN;
+  hdr->memlen = BENCH_IMG_LEN + 4096;
+  hdr->reloclen = BENCH_IMG_LEN / 4 / relocstep;
+  hdr->fileoff = sizeof(imghdr_t);
+  hdr->filecount = BENCH_FILES;
+  hdr->payloadoff = payload - file;
+  hdr->digestalg = IMG_DIGEST_ADLER32;
+
+  for (i = 0; i < BENCH_FILES; i++) {
+    snprintf(files[i].name, IMG_FILE_NAME_LEN, "/sys/bench%u.dat", i);
+    files[i].addr = BASE_ADDR + hdr->memlen + i * BENCH_FILE_LEN;
+    files[i].maxlen = BENCH_FILE_LEN;
+  }
+
+  for (i = 0; i < hdr->reloclen; i++)
+    relocs[i] = i ? relocstep : 0;
+
+  adler = CKSUMAdler32(CKSUM_ADLER_INIT, payload, BENCH_IMG_LEN);
+  memcpy(hdr->digest, &adler, sizeof(uint32_t));
+
+  return hdr->payloadoff + BENCH_IMG_LEN + hdr->reloclen * sizeof(uint16_t);
+}
+
+static int32_t AppReset(void) {
+  PRCMSOCReset();
+  return -1;
+}
+
+/*
+ * The application loads the factory image away from its link address.
+ */
+static int32_t AppLoadAt(void) {
+  return BOOTLoadImgAt(IMG_FACTORY, BENCH_RELOC_ADDR);
+}
+
+/*
+ * The same load at the link address, nothing to relocate.
+ */
+static int32_t AppLoadLink(void) {
+  return BOOTLoadImgAt(IMG_FACTORY, BASE_ADDR);
+}
+
+/*
+ * Read a whole file.
+ */
+static uint8_t *BenchLoad(const char *name, uint32_t *len) {
+  FILE *file = fopen(name, "rb");
+  uint8_t *data;
+  long size;
+
+  if (NULL == file)
+    return NULL;
+
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  data = malloc(size ? size : 1);
+  if (data && (1 != fread(data, size, 1, file)) && size) {
+    free(data);
+    data = NULL;
+  }
+
+  fclose(file);
+  *len = size;
+
+  return data;
+}
+
+/*
+ * Power on with both images, boot.cfg not created yet. Raw images, or
+ * headered ones with their extra files.
+ */
+static void BenchSetup(int32_t secureimg, int32_t hdrimg) {
+  static uint8_t image[BENCH_FILE_MAX];
+  static uint8_t data[BENCH_FILE_LEN];
+  uint32_t len = BENCH_IMG_LEN;
+  char name[IMG_FILE_NAME_LEN];
+  uint32_t i;
+
+  HOSTPowerOn();
+  BOOTClose();
+  NWPFormat();
+
+  if (hdrimg) {
+    len = BenchHdrImage(image);
+
+    for (i = 0; i < BENCH_FILES; i++) {
+      snprintf(name, sizeof(name), "/sys/bench%u.dat", i);
+      NWPPut(name, data, sizeof(data));
+    }
+  }
+  else {
+    memset(image, 0, BENCH_IMG_LEN);
+  }
+
+  NWPPut("/sys/factory.bin", image, len);
+  NWPPut((const char*) BOOTSlotName(0), image, len);
+
+  if (secureimg) {
+    NWPSecure("/sys/factory.bin");
+    NWPSecure((const char*) BOOTSlotName(0));
+  }
+}
+
+/*
+ * Time of a boot, with its NWP calls.
+ */
+static uint64_t BenchTime(nwpstats_t *nwp) {
+  uint64_t start;
+  int32_t ret;
+
+  NWPClear();
+  start = HOSTUs;
+  HOSTRun(HOSTBoot, &ret);
+  NWPStats(nwp);
+
+  return HOSTUs - start;
+}
+
+/*
+ * Time and NWP calls of a boot from the state.
+ */
+static uint64_t BenchBoot(benchstate_t which, int32_t secureimg,
+    int32_t hdrimg, nwpstats_t *nwp) {
+  uint64_t first;
+  int32_t ret;
+
+  BenchSetup(secureimg, hdrimg);
+  first = BenchTime(nwp);
+  if (BENCH_FIRST == which)
+    return first;
+
+  state.status = (BENCH_TRIAL <= which) ? BOOT_CHECK : BOOT_OK;
+  state.bootimg = (BENCH_FACTORY == which) ? IMG_FACTORY : IMG_CUSTOM;
+  HOSTRun(AppSetup, &ret);
+
+  if (BENCH_CONFIRMED == which) {
+    HOSTRun(HOSTBoot, &ret);
+    HOSTRun(AppConfirm, &ret);
+  }
+
+  return BenchTime(nwp);
+}
+
+static void BenchRun(int32_t secureimg) {
+  nwpstats_t kept;
+  nwpstats_t reopened;
+  uint64_t tkept;
+  uint64_t treopened;
+  uint32_t i;
+
+  printf("boot.cfg %s, images %s\n",
+#ifdef BOOT_SECURE
+      "secure",
+#else
+      "plain",
+#endif
+      secureimg ? "secure" : "plain");
+
+  printf("  %-11s %26s %26s\n", "", "handle kept open", "reopened");
+
+  for (i = 0; i < BENCH_STATES; i++) {
+    HOSTReopenCfg = 0;
+    tkept = BenchBoot(i, secureimg, 0, &kept);
+    HOSTReopenCfg = 1;
+    treopened = BenchBoot(i, secureimg, 0, &reopened);
+    HOSTReopenCfg = 0;
+
+    printf("  %-11s %8.1f ms %2u opens %2u sec %8.1f ms %2u opens %2u sec\n",
+        statename[i], tkept / 1e3, kept.opens, kept.secureopens,
+        treopened / 1e3, reopened.opens, reopened.secureopens);
+  }
+}
+
+static void BenchPrint(const char *name, uint64_t t, const nwpstats_t *nwp) {
+  printf("  %-11s %8.1f ms %3u NWP calls %3u reads %6u bytes read\n", name,
+      t / 1e3, nwp->calls, nwp->reads, nwp->readbytes);
+}
+
+/*
+ * Estimated CPU time of an image file on the target: the digest of the
+ * payload as stored and the decoding of the packed chunks.
+ */
+static uint64_t BenchCpuUs(const uint8_t *image, uint32_t len) {
+  const imghdr_t *hdr = (const imghdr_t*) image;
+  const imgchunk_t *chunks;
+  uint64_t ns = 0;
+  uint32_t nchunks;
+  uint32_t rawlen;
+  uint32_t i;
+
+  if ((len < sizeof(imghdr_t)) || (IMG_MAGIC != hdr->magic))
+    return 0;
+
+  if (IMG_DIGEST_BLAKE2S == hdr->digestalg)
+    ns += (uint64_t) IMG_STORED_LEN(hdr) * BENCH_BLAKE2S_NS;
+  else if (IMG_DIGEST_ADLER32 == hdr->digestalg)
+    ns += (uint64_t) IMG_STORED_LEN(hdr) * BENCH_ADLER32_NS;
+
+  if (!(hdr->flags & IMG_FLAG_PACKED))
+    return ns / 1000;
+
+  nchunks = (hdr->imglen + IMG_CHUNK_SIZE - 1) / IMG_CHUNK_SIZE;
+  chunks = (const imgchunk_t*) (image + IMG_PAYLOAD_OFF(hdr));
+  if (IMG_PAYLOAD_OFF(hdr) + nchunks * sizeof(imgchunk_t) > len)
+    return ns / 1000;
+
+  for (i = 0; i < nchunks; i++) {
+    rawlen = hdr->imglen - i * IMG_CHUNK_SIZE;
+    if (rawlen > IMG_CHUNK_SIZE)
+      rawlen = IMG_CHUNK_SIZE;
+
+    if (IMG_CODEC_RLE == chunks[i].codec)
+      ns += (uint64_t) rawlen * BENCH_RLE_NS;
+    else if (IMG_CODEC_LZ == chunks[i].codec)
+      ns += (uint64_t) rawlen * BENCH_LZ_NS;
+  }
+
+  return ns / 1000;
+}
+
+/*
+ * NWP transactions per boot with headered images, and with the image files
+ * given.
+ */
+static void BenchCalls(int argc, char **argv) {
+  nwpstats_t nwp;
+  uint8_t *image;
+  uint32_t len;
+  uint64_t cpu;
+  uint64_t t;
+  int32_t ret;
+  int i;
+
+  printf("relocatable images with %u files, block cache %s\n", BENCH_FILES,
+#ifdef BOOT_BCACHE
+      "on");
+#else
+      "off");
+#endif
+
+  for (i = 0; i < BENCH_STATES; i++) {
+    t = BenchBoot(i, 0, 1, &nwp);
+    BenchPrint(statename[i], t, &nwp);
+  }
+
+  BenchSetup(0, 1);
+  NWPClear();
+  t = HOSTUs;
+  if ((0 != HOSTRun(AppLoadAt, &ret)) || (0 != ret))
+    printf("  relocated load failed\n");
+
+  NWPStats(&nwp);
+  BenchPrint("relocated", HOSTUs - t, &nwp);
+
+  for (i = 1; i < argc; i++) {
+    image = BenchLoad(argv[i], &len);
+    if (NULL == image) {
+      printf("  %s: can't read\n", argv[i]);
+      continue;
+    }
+
+    BenchSetup(0, 0);
+    NWPPut("/sys/factory.bin", image, len);
+    cpu = BenchCpuUs(image, len);
+    free(image);
+
+    /* The first boot creates boot.cfg, the second one is timed. */
+    HOSTRun(HOSTBoot, &ret);
+    HOSTRun(AppReset, &ret);
+    t = BenchTime(&nwp);
+
+    BenchPrint(strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i],
+        t, &nwp);
+    printf("  %-11s %8.1f ms to check and decode, %8.1f ms in all\n", "",
+        cpu / 1e3, (t + cpu) / 1e3);
+  }
+}
+
+/*
+ * Time of a load by the application, 0 if it failed.
+ */
+static uint64_t BenchLoadTime(int32_t (*app)(void)) {
+  uint64_t t;
+  int32_t ret;
+
+  BenchSetup(0, 1);
+  t = HOSTUs;
+  if ((0 != HOSTRun(app, &ret)) || (0 != ret))
+    return 0;
+
+  return HOSTUs - t;
+}
+
+/*
+ * Relocated words per second, from the time a relocated load takes over
+ * the same load at the link address.
+ */
+static void BenchReloc(void) {
+  static const uint32_t steps[] = { 1, BENCH_RELOC_STEP, 64 };
+  uint64_t tlink;
+  uint64_t treloc;
+  uint32_t relocs;
+  uint32_t i;
+
+  printf("relocation of %u words\n", BENCH_IMG_LEN / 4);
+
+  for (i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+    relocstep = steps[i];
+    relocs = BENCH_IMG_LEN / 4 / relocstep;
+    tlink = BenchLoadTime(AppLoadLink);
+    treloc = BenchLoadTime(AppLoadAt);
+
+    if (!tlink || (treloc <= tlink)) {
+      printf("  every %2u words: load failed\n", relocstep);
+      continue;
+    }
+
+    printf("  every %2u words %5u relocs: %6.1f ms at the link address,"
+        " %6.1f ms moved, %7.0f words/s\n",
+        relocstep, relocs, tlink / 1e3, treloc / 1e3,
+        relocs * 1e6 / (treloc - tlink));
+  }
+
+  relocstep = BENCH_RELOC_STEP;
+}
+
+int main(int argc, char **argv) {
+  HOSTInit();
+
+  BenchRun(0);
+#ifdef BOOT_SECURE
+  BenchRun(1);
+#endif
+
+  BenchCalls(argc, argv);
+  BenchReloc();
+
+  return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file bootflow.c
+ *
+ * 	\brief Boot of main.c on the host.
+ *
+ * 	This file follows the stages of bootloader/main.c, keep them in step.
+ * 	The UART, profiler, staged images, netboot and NWP handover are left out,
+ * 	and the image is not started: HOSTBoot returns it instead.
+ */
+
+#include <stdint.h>
+#include "hw_types.h"
+#include "prcm.h"
+#include "rom_map.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "backoff.h"
+#include "confirm.h"
+#include "deadline.h"
+#include "hibstate.h"
+#include "scrub.h"
+#include "host.h"
+
+int32_t HOSTReopenCfg;
+
+/*
+ * Same as in main.c.
+ */
+static void BOOTFail(void) {
+  BOOTClose();
+  sl_Stop(0);
+  BACKOFFFail();
+}
+
+/*
+ * Boot configuration of a fresh or recovering device.
+ */
+static void BOOTFactoryCfg(bootinfo_t *bootinfo) {
+  bootinfo->bootimg = IMG_FACTORY;
+  bootinfo->status = BOOT_OK;
+  bootinfo->trialid = 0;
+  bootinfo->scrubok = 0;
+  bootinfo->scrubbad = 0;
+  bootinfo->netaddr = 0;
+  bootinfo->netport = 0;
+  bootinfo->customslot = 0;
+}
+
+/*
+ * From BACKOFFBegin to the image start.
+ */
+int32_t HOSTBoot() {
+  bootinfo_t bootinfo;
+  int32_t trial = 0;
+  uint32_t overrun;
+
+  BACKOFFBegin();
+
+  overrun = DEADLINEOverrun();
+  if ((DEADLINE_NONE != overrun) && (DEADLINE_LOAD(IMG_CUSTOM) != overrun)
+      && (DEADLINE_NETBOOT != overrun))
+    BACKOFFFail();
+
+  DEADLINEStart(DEADLINE_SL_START);
+  if (0 > sl_Start(NULL, NULL, NULL))
+    BOOTFail();
+
+  DEADLINEStart(DEADLINE_CFG);
+
+  if (BACKOFFRecovery()) {
+    BOOTFactoryCfg(&bootinfo);
+  }
+  else if (0 != HIBSTATEReadCfg(&bootinfo)) {
+    if (!BOOTExistCfg()) {
+      BOOTFactoryCfg(&bootinfo);
+      if (0 != BOOTWriteCfg(&bootinfo))
+        BOOTFail();
+    }
+
+    if (HOSTReopenCfg)
+      BOOTClose();
+
+    if (0 != BOOTReadCfg(&bootinfo))
+      BOOTFail();
+
+    HIBSTATESave(&bootinfo);
+  }
+
+  switch (bootinfo.status) {
+  case BOOT_OK:
+    if ((DEADLINE_LOAD(IMG_CUSTOM) == overrun)
+        && (IMG_CUSTOM == bootinfo.bootimg))
+      bootinfo.bootimg = IMG_FACTORY;
+
+    DEADLINEStart(DEADLINE_LOAD(bootinfo.bootimg));
+    if (0 != BOOTLoadImg(bootinfo.bootimg))
+      BOOTFail();
+    break;
+
+  case BOOT_CHECK:
+    bootinfo.status = BOOT_CHECKING;
+    bootinfo.trialid = (uint32_t) MAP_PRCMSlowClkCtrGet() | 1;
+    CONFIRMClear();
+
+    bootinfo.scrubok &= ~SCRUB_BIT(IMG_CUSTOM);
+    bootinfo.scrubbad &= ~SCRUB_BIT(IMG_CUSTOM);
+
+    DEADLINEStart(DEADLINE_CFG);
+    if (0 != BOOTWriteCfg(&bootinfo))
+      BOOTFail();
+
+    DEADLINEStart(DEADLINE_LOAD(IMG_CUSTOM));
+    if (0 != BOOTLoadImg(IMG_CUSTOM))
+      BOOTFail();
+
+    HANDOFF->trialid = bootinfo.trialid;
+    trial = 1;
+    break;
+
+  case BOOT_CHECKING:
+    if (CONFIRMCheck(bootinfo.trialid)) {
+      bootinfo.status = BOOT_OK;
+      bootinfo.trialid = 0;
+
+      DEADLINEStart(DEADLINE_CFG);
+      if (0 != BOOTWriteCfg(&bootinfo))
+        BOOTFail();
+
+      CONFIRMClear();
+
+      DEADLINEStart(DEADLINE_LOAD(bootinfo.bootimg));
+      if (0 != BOOTLoadImg(bootinfo.bootimg))
+        BOOTFail();
+      break;
+    }
+
+    if (HIBSTATEConfirmed(bootinfo.trialid)) {
+      DEADLINEStart(DEADLINE_LOAD(bootinfo.bootimg));
+      if (0 != BOOTLoadImg(bootinfo.bootimg))
+        BOOTFail();
+
+      HANDOFF->trialid = bootinfo.trialid;
+      break;
+    }
+
+    // Fall through.
+  case BOOT_ERR:
+    if ((bootinfo.scrubbad & SCRUB_BIT(IMG_FACTORY))
+        && !(bootinfo.scrubbad & SCRUB_BIT(IMG_CUSTOM))
+        && (IMG_CUSTOM == bootinfo.bootimg)) {
+      bootinfo.status = BOOT_CHECKING;
+      bootinfo.trialid = (uint32_t) MAP_PRCMSlowClkCtrGet() | 1;
+      CONFIRMClear();
+
+      DEADLINEStart(DEADLINE_CFG);
+      if (0 != BOOTWriteCfg(&bootinfo))
+        BOOTFail();
+
+      DEADLINEStart(DEADLINE_LOAD(IMG_CUSTOM));
+      if (0 != BOOTLoadImg(IMG_CUSTOM))
+        BOOTFail();
+
+      HANDOFF->trialid = bootinfo.trialid;
+      trial = 1;
+      break;
+    }
+
+    bootinfo.bootimg = IMG_FACTORY;
+    bootinfo.status = BOOT_OK;
+    bootinfo.trialid = 0;
+
+    DEADLINEStart(DEADLINE_CFG);
+    if (0 != BOOTWriteCfg(&bootinfo))
+      BOOTFail();
+
+    DEADLINEStart(DEADLINE_LOAD(IMG_FACTORY));
+    if (0 != BOOTLoadImg(IMG_FACTORY))
+      BOOTFail();
+    break;
+
+  default:
+    BOOTDeleteCfg();
+    PRCMSOCReset();
+    break;
+  }
+
+  DEADLINEStart(DEADLINE_SL_STOP);
+  BOOTClose();
+  sl_Stop(0);
+  DEADLINEStop();
+
+  if (trial)
+    BOOTArmTrial(HANDOFF->trialms);
+
+  if (!trial)
+    BACKOFFDone();
+
+  return bootinfo.bootimg;
+}
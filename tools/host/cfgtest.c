@@ -0,0 +1,312 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file cfgtest.c
+ *
+ * 	\brief Configuration service (cfg.h) under concurrent tasks.
+ *
+ * 	Host threads stand in for the tasks of an RTOS application: CFG_READERS
+ * 	readers copy the snapshot with CFGRead in a loop while one writer uses
+ * 	CFGWrite and another CFGUpdate, retrying on CFG_BUSY. Every field of a
+ * 	configuration written is derived from its trialid, so a torn snapshot
+ * 	is seen as a mismatch. The stand-in NWP (nwp.c) is only called by the
+ * 	writer holding the lock. A timer signal makes the running thread yield
+ * 	every CFG_PREEMPT_US, so the threads are switched in the middle of
+ * 	CFGRead and of the publish even on a single CPU.
+ *
+ * 	Then the read latency is measured on the host CPU, idle and with both
+ * 	writers running, against BOOTReadCfg under the NWP cost model.
+ *
+ * 	Usage: cfgtest
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "simplelink.h"
+#include "boot.h"
+#include "cfg.h"
+#include "host.h"
+
+/*! Reader threads. */
+#define CFG_READERS	4
+
+/*! Configurations written by each writer. */
+#define CFG_WRITES	20000
+
+/*! Reads timed for the latency. */
+#define CFG_BENCH_READS	2000000
+
+/*! Period of the forced thread switches. */
+#define CFG_PREEMPT_US	20
+
+static int32_t failures;
+
+/*! Set to stop the readers and the writers. */
+static volatile uint32_t stop;
+
+/*! Started together, readers and writers. */
+static pthread_barrier_t go;
+
+/*! Per reader counts. */
+static struct {
+  uint32_t reads;
+  uint32_t changes;
+  uint32_t torn;
+} readers[CFG_READERS];
+
+static void TestExpect(const char *what, int32_t ok) {
+  printf("%-56s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+/*
+ * Configuration number n, every field depends on it.
+ */
+static void TestFill(bootinfo_t *bootinfo, uint32_t n) {
+  bootinfo->status = BOOT_OK;
+  bootinfo->bootimg = (n & 2) ? IMG_CUSTOM : IMG_FACTORY;
+  bootinfo->trialid = n;
+  bootinfo->scrubok = n ^ 0xA5A5A5A5;
+  bootinfo->scrubbad = ~n;
+  bootinfo->netaddr = n * 2654435761u;
+  bootinfo->netport = n & 0xFFFF;
+  bootinfo->customslot = n & 1;
+}
+
+static int32_t TestConsistent(const bootinfo_t *bootinfo) {
+  bootinfo_t expect;
+
+  TestFill(&expect, bootinfo->trialid);
+  return 0 == memcmp(&expect, bootinfo, sizeof(bootinfo_t));
+}
+
+static void *TestReader(void *arg) {
+  uint32_t id = (uint32_t) (uintptr_t) arg;
+  bootinfo_t bootinfo;
+  uint32_t last = 0;
+
+  pthread_barrier_wait(&go);
+
+  while (!stop) {
+    CFGRead(&bootinfo);
+    readers[id].reads++;
+
+    if (!TestConsistent(&bootinfo))
+      readers[id].torn++;
+
+    if (bootinfo.trialid != last)
+      readers[id].changes++;
+
+    last = bootinfo.trialid;
+  }
+
+  return NULL;
+}
+
+/*
+ * Odd configurations, written whole.
+ */
+static void *TestWriter(void *arg) {
+  bootinfo_t bootinfo;
+  uint32_t i;
+
+  if (arg)
+    pthread_barrier_wait(&go);
+
+  for (i = 0; (i < CFG_WRITES) && !stop; i++) {
+    TestFill(&bootinfo, 2 * i + 1);
+    while (CFG_BUSY == CFGWrite(&bootinfo))
+      sched_yield();
+  }
+
+  return NULL;
+}
+
+/*
+ * Next even configuration after the current one.
+ */
+static int32_t TestEdit(bootinfo_t *bootinfo, void *arg) {
+  (void) arg;
+
+  TestFill(bootinfo, (bootinfo->trialid + 2) & ~1u);
+  return 0;
+}
+
+static void *TestUpdater(void *arg) {
+  uint32_t i;
+
+  if (arg)
+    pthread_barrier_wait(&go);
+
+  for (i = 0; (i < CFG_WRITES) && !stop; i++) {
+    while (CFG_BUSY == CFGUpdate(TestEdit, NULL))
+      sched_yield();
+  }
+
+  return NULL;
+}
+
+static void TestPreempt(int sig) {
+  (void) sig;
+
+  sched_yield();
+}
+
+/*
+ * Switch threads every us microseconds, 0 to stop.
+ */
+static void TestPreemptEvery(uint32_t us) {
+  struct itimerval timer;
+  struct sigaction action;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = TestPreempt;
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &action, NULL);
+
+  memset(&timer, 0, sizeof(timer));
+  timer.it_interval.tv_usec = us;
+  timer.it_value.tv_usec = us;
+  setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+static double TestWallNs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/*
+ * Wall time of a CFGRead, with retries per read.
+ */
+static double TestReadNs(double *retries) {
+  bootinfo_t bootinfo;
+  cfgstats_t before;
+  cfgstats_t after;
+  double start;
+  uint32_t i;
+
+  CFGStats(&before);
+  start = TestWallNs();
+
+  for (i = 0; i < CFG_BENCH_READS; i++)
+    CFGRead(&bootinfo);
+
+  start = TestWallNs() - start;
+  CFGStats(&after);
+
+  *retries = (double) (after.retries - before.retries) / CFG_BENCH_READS;
+  return start / CFG_BENCH_READS;
+}
+
+int main() {
+  pthread_t reader[CFG_READERS];
+  pthread_t writer[2];
+  bootinfo_t bootinfo;
+  bootinfo_t snapshot;
+  cfgstats_t stats;
+  uint32_t reads = 0;
+  uint32_t changes = 0;
+  uint32_t torn = 0;
+  uint64_t start;
+  double retries;
+  double ns;
+  uint32_t i;
+
+  HOSTInit();
+
+  TestFill(&bootinfo, 0);
+  if ((0 != BOOTWriteCfg(&bootinfo)) || (0 != CFGInit())) {
+    printf("can't set up boot.cfg\n");
+    return 2;
+  }
+
+  pthread_barrier_init(&go, NULL, CFG_READERS + 2);
+  TestPreemptEvery(CFG_PREEMPT_US);
+
+  for (i = 0; i < CFG_READERS; i++)
+    pthread_create(&reader[i], NULL, TestReader, (void*) (uintptr_t) i);
+
+  pthread_create(&writer[0], NULL, TestWriter, &go);
+  pthread_create(&writer[1], NULL, TestUpdater, &go);
+  pthread_join(writer[0], NULL);
+  pthread_join(writer[1], NULL);
+
+  stop = 1;
+  for (i = 0; i < CFG_READERS; i++) {
+    pthread_join(reader[i], NULL);
+    reads += readers[i].reads;
+    changes += readers[i].changes;
+    torn += readers[i].torn;
+  }
+
+  TestPreemptEvery(0);
+
+  CFGStats(&stats);
+  printf("%u reads by %u readers, %u changes seen, %u retries\n", reads,
+      CFG_READERS, changes, stats.retries);
+  printf("%u writes, %u busy\n", stats.writes, stats.busy);
+
+  TestExpect("every snapshot read is one written", 0 == torn);
+  TestExpect("readers saw the updates", changes > 0);
+  TestExpect("every write published", 2 * CFG_WRITES == stats.writes);
+
+  CFGRead(&snapshot);
+  BOOTClose();
+  TestExpect("last snapshot is in boot.cfg", (0 == BOOTReadCfg(&bootinfo))
+      && (0 == memcmp(&snapshot, &bootinfo, sizeof(bootinfo_t))));
+
+  ns = TestReadNs(&retries);
+  printf("CFGRead: %.1f ns", ns);
+
+  stop = 0;
+  pthread_create(&writer[0], NULL, TestWriter, NULL);
+  pthread_create(&writer[1], NULL, TestUpdater, NULL);
+  ns = TestReadNs(&retries);
+  stop = 1;
+  pthread_join(writer[0], NULL);
+  pthread_join(writer[1], NULL);
+  printf(", %.1f ns with both writers (%.4f retries per read)\n", ns,
+      retries);
+
+  BOOTClose();
+  start = HOSTUs;
+  BOOTReadCfg(&bootinfo);
+  printf("BOOTReadCfg: %.1f ms (NWP model)", (HOSTUs - start) / 1000.0);
+  start = HOSTUs;
+  BOOTReadCfg(&bootinfo);
+  printf(", %.1f ms with boot.cfg open\n", (HOSTUs - start) / 1000.0);
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file ckpttest.c
+ *
+ * 	\brief Application checkpoints (ckpt.h).
+ *
+ * 	Boots (bootflow.c) an image with an Adler-32 digest and .bss past its
+ * 	payload. A checkpoint of the .bss comes back after a hibernate, while
+ * 	regions over the payload or past the SRAM of the image are refused by
+ * 	CKPTSave, and a checkpoint file holding them is deleted at boot without
+ * 	touching the image. A checkpoint of an image whose digest only shares
+ * 	the first word is ignored.
+ *
+ * 	Then the boot to the resume function is timed against the cold boot to
+ * 	the reset handler, for a 64KB image and growing state: the checkpoint
+ * 	pays off when the initialization it replaces takes longer than the
+ * 	difference.
+ *
+ * 	Usage: ckpttest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "cksum.h"
+#include "ckpt.h"
+#include "host.h"
+
+/*! Payload of the test image. */
+#define TEST_IMG_LEN	1024
+
+/*! SRAM of the test image, payload and .bss. */
+#define TEST_MEM_LEN	4096
+
+/*! State saved by the application, in its .bss. */
+#define TEST_STATE_ADDR	(BASE_ADDR + 2048)
+#define TEST_STATE_LEN	64
+
+/*! Resume function of the application. */
+#define TEST_RESUME	(BASE_ADDR + 0x100)
+
+/*! Payload of the timed image. */
+#define READY_IMG_LEN	65536
+
+static int32_t failures;
+
+/*! Header of the image in factory.bin. */
+static imghdr_t hdr;
+
+/*! Payload of the test image. */
+static uint8_t payload[TEST_IMG_LEN];
+
+/*! Regions given to CKPTSave by AppSave. */
+static ckptregion_t saved;
+
+static void TestExpect(const char *what, int32_t ok) {
+  printf("%-56s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+/*
+ * Image linked at BASE_ADDR, its first word is the stack pointer.
+ */
+static void TestImage(uint8_t *data, uint32_t imglen, uint32_t memlen) {
+  uint8_t *file = malloc(sizeof(imghdr_t) + imglen);
+  uint32_t adler;
+  uint32_t i;
+
+  for (i = 0; i < imglen; i++)
+    data[i] = (uint8_t) (i * 7 + 3);
+
+  memset(&hdr, 0, sizeof(imghdr_t));
+  hdr.magic = IMG_MAGIC;
+  hdr.hdrlen = sizeof(imghdr_t);
+  hdr.linkaddr = BASE_ADDR;
+  hdr.imglen = imglen;
+  hdr.memlen = memlen;
+  hdr.digestalg = IMG_DIGEST_ADLER32;
+
+  adler = CKSUMAdler32(CKSUM_ADLER_INIT, data, imglen);
+  memcpy(hdr.digest, &adler, sizeof(uint32_t));
+
+  memcpy(file, &hdr, sizeof(imghdr_t));
+  memcpy(file + sizeof(imghdr_t), data, imglen);
+  NWPPut("/sys/factory.bin", file, sizeof(imghdr_t) + imglen);
+  free(file);
+}
+
+static int32_t AppHibernate(void) {
+  PRCMHibernateIntervalSet(32768);
+  PRCMHibernateWakeupSourceEnable(PRCM_HIB_SLOW_CLK_CTR);
+  PRCMHibernateEnter();
+  return -1;
+}
+
+/*
+ * Fill the state and checkpoint the regions in saved.
+ */
+static int32_t AppSave(void) {
+  memset((void*) TEST_STATE_ADDR, 0x5A, TEST_STATE_LEN);
+  return CKPTSave(&saved, 1, (void (*)(void)) TEST_RESUME);
+}
+
+/*
+ * Run the application, it ends in a reset unless it returns 0.
+ */
+static int32_t TestApp(int32_t (*app)(void)) {
+  int32_t ret = -1;
+
+  return HOSTRun(app, &ret) ? -1 : ret;
+}
+
+static int32_t TestBoot(void) {
+  int32_t img = -1;
+
+  if (0 != HOSTRun(HOSTBoot, &img))
+    img = -1;
+
+  return img;
+}
+
+/*
+ * Nothing at TEST_STATE_ADDR was restored.
+ */
+static int32_t TestStateClear(void) {
+  uint8_t zero[TEST_STATE_LEN];
+
+  memset(zero, 0, TEST_STATE_LEN);
+  return 0 == memcmp((void*) TEST_STATE_ADDR, zero, TEST_STATE_LEN);
+}
+
+/*
+ * Write a checkpoint file as CKPTSave would, with the given digest and
+ * region filled with 0xEE.
+ */
+static void TestPutCkpt(const uint8_t *digest, uint32_t addr, uint32_t len) {
+  static uint8_t file[sizeof(ckpthdr_t) + TEST_MEM_LEN];
+  ckpthdr_t *chdr = (ckpthdr_t*) file;
+
+  memset(file, 0, sizeof(file));
+  chdr->magic = CKPT_MAGIC;
+  chdr->alg = IMG_DIGEST_ADLER32;
+  memcpy(chdr->digest, digest, IMG_DIGEST_LEN);
+  chdr->base = BASE_ADDR;
+  chdr->imglen = TEST_IMG_LEN;
+  chdr->resume = TEST_RESUME;
+  chdr->count = 1;
+  chdr->regions[0].addr = addr;
+  chdr->regions[0].len = len;
+
+  memset(file + sizeof(ckpthdr_t), 0xEE, len);
+  chdr->check = CKSUMAdler32(CKSUM_ADLER_INIT, file + sizeof(ckpthdr_t),
+      len);
+
+  NWPPut("/sys/ckpt.bin", file, sizeof(ckpthdr_t) + len);
+}
+
+static int32_t TestCkptExists(void) {
+  SlFsFileInfo_t FileInfo;
+
+  return 0 == sl_FsGetInfo((const _u8*) "/sys/ckpt.bin", 0, &FileInfo);
+}
+
+/*
+ * Time of a hibernate wake boot, in microseconds.
+ */
+static uint64_t TestWake(void) {
+  uint64_t start;
+
+  TestApp(AppHibernate);
+  start = HOSTUs;
+  TestBoot();
+
+  return HOSTUs - start;
+}
+
+/*
+ * Boot to the reset handler and to the resume function, with statelen bytes
+ * of state past a 64KB payload.
+ */
+static void TestReady(uint32_t statelen) {
+  static uint8_t data[READY_IMG_LEN];
+  uint64_t cold;
+  uint64_t warm;
+
+  CKPTClear();
+  TestImage(data, READY_IMG_LEN, READY_IMG_LEN + statelen);
+  cold = TestWake();
+
+  saved.addr = BASE_ADDR + READY_IMG_LEN;
+  saved.len = statelen;
+  if (0 != TestApp(AppSave)) {
+    TestExpect("time to ready: checkpoint saved", 0);
+    return;
+  }
+
+  warm = TestWake();
+  if (CKPT_ADDR != CKPTEntry()) {
+    TestExpect("time to ready: checkpoint restored", 0);
+    return;
+  }
+
+  printf("%3u KB state: cold %6.1f ms, resume %6.1f ms (restore %5.1f ms)\n",
+      statelen / 1024, cold / 1000.0, warm / 1000.0,
+      CKPT->ticks * 1000.0 / 32768);
+}
+
+int main() {
+  uint8_t digest[IMG_DIGEST_LEN];
+  uint32_t i;
+
+  HOSTInit();
+  TestImage(payload, TEST_IMG_LEN, TEST_MEM_LEN);
+
+  TestBoot();
+  TestExpect("no checkpoint: image entered at its base",
+      BASE_ADDR == CKPTEntry());
+
+  saved.addr = BASE_ADDR + 0x10;
+  saved.len = 16;
+  TestExpect("save: region over the payload refused",
+      0 != TestApp(AppSave));
+
+  saved.addr = BASE_ADDR + TEST_IMG_LEN - 4;
+  saved.len = 16;
+  TestExpect("save: region across the end of the payload refused",
+      0 != TestApp(AppSave));
+
+  saved.addr = BASE_ADDR + TEST_MEM_LEN - 8;
+  saved.len = 16;
+  TestExpect("save: region past the SRAM of the image refused",
+      0 != TestApp(AppSave));
+
+  saved.addr = TEST_STATE_ADDR;
+  saved.len = TEST_STATE_LEN;
+  TestExpect("save: .bss region", 0 == TestApp(AppSave));
+
+  TestApp(AppHibernate);
+  TestBoot();
+  for (i = 0; i < TEST_STATE_LEN; i++) {
+    if (0x5A != ((uint8_t*) TEST_STATE_ADDR)[i])
+      break;
+  }
+  TestExpect("restore: .bss back, resume vector set",
+      (TEST_STATE_LEN == i) && (CKPT_ADDR == CKPTEntry())
+      && (TEST_RESUME == CKPT->entry) && (*(uint32_t*) BASE_ADDR == CKPT->sp));
+
+  memcpy(digest, hdr.digest, IMG_DIGEST_LEN);
+  TestPutCkpt(digest, BASE_ADDR + 0x10, 16);
+  TestApp(AppHibernate);
+  TestBoot();
+  TestExpect("restore: region over the payload deleted, image intact",
+      (BASE_ADDR == CKPTEntry()) && !TestCkptExists()
+      && (0 == memcmp((void*) BASE_ADDR, payload, TEST_IMG_LEN)));
+
+  TestPutCkpt(digest, BASE_ADDR + TEST_MEM_LEN - 8, 16);
+  TestApp(AppHibernate);
+  TestBoot();
+  TestExpect("restore: region past the SRAM of the image deleted",
+      (BASE_ADDR == CKPTEntry()) && !TestCkptExists()
+      && (0 == ((uint8_t*) BASE_ADDR)[TEST_MEM_LEN - 8]));
+
+  digest[IMG_DIGEST_LEN - 1] ^= 1;
+  TestPutCkpt(digest, TEST_STATE_ADDR, TEST_STATE_LEN);
+  TestApp(AppHibernate);
+  TestBoot();
+  TestExpect("restore: digest differing past the first word ignored",
+      (BASE_ADDR == CKPTEntry()) && TestCkptExists() && TestStateClear());
+
+  TestReady(4096);
+  TestReady(16384);
+  TestReady(65536);
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
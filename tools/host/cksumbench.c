@@ -0,0 +1,185 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file cksumbench.c
+ *
+ * 	\brief Throughput of the image digests on the host.
+ *
+ * 	BLAKE2s (blake2s.h), Adler-32 (cksum.h) and, for comparison, a table
+ * 	driven CRC32 are checked against known answers and timed on a
+ * 	CKSUM_BENCH_LEN buffer, in wall clock time of the host CPU, next to the
+ * 	time the NWP model takes to read the same bytes. The host build of the
+ * 	modules is plain C, the Cortex-M4 code paths (cksum.c) are not timed
+ * 	here.
+ *
+ * 	Usage: cksumbench
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "blake2s.h"
+#include "cksum.h"
+
+/*! Bytes hashed at once, a custom image. */
+#define CKSUM_BENCH_LEN	(128 * 1024)
+
+/*! Least wall clock time of each measure. */
+#define CKSUM_BENCH_NS	200000000ull
+
+/*! Read time of a byte in the NWP model (nwp.c, NWP_READ_NS). */
+#define CKSUM_READ_NS	1000
+
+static uint8_t data[CKSUM_BENCH_LEN];
+
+static int32_t failures;
+
+/*! Table of the CRC32 (IEEE, reflected), built by BenchCrcTable. */
+static uint32_t crctab[256];
+
+static uint64_t BenchNs(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t BenchBlake2s(const uint8_t *buf, uint32_t len) {
+  blake2sctx_t ctx;
+  uint8_t digest[BLAKE2S_OUTLEN];
+
+  BLAKE2SInit(&ctx, BLAKE2S_OUTLEN);
+  BLAKE2SUpdate(&ctx, buf, len);
+  BLAKE2SFinal(&ctx, digest);
+
+  return digest[0];
+}
+
+static void BenchCrcTable(void) {
+  uint32_t crc;
+  uint32_t i;
+  uint32_t bit;
+
+  for (i = 0; i < 256; i++) {
+    crc = i;
+    for (bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    crctab[i] = crc;
+  }
+}
+
+static uint32_t BenchCrc32(const uint8_t *buf, uint32_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+
+  while (len--)
+    crc = crctab[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+
+  return ~crc;
+}
+
+static uint32_t BenchAdler32(const uint8_t *buf, uint32_t len) {
+  return CKSUMAdler32(CKSUM_ADLER_INIT, buf, len);
+}
+
+/*! Digests timed. */
+static const struct {
+  const char *name;
+  uint32_t (*run)(const uint8_t *buf, uint32_t len);
+  /*! SRAM of the state or table. */
+  uint32_t sram;
+} benches[] = { { "BLAKE2s", BenchBlake2s, sizeof(blake2sctx_t) }, {
+    "Adler-32", BenchAdler32, 0 }, { "CRC32", BenchCrc32, sizeof(crctab) } };
+
+#define CKSUM_BENCHES	(sizeof(benches) / sizeof(benches[0]))
+
+/*
+ * Known answers.
+ */
+static void BenchCheck(void) {
+  static const uint8_t abc[BLAKE2S_OUTLEN] = { 0x50, 0x8C, 0x5E, 0x8C, 0x32,
+      0x7C, 0x14, 0xE2, 0xE1, 0xA7, 0x2B, 0xA3, 0x4E, 0xEB, 0x45, 0x2F, 0x37,
+      0x45, 0x8B, 0x20, 0x9E, 0xD6, 0x3A, 0x29, 0x4D, 0x99, 0x9B, 0x4C, 0x86,
+      0x67, 0x59, 0x82 };
+  blake2sctx_t ctx;
+  uint8_t digest[BLAKE2S_OUTLEN];
+
+  BLAKE2SInit(&ctx, BLAKE2S_OUTLEN);
+  BLAKE2SUpdate(&ctx, (const uint8_t*) "abc", 3);
+  BLAKE2SFinal(&ctx, digest);
+
+  if (0 != memcmp(digest, abc, sizeof(abc))) {
+    printf("BLAKE2s(\"abc\") is wrong\n");
+    failures++;
+  }
+
+  if (0x091E01DE != BenchAdler32((const uint8_t*) "123456789", 9)) {
+    printf("Adler-32(\"123456789\") is wrong\n");
+    failures++;
+  }
+
+  if (0xCBF43926 != BenchCrc32((const uint8_t*) "123456789", 9)) {
+    printf("CRC32(\"123456789\") is wrong\n");
+    failures++;
+  }
+}
+
+int main() {
+  volatile uint32_t sink = 0;
+  uint64_t start;
+  uint64_t ns;
+  uint32_t runs;
+  uint32_t i;
+  double mbs;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t) (i * 131 + (i >> 9));
+
+  BenchCrcTable();
+  BenchCheck();
+
+  printf("%u bytes, NWP read %.1f MB/s\n", CKSUM_BENCH_LEN,
+      1000.0 / CKSUM_READ_NS);
+  printf("%-12s %10s %12s %8s\n", "", "MB/s", "of the read", "SRAM");
+
+  for (i = 0; i < CKSUM_BENCHES; i++) {
+    start = BenchNs();
+    runs = 0;
+
+    do {
+      sink += benches[i].run(data, sizeof(data));
+      runs++;
+      ns = BenchNs() - start;
+    } while (ns < CKSUM_BENCH_NS);
+
+    mbs = (double) runs * sizeof(data) * 1000.0 / ns;
+    printf("%-12s %10.1f %11.1f%% %8u\n", benches[i].name, mbs,
+        100.0 * (1000.0 / CKSUM_READ_NS) / mbs, benches[i].sram);
+  }
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
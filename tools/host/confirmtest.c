@@ -0,0 +1,279 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file confirmtest.c
+ *
+ * 	\brief Resets between the confirmation of a trial and its sync
+ * 	(confirm.h).
+ *
+ * 	A custom image on trial calls CONFIRMImage and CONFIRMSync. The SOC is
+ * 	reset right after CONFIRMImage, on each NWP call of CONFIRMSync (the
+ * 	write of /sys/confirm.bin included, left empty by the reset, see
+ * 	NWPTorn) and right after it, by the watchdog, by a hibernate and by a
+ * 	power loss. The device then boots (bootflow.c) until an image runs, the
+ * 	application confirming itself again on every trial boot as it would on
+ * 	the target.
+ *
+ * 	Every run must end with boot.cfg BOOT_OK and no trial pending: the
+ * 	custom image confirmed, or the factory image after a rollback, never a
+ * 	trial that is lost or stuck. The trial must be confirmed whenever the
+ * 	confirmation survived the reset: in the retained SRAM (watchdog), in the
+ * 	OCR register (hibernate) or in the file (sync done).
+ *
+ * 	A trial that is not confirmed while the factory image is marked as
+ * 	damaged by the scrubber (scrub.h) must not roll back to it.
+ *
+ * 	Usage: confirmtest
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "confirm.h"
+#include "scrub.h"
+#include "host.h"
+
+/*! Boots tried before the trial is taken as stuck. */
+#define CONFIRM_BOOTS	8
+
+/*! Power loss, a hibernate reset that also clears the OCR registers. */
+#define CONFIRM_POWER_LOSS	0xFF
+
+static int32_t failures;
+
+/*! Where the reset comes: 0 after CONFIRMImage, 1 to synccalls on that NWP
+ * call of CONFIRMSync, synccalls + 1 after it. */
+static uint32_t resetpoint;
+static unsigned long resetcause;
+
+/*! NWP calls of a CONFIRMSync. */
+static uint32_t synccalls;
+
+static void TestExpect(const char *what, int32_t ok) {
+  printf("%-56s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+static int32_t AppUpdate(void) {
+  bootinfo_t bootinfo;
+
+  if (0 != BOOTReadCfg(&bootinfo))
+    return -1;
+
+  bootinfo.status = BOOT_CHECK;
+  bootinfo.bootimg = IMG_CUSTOM;
+  if (0 != BOOTWriteCfg(&bootinfo))
+    return -1;
+
+  BOOTClose();
+  PRCMSOCReset();
+  return -1;
+}
+
+/*
+ * Confirm the trial, with the reset at resetpoint.
+ */
+static int32_t AppConfirmReset(void) {
+  unsigned long cause = (CONFIRM_POWER_LOSS == resetcause) ? PRCM_HIB_EXIT :
+      resetcause;
+
+  CONFIRMImage();
+  if (0 == resetpoint)
+    HOSTReset(cause);
+
+  NWPResetAt(resetpoint, cause);
+  CONFIRMSync();
+  NWPResetAt(0, 0);
+
+  HOSTReset(cause);
+  return -1;
+}
+
+/*
+ * What the application does on every boot.
+ */
+static int32_t AppConfirm(void) {
+  CONFIRMImage();
+  CONFIRMSync();
+  return 0;
+}
+
+static int32_t AppWatchdog(void) {
+  HOSTReset(PRCM_WDT_RESET);
+  return -1;
+}
+
+/*
+ * Power on with both images, then a custom image on trial. boot.cfg is
+ * closed first, the handle kept by boot.c does not survive NWPFormat.
+ */
+static int32_t TestTrial(void) {
+  static uint8_t image[256];
+  int32_t img;
+
+  HOSTPowerOn();
+  BOOTClose();
+  NWPFormat();
+  NWPPut("/sys/factory.bin", image, sizeof(image));
+  NWPPut((const char*) BOOTSlotName(0), image, sizeof(image));
+
+  HOSTRun(HOSTBoot, &img);
+  HOSTRun(AppUpdate, &img);
+
+  if ((0 != HOSTRun(HOSTBoot, &img)) || (IMG_CUSTOM != img)
+      || (0 == HANDOFF->trialid))
+    return -1;
+
+  return 0;
+}
+
+/*
+ * Boot until the configuration settles, the application confirming every
+ * trial boot. Returns the image of boot.cfg, -1 if it never settled.
+ */
+static int32_t TestSettle(void) {
+  bootinfo_t bootinfo;
+  uint32_t boots;
+  int32_t img;
+
+  for (boots = 0; boots < CONFIRM_BOOTS; boots++) {
+    if (0 != HOSTRun(HOSTBoot, &img))
+      continue;
+
+    if (HANDOFF->trialid) {
+      HOSTRun(AppConfirm, &img);
+      HOSTRun(AppWatchdog, &img);
+      continue;
+    }
+
+    BOOTClose();
+    if ((0 != BOOTReadCfg(&bootinfo)) || (BOOT_OK != bootinfo.status)
+        || (bootinfo.bootimg != img))
+      return -1;
+
+    return img;
+  }
+
+  return -1;
+}
+
+/*
+ * Count the NWP calls of a sync.
+ */
+static void TestSyncCalls(void) {
+  nwpstats_t nwp;
+  int32_t ret;
+
+  TestTrial();
+  CONFIRMImage();
+  NWPClear();
+  HOSTRun(CONFIRMSync, &ret);
+  NWPStats(&nwp);
+  synccalls = nwp.calls;
+}
+
+static void TestResets(const char *name, unsigned long cause) {
+  char what[80];
+  int32_t retained = (CONFIRM_POWER_LOSS != cause);
+  int32_t expect;
+  int32_t img;
+  int32_t ret;
+
+  resetcause = cause;
+
+  for (resetpoint = 0; resetpoint <= synccalls + 1; resetpoint++) {
+    if (0 != TestTrial()) {
+      TestExpect("custom image on trial", 0);
+      return;
+    }
+
+    HOSTRun(AppConfirmReset, &ret);
+    if (CONFIRM_POWER_LOSS == cause)
+      HOSTPowerOn();
+
+    img = TestSettle();
+    expect = (retained || (resetpoint > synccalls)) ? IMG_CUSTOM : IMG_FACTORY;
+
+    if (0 == resetpoint)
+      snprintf(what, sizeof(what), "%s after CONFIRMImage", name);
+    else if (resetpoint > synccalls)
+      snprintf(what, sizeof(what), "%s after CONFIRMSync", name);
+    else
+      snprintf(what, sizeof(what), "%s on NWP call %u of CONFIRMSync", name,
+          resetpoint);
+
+    snprintf(what + strlen(what), sizeof(what) - strlen(what), ": %s",
+        (IMG_CUSTOM == expect) ? "confirmed" : "rolled back");
+    TestExpect(what, expect == img);
+  }
+}
+
+/*
+ * A trial that is not confirmed while the scrubber marked the factory image
+ * as damaged: the custom image gets a new trial instead of the rollback.
+ */
+static void TestDamagedFactory(void) {
+  bootinfo_t bootinfo;
+  int32_t img;
+
+  if (0 != TestTrial()) {
+    TestExpect("custom image on trial", 0);
+    return;
+  }
+
+  BOOTClose();
+  BOOTReadCfg(&bootinfo);
+  bootinfo.scrubbad |= SCRUB_BIT(IMG_FACTORY);
+  BOOTWriteCfg(&bootinfo);
+
+  HOSTRun(AppWatchdog, &img);
+  TestExpect("damaged factory image: custom image on a new trial",
+      (0 == HOSTRun(HOSTBoot, &img)) && (IMG_CUSTOM == img)
+          && (0 != HANDOFF->trialid));
+
+  TestExpect("damaged factory image: custom image confirmed",
+      IMG_CUSTOM == TestSettle());
+}
+
+int main() {
+  HOSTInit();
+  NWPTorn(1);
+
+  TestSyncCalls();
+  printf("CONFIRMSync: %u NWP calls\n", synccalls);
+
+  TestResets("watchdog", PRCM_WDT_RESET);
+  TestResets("hibernate", PRCM_HIB_EXIT);
+  TestResets("power loss", CONFIRM_POWER_LOSS);
+
+  TestDamagedFactory();
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file hibtest.c
+ *
+ * 	\brief Boot state kept in the OCR register (hibstate.h).
+ *
+ * 	Checks the encoding of the state word, then boots (bootflow.c) through
+ * 	the wake and cold paths: a BOOT_OK wake doesn't open boot.cfg, a trial
+ * 	confirmed before a hibernate keeps running without a boot.cfg write, and
+ * 	power on, watchdog resets and a corrupt word fall back to boot.cfg.
+ *
+ * 	Usage: hibtest
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "confirm.h"
+#include "hibstate.h"
+#include "host.h"
+
+static int32_t failures;
+
+static void TestExpect(const char *what, int32_t ok) {
+  printf("%-56s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+/*
+ * Every state comes back, no single bit error goes through.
+ */
+static void TestEncoding(void) {
+  hibstate_t state;
+  hibstate_t back;
+  uint32_t word;
+  uint32_t bad = 0;
+  uint32_t bit;
+
+  memset(&state, 0, sizeof(state));
+
+  for (state.status = 0; state.status < 4; state.status++)
+    for (state.bootimg = 0; state.bootimg < 2; state.bootimg++)
+      for (state.confirmed = 0; state.confirmed < 2; state.confirmed++)
+        for (state.netboot = 0; state.netboot < 2; state.netboot++)
+          for (state.slot = 0; state.slot < 2; state.slot++)
+            for (state.tag = 0; state.tag < 0x4000; state.tag++) {
+              word = HIBSTATEEncode(&state);
+              memset(&back, 0, sizeof(back));
+              if ((0 != HIBSTATEDecode(word, &back))
+                  || (0 != memcmp(&state, &back, sizeof(state))))
+                bad++;
+
+              for (bit = 0; bit < 32; bit++) {
+                if (0 == HIBSTATEDecode(word ^ (1u << bit), &back))
+                  bad++;
+              }
+            }
+
+  TestExpect("encoding: all states decode, single bit errors refused",
+      0 == bad);
+}
+
+static int32_t AppHibernate(void) {
+  PRCMHibernateIntervalSet(32768);
+  PRCMHibernateWakeupSourceEnable(PRCM_HIB_SLOW_CLK_CTR);
+  PRCMHibernateEnter();
+  return -1;
+}
+
+static int32_t AppWatchdog(void) {
+  HOSTReset(PRCM_WDT_RESET);
+  return -1;
+}
+
+static int32_t AppUpdate(void) {
+  bootinfo_t bootinfo;
+
+  if (0 != BOOTReadCfg(&bootinfo))
+    return -1;
+
+  bootinfo.status = BOOT_CHECK;
+  bootinfo.bootimg = IMG_CUSTOM;
+  if (0 != BOOTWriteCfg(&bootinfo))
+    return -1;
+
+  BOOTClose();
+  PRCMSOCReset();
+  return -1;
+}
+
+static int32_t AppConfirm(void) {
+  CONFIRMImage();
+  return 0;
+}
+
+/*
+ * The SRAM record is lost in hibernate, the image confirms itself again.
+ */
+static int32_t AppSync(void) {
+  CONFIRMImage();
+  return CONFIRMPending() ? CONFIRMSync() : -1;
+}
+
+/*
+ * Run the application, it ends in a reset unless it returns 0.
+ */
+static int32_t TestApp(int32_t (*app)(void)) {
+  int32_t ret = -1;
+
+  return HOSTRun(app, &ret) ? 0 : ret;
+}
+
+/*
+ * Boot, with the NWP calls it took.
+ */
+static int32_t TestBoot(nwpstats_t *nwp) {
+  int32_t img = -1;
+
+  NWPClear();
+  if (0 != HOSTRun(HOSTBoot, &img))
+    img = -1;
+
+  NWPStats(nwp);
+  return img;
+}
+
+int main() {
+  static uint8_t image[256];
+  nwpstats_t nwp;
+  nwpstats_t cold;
+  int32_t img;
+
+  HOSTInit();
+  TestEncoding();
+
+  NWPPut("/sys/factory.bin", image, sizeof(image));
+  NWPPut((const char*) BOOTSlotName(0), image, sizeof(image));
+
+  img = TestBoot(&cold);
+  TestExpect("power on: boot.cfg created, factory image",
+      (IMG_FACTORY == img) && (cold.writes > 0));
+
+  img = TestBoot(&cold);
+  TestExpect("reset: boot.cfg read", (IMG_FACTORY == img) && (cold.opens > 1));
+
+  TestApp(AppHibernate);
+  img = TestBoot(&nwp);
+  TestExpect("BOOT_OK wake: only the image opened",
+      (IMG_FACTORY == img) && (1 == nwp.opens) && (0 == nwp.writes));
+
+  TestApp(AppWatchdog);
+  img = TestBoot(&nwp);
+  TestExpect("watchdog reset: boot.cfg read",
+      (IMG_FACTORY == img) && (nwp.opens == cold.opens));
+
+  TestApp(AppHibernate);
+  HOSTOcr[HIBSTATE_OCR] ^= 1u << 12;
+  img = TestBoot(&nwp);
+  TestExpect("corrupt word on a wake: boot.cfg read",
+      (IMG_FACTORY == img) && (nwp.opens == cold.opens));
+
+  HOSTPowerOn();
+  img = TestBoot(&nwp);
+  TestExpect("power on: boot.cfg read",
+      (IMG_FACTORY == img) && (nwp.opens == cold.opens));
+
+  TestApp(AppUpdate);
+  img = TestBoot(&nwp);
+  TestExpect("BOOT_CHECK: custom image on trial",
+      (IMG_CUSTOM == img) && (0 != HANDOFF->trialid));
+
+  TestApp(AppConfirm);
+  TestApp(AppHibernate);
+  img = TestBoot(&nwp);
+  TestExpect("confirmed trial wake: custom image, no boot.cfg write",
+      (IMG_CUSTOM == img) && (0 == nwp.writes) && (0 != HANDOFF->trialid));
+
+  TestExpect("confirmation made durable", 0 == TestApp(AppSync));
+  TestApp(AppWatchdog);
+  img = TestBoot(&nwp);
+  TestExpect("reset after the sync: custom image confirmed",
+      (IMG_CUSTOM == img) && (0 == HANDOFF->trialid));
+
+  TestApp(AppUpdate);
+  img = TestBoot(&nwp);
+  TestApp(AppHibernate);
+  img = TestBoot(&nwp);
+  TestExpect("unconfirmed trial wake: back to the factory image",
+      IMG_FACTORY == img);
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
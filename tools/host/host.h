@@ -0,0 +1,207 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _HOST_H_
+#define _HOST_H_
+
+/*!
+ *	\file host.h
+ *	\brief Host stand-in of the CC3200 for the boot modules.
+ *	The SRAM is mapped at its real address, so the modules run unchanged.
+ *	Time is simulated: HOSTDelay and the NWP costs (nwp.c) move the slow
+ *	clock, the watchdog, hibernate and SOC resets end the running HOSTRun.
+ *	Hibernate clears the SRAM and keeps the OCR registers, a power on clears
+ *	both; the files (nwp.c) are kept until NWPFormat.
+ */
+
+#include <stdint.h>
+
+/*! Start of the SRAM. */
+#define HOST_SRAM_ADDR	0x20000000
+
+/*! Size of the SRAM. */
+#define HOST_SRAM_SIZE	0x40000
+
+/*! Simulated time since the power on, in microseconds. */
+extern uint64_t HOSTUs;
+
+/*! Cause of the last reset (PRCM_*), as read by PRCMSysResetCauseGet. */
+extern unsigned long HOSTResetCause;
+
+/*! OCR registers of the hibernate domain. */
+extern unsigned long HOSTOcr[2];
+
+/*!
+ *	\fn void HOSTInit(void)
+ * 	\brief Map the SRAM and power on. Must be called first.
+ */
+void HOSTInit(void);
+
+/*!
+ *	\fn void HOSTPowerOn(void)
+ * 	\brief Power on: SRAM, OCR registers, clock and watchdog cleared.
+ */
+void HOSTPowerOn(void);
+
+/*!
+ *	\fn void HOSTDelay(uint64_t us)
+ * 	\brief Let time pass. The watchdog resets the SOC if it runs out.
+ * 	\param[in] us Time in microseconds.
+ */
+void HOSTDelay(uint64_t us);
+
+/*!
+ *	\fn void HOSTReset(unsigned long cause)
+ * 	\brief Reset the SOC, ending the running HOSTRun.
+ * 	\param[in] cause Reset cause (PRCM_*), PRCM_HIB_EXIT clears the SRAM.
+ */
+void HOSTReset(unsigned long cause);
+
+/*!
+ *	\fn int32_t HOSTRun(int32_t (*fn)(void), int32_t *ret)
+ * 	\brief Run the code of a boot until it returns or resets the SOC.
+ * 	\param[in] fn Function to run.
+ * 	\param[out] ret Value returned by fn, unchanged on a reset.
+ * 	\return 0 if fn returned, 1 on a reset (cause in HOSTResetCause).
+ */
+int32_t HOSTRun(int32_t (*fn)(void), int32_t *ret);
+
+/*!
+ *	\fn int32_t HOSTBoot(void)
+ * 	\brief The boot of main.c up to the image start (bootflow.c).
+ * 	Without the UART, profiler, staged images, netboot and NWP handover. A
+ * 	failed stage ends in the backoff hibernate, as on the target.
+ * 	\return The image started (IMG_FACTORY or IMG_CUSTOM).
+ */
+int32_t HOSTBoot(void);
+
+/*! Set for HOSTBoot to close boot.cfg between BOOTExistCfg and BOOTReadCfg,
+ * paying the open the handle kept by boot.c saves. */
+extern int32_t HOSTReopenCfg;
+
+/*!
+ *	\struct nwpstats_t
+ *	\brief NWP calls since NWPClear.
+ */
+typedef struct {
+  /*! All NWP calls. */
+  uint32_t calls;
+  /*! sl_FsOpen calls. */
+  uint32_t opens;
+  /*! sl_FsRead calls. */
+  uint32_t reads;
+  /*! sl_FsWrite calls (flash writes). */
+  uint32_t writes;
+  /*! Opens of secure files, also in opens. */
+  uint32_t secureopens;
+  /*! Flash blocks erased. */
+  uint32_t erases;
+  /*! Bytes read. */
+  uint32_t readbytes;
+  /*! Bytes written. */
+  uint32_t writebytes;
+} nwpstats_t;
+
+/*!
+ *	\fn void NWPFormat(void)
+ * 	\brief Delete all files and clear the statistics.
+ */
+void NWPFormat(void);
+
+/*!
+ *	\fn int32_t NWPPut(const char *name, const void *data, uint32_t len)
+ * 	\brief Create a file with the given contents, at no cost.
+ * 	\return 0 on success, -1 if the file system is full.
+ */
+int32_t NWPPut(const char *name, const void *data, uint32_t len);
+
+/*!
+ *	\fn int32_t NWPSecure(const char *name)
+ * 	\brief Make a file secure, as if created with _FS_FILE_OPEN_FLAG_SECURE
+ * 	and a token.
+ * 	\return 0 on success, -1 if there is no such file.
+ */
+int32_t NWPSecure(const char *name);
+
+/*!
+ *	\fn void NWPStats(nwpstats_t *stats)
+ * 	\brief Get the NWP calls since NWPClear.
+ */
+void NWPStats(nwpstats_t *stats);
+
+/*!
+ *	\fn void NWPClear(void)
+ * 	\brief Clear the statistics.
+ */
+void NWPClear(void);
+
+/*!
+ *	\fn void NWPStall(uint32_t call)
+ * 	\brief Make an NWP call stall, as a hung NWP.
+ * 	The call takes NWP_STALL_US, unless the watchdog resets the SOC first.
+ * 	\param[in] call Number of the call from now (1 for the next one), 0 for
+ * 	none.
+ */
+void NWPStall(uint32_t call);
+
+/*!
+ *	\fn void NWPResetAt(uint32_t call, unsigned long cause)
+ * 	\brief Reset the SOC on an NWP call, before the call takes effect.
+ * 	\param[in] call Number of the call from now (1 for the next one), 0 for
+ * 	none.
+ * 	\param[in] cause Reset cause given to HOSTReset.
+ */
+void NWPResetAt(uint32_t call, unsigned long cause);
+
+/*!
+ *	\fn void NWPTorn(int32_t on)
+ * 	\brief Make a reset leave the files being written empty, unless they
+ * 	were created fail-safe. Off by default: a write cut by a reset keeps
+ * 	the old contents.
+ */
+void NWPTorn(int32_t on);
+
+/*!
+ *	\fn void NWPWriteErase(int32_t on)
+ * 	\brief Make every open for writing erase the blocks of the file (the
+ * 	copy being written of a fail-safe file). Off by default: only the
+ * 	creation erases, which is enough to time a single write.
+ */
+void NWPWriteErase(int32_t on);
+
+/*!
+ *	\fn void NWPRecvMax(uint32_t max)
+ * 	\brief Limit the bytes returned by each sl_Recv, to force short reads.
+ * 	\param[in] max Largest sl_Recv, 0 for any.
+ */
+void NWPRecvMax(uint32_t max);
+
+/*!
+ *	\fn void NWPReset(void)
+ * 	\brief Reset of the NWP with the SOC, called by HOSTReset and
+ * 	HOSTPowerOn. Only cuts the writes in progress (see NWPTorn).
+ */
+void NWPReset(void);
+
+#endif
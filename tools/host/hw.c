@@ -0,0 +1,217 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file hw.c
+ *
+ * 	\brief Host stand-in of the driverlib.
+ *
+ * 	This file implements the clock, resets, OCR registers, hibernate and
+ * 	watchdog calls of the boot modules on the host.
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "sdk.h"
+#include "host.h"
+
+/*! Watchdog clock ticks per microsecond (80MHz). */
+#define HOST_WDT_TICKS_PER_US	80
+
+uint64_t HOSTUs;
+unsigned long HOSTResetCause;
+unsigned long HOSTOcr[2];
+
+/*! Watchdog state. */
+static struct {
+  int32_t enabled;
+  unsigned long reload;
+  uint64_t start;
+} wdt;
+
+/*! Hibernate interval in slow clock ticks. */
+static unsigned long long hibticks;
+
+/*! Context of the running HOSTRun. */
+static jmp_buf runctx;
+static int32_t running;
+
+/*
+ * Map the SRAM at its address.
+ */
+void HOSTInit() {
+  void *sram = mmap((void*) HOST_SRAM_ADDR, HOST_SRAM_SIZE,
+      PROT_READ | PROT_WRITE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if ((void*) HOST_SRAM_ADDR != sram) {
+    fprintf(stderr, "can't map the SRAM at 0x%08X\n", HOST_SRAM_ADDR);
+    exit(2);
+  }
+
+  HOSTPowerOn();
+}
+
+/*
+ * Everything but the files is lost.
+ */
+void HOSTPowerOn() {
+  memset((void*) HOST_SRAM_ADDR, 0, HOST_SRAM_SIZE);
+  memset(HOSTOcr, 0, sizeof(HOSTOcr));
+  memset(&wdt, 0, sizeof(wdt));
+  HOSTUs = 0;
+  HOSTResetCause = PRCM_POWER_ON;
+  NWPReset();
+}
+
+/*
+ * The SOC is reset on the second timeout, at twice the reload.
+ */
+void HOSTDelay(uint64_t us) {
+  uint64_t expiry;
+
+  if (wdt.enabled) {
+    expiry = wdt.start + (2ull * wdt.reload) / HOST_WDT_TICKS_PER_US;
+    if (HOSTUs + us >= expiry) {
+      HOSTUs = expiry;
+      HOSTReset(PRCM_WDT_RESET);
+    }
+  }
+
+  HOSTUs += us;
+}
+
+/*
+ * A reset stops the watchdog, hibernate also loses the SRAM.
+ */
+void HOSTReset(unsigned long cause) {
+  HOSTResetCause = cause;
+  memset(&wdt, 0, sizeof(wdt));
+  NWPReset();
+
+  if (PRCM_HIB_EXIT == cause)
+    memset((void*) HOST_SRAM_ADDR, 0, HOST_SRAM_SIZE);
+
+  if (running)
+    longjmp(runctx, 1);
+
+  fprintf(stderr, "reset outside of HOSTRun\n");
+  exit(2);
+}
+
+/*
+ * The reset jumps back here.
+ */
+int32_t HOSTRun(int32_t (*fn)(void), int32_t *ret) {
+  if (setjmp(runctx)) {
+    running = 0;
+    return 1;
+  }
+
+  running = 1;
+  *ret = fn();
+  running = 0;
+
+  return 0;
+}
+
+void PRCMPeripheralClkEnable(unsigned long ulPeripheral,
+    unsigned long ulClkFlags) {
+  (void) ulPeripheral;
+  (void) ulClkFlags;
+}
+
+void PRCMPeripheralReset(unsigned long ulPeripheral) {
+  if (PRCM_WDT == ulPeripheral)
+    memset(&wdt, 0, sizeof(wdt));
+}
+
+unsigned long PRCMSysResetCauseGet() {
+  return HOSTResetCause;
+}
+
+void PRCMSOCReset() {
+  HOSTReset(PRCM_SOC_RESET);
+}
+
+unsigned long long PRCMSlowClkCtrGet() {
+  return (HOSTUs * 32768) / 1000000;
+}
+
+void PRCMOCRRegisterWrite(unsigned char ucIndex, unsigned long ulRegValue) {
+  HOSTOcr[ucIndex & 1] = ulRegValue;
+}
+
+unsigned long PRCMOCRRegisterRead(unsigned char ucIndex) {
+  return HOSTOcr[ucIndex & 1];
+}
+
+void PRCMHibernateIntervalSet(unsigned long long ullTicks) {
+  hibticks = ullTicks;
+}
+
+void PRCMHibernateWakeupSourceEnable(unsigned long ulHIBWakupSrc) {
+  (void) ulHIBWakupSrc;
+}
+
+void PRCMHibernateEnter() {
+  HOSTUs += (hibticks * 1000000) / 32768;
+  HOSTReset(PRCM_HIB_EXIT);
+}
+
+void WatchdogUnlock(unsigned long ulBase) {
+  (void) ulBase;
+}
+
+void WatchdogStallEnable(unsigned long ulBase) {
+  (void) ulBase;
+}
+
+void WatchdogIntClear(unsigned long ulBase) {
+  (void) ulBase;
+}
+
+/*
+ * A new reload starts the count again.
+ */
+void WatchdogReloadSet(unsigned long ulBase, unsigned long ulLoadVal) {
+  (void) ulBase;
+  wdt.reload = ulLoadVal;
+  wdt.start = HOSTUs;
+}
+
+void WatchdogEnable(unsigned long ulBase) {
+  (void) ulBase;
+  wdt.enabled = 1;
+}
+
+void IntDisable(unsigned long ulInterrupt) {
+  (void) ulInterrupt;
+}
+
+void IntPendClear(unsigned long ulInterrupt) {
+  (void) ulInterrupt;
+}
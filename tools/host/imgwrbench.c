@@ -0,0 +1,345 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file imgwrbench.c
+ *
+ * 	\brief Update throughput of the image writer (imgwr.h).
+ *
+ * 	Each image is served by a loopback HTTP server and received by the
+ * 	application in socket sized pieces, written with IMGWRWrite to the
+ * 	in-memory file system (nwp.c). The device then resets, boots the image
+ * 	on trial (bootflow.c) and the image confirms itself. For each image, with
+ * 	the slot created on demand and prepared ahead (IMGWRPrepare), it prints
+ * 	the bytes, the flash writes, the write throughput and the simulated time
+ * 	from the start of the update to the confirmation.
+ *
+ * 	Full and packed (mkimg.py -z) images are updates like any other, there
+ * 	is no delta update in the bootloader.
+ *
+ * 	Usage: imgwrbench factory.bin image.bin...
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "cfg.h"
+#include "confirm.h"
+#include "imgwr.h"
+#include "host.h"
+
+/*! Largest socket read, a TCP segment. */
+#define BENCH_RECV	1460
+
+/*! Image being updated. */
+static struct {
+  const char *name;
+  uint8_t *data;
+  uint32_t len;
+  int32_t prepare;
+  uint16_t port;
+  uint64_t start;
+  double wallus;
+  imgwrstats_t stats;
+} bench;
+
+/*
+ * Read a whole file.
+ */
+static uint8_t *BenchLoad(const char *name, uint32_t *len) {
+  FILE *file = fopen(name, "rb");
+  uint8_t *data;
+  long size;
+
+  if (NULL == file)
+    return NULL;
+
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  data = malloc(size ? size : 1);
+  if (data && (1 != fread(data, size, 1, file)) && size) {
+    free(data);
+    data = NULL;
+  }
+
+  fclose(file);
+  *len = size;
+
+  return data;
+}
+
+static double BenchWallUs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+/*
+ * Serve the image once, on a loopback port, from a child process.
+ */
+static pid_t BenchServe(void) {
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof(addr);
+  char req[512];
+  char hdr[128];
+  int srv;
+  int con;
+  pid_t pid;
+
+  srv = socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if ((srv < 0) || bind(srv, (struct sockaddr*) &addr, sizeof(addr))
+      || listen(srv, 1)
+      || getsockname(srv, (struct sockaddr*) &addr, &addrlen)) {
+    perror("loopback server");
+    exit(2);
+  }
+
+  bench.port = ntohs(addr.sin_port);
+
+  pid = fork();
+  if (0 != pid) {
+    close(srv);
+    return pid;
+  }
+
+  con = accept(srv, NULL, NULL);
+  if ((con >= 0) && (read(con, req, sizeof(req)) > 0)) {
+    snprintf(hdr, sizeof(hdr), "HTTP/1.0 200 OK\r\n"
+        "Content-Length: %u\r\n\r\n", bench.len);
+    if ((write(con, hdr, strlen(hdr)) > 0)
+        && (write(con, bench.data, bench.len) != (ssize_t) bench.len))
+      perror("loopback server");
+  }
+
+  _exit(0);
+}
+
+/*
+ * Receive the HTTP header, it fits in the buffer. Returns the bytes of the
+ * body already received, moved to the start of buf, or -1.
+ */
+static int BenchHeader(int sock, unsigned char *buf, uint32_t size) {
+  uint32_t len = 0;
+  char *end;
+  int n;
+
+  while ((len < size) && ((n = recv(sock, buf + len, size - len, 0)) > 0)) {
+    len += n;
+
+    end = memmem(buf, len, "\r\n\r\n", 4);
+    if (end) {
+      n = len - (end + 4 - (char*) buf);
+      memmove(buf, end + 4, n);
+      return n;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * The application: GET the image and write it, then reset.
+ */
+static int32_t BenchUpdate(void) {
+  struct sockaddr_in addr;
+  unsigned char buf[BENCH_RECV];
+  const char req[] = "GET /image.bin HTTP/1.0\r\n\r\n";
+  int32_t RetVal = -1;
+  uint32_t got = 0;
+  double start;
+  int sock;
+  int n;
+
+  CFGInit();
+
+  /* Prepared while idle, before the update starts. */
+  if (bench.prepare && (0 != IMGWRPrepare(bench.len)))
+    return -1;
+
+  NWPClear();
+  bench.start = HOSTUs;
+
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0)
+    return -1;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(bench.port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  start = BenchWallUs();
+
+  if ((0 == connect(sock, (struct sockaddr*) &addr, sizeof(addr)))
+      && (write(sock, req, strlen(req)) > 0) && (0 == IMGWRBegin(bench.len))) {
+    /* The header may come alone, or with the start of the body. */
+    n = BenchHeader(sock, buf, sizeof(buf));
+    if (n >= 0) {
+      do {
+        got += n;
+        if ((n > 0) && (0 != IMGWRWrite(buf, n)))
+          break;
+
+        n = recv(sock, buf, sizeof(buf), 0);
+      } while (n > 0);
+    }
+
+    if ((0 == n) && (got == bench.len))
+      RetVal = IMGWREnd(1);
+  }
+
+  close(sock);
+  bench.wallus = BenchWallUs() - start;
+
+  if (0 != RetVal) {
+    IMGWRAbort();
+    return -1;
+  }
+
+  IMGWRStats(&bench.stats);
+
+  PRCMSOCReset();
+  return -1;
+}
+
+/*
+ * The application on trial confirms itself.
+ */
+static int32_t BenchConfirm(void) {
+  CONFIRMImage();
+  return CONFIRMSync();
+}
+
+/*
+ * One update, from a device running the factory image.
+ */
+static int32_t BenchRun(const uint8_t *factory, uint32_t factorylen) {
+  nwpstats_t nwp;
+  uint64_t boot;
+  int32_t ret;
+  pid_t server;
+
+  HOSTPowerOn();
+  NWPFormat();
+  NWPPut("/sys/factory.bin", factory, factorylen);
+
+  if ((0 != HOSTRun(HOSTBoot, &ret)) || (IMG_FACTORY != ret)) {
+    printf("%-24s factory boot failed\n", bench.name);
+    return -1;
+  }
+
+  server = BenchServe();
+
+  ret = HOSTRun(BenchUpdate, &ret) ? 0 : -1;
+  if (0 != ret)
+    kill(server, SIGKILL);
+  waitpid(server, NULL, 0);
+  NWPStats(&nwp);
+
+  if ((0 != ret) || (PRCM_SOC_RESET != HOSTResetCause)) {
+    printf("%-24s update failed\n", bench.name);
+    return -1;
+  }
+
+  boot = HOSTUs;
+  if ((0 != HOSTRun(HOSTBoot, &ret)) || (IMG_CUSTOM != ret)) {
+    printf("%-24s trial boot failed\n", bench.name);
+    return -1;
+  }
+
+  boot = HOSTUs - boot;
+  if ((0 != HOSTRun(BenchConfirm, &ret)) || (0 != ret)) {
+    printf("%-24s confirmation failed\n", bench.name);
+    return -1;
+  }
+
+  printf("%-24s %-8s %7u %6u %6u %9.1f %8.1f %8.1f %8.1f %9.1f %9.1f\n",
+      bench.name, bench.prepare ? "prepared" : "demand", bench.stats.bytes,
+      bench.stats.writes, nwp.writes,
+      (bench.stats.bytes * 32768.0) / (bench.stats.ticks ? bench.stats.ticks : 1)
+          / 1024, bench.stats.firstticks / 32.768, bench.stats.ticks / 32.768,
+      boot / 1e3, (HOSTUs - bench.start) / 1e3, bench.len / bench.wallus);
+
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  uint8_t *factory;
+  uint32_t factorylen;
+  int32_t RetVal = 0;
+  int i;
+
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s factory.bin image.bin...\n", argv[0]);
+    return 2;
+  }
+
+  HOSTInit();
+
+  factory = BenchLoad(argv[1], &factorylen);
+  if (NULL == factory) {
+    perror(argv[1]);
+    return 2;
+  }
+
+  printf("%-24s %-8s %7s %6s %6s %9s %8s %8s %8s %9s %9s\n", "image", "slot",
+      "bytes", "writes", "nwp", "KB/s", "first", "write", "boot",
+      "confirmed", "loop MB/s");
+
+  for (i = 2; i < argc; i++) {
+    bench.name = argv[i];
+    bench.data = BenchLoad(argv[i], &bench.len);
+    if (NULL == bench.data) {
+      perror(argv[i]);
+      return 2;
+    }
+
+    for (bench.prepare = 0; bench.prepare < 2; bench.prepare++)
+      RetVal |= BenchRun(factory, factorylen);
+
+    free(bench.data);
+  }
+
+  printf("(times in ms of the simulated NWP, nwp = all flash writes)\n");
+
+  return RetVal ? 1 : 0;
+}
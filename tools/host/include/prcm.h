@@ -0,0 +1,2 @@
+/* Host stand-in of the SDK prcm.h, see sdk.h. */
+#include "sdk.h"
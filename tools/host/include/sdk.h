@@ -0,0 +1,219 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SDK_H_
+#define _SDK_H_
+
+/*!
+ *	\file sdk.h
+ *	\brief Host stand-in of the CC3200 SDK.
+ *	Only what the boot modules use: the driverlib calls (hw.c), the
+ *	SimpleLink file system, sockets and driver hooks (nwp.c). The other SDK
+ *	headers of this directory just include this one. The ROM (MAP_) calls are
+ *	the plain functions.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* hw_types.h */
+#define HWREG(x)	(*((volatile unsigned long *)(x)))
+typedef bool tBoolean;
+
+/* hw_memmap.h */
+#define WDT_BASE	0x40000000
+
+/* hw_ints.h */
+#define INT_NWPIC	187
+
+/* prcm.h */
+#define PRCM_RUN_MODE_CLK	0x00000001
+#define PRCM_WDT	0x0000000B
+#define PRCM_POWER_ON	0x00000000
+#define PRCM_LPDS_EXIT	0x00000001
+#define PRCM_CORE_RESET	0x00000003
+#define PRCM_MCU_RESET	0x00000004
+#define PRCM_WDT_RESET	0x00000005
+#define PRCM_SOC_RESET	0x00000006
+#define PRCM_HIB_EXIT	0x00000007
+#define PRCM_HIB_SLOW_CLK_CTR	0x00000004
+
+void PRCMPeripheralClkEnable(unsigned long ulPeripheral,
+    unsigned long ulClkFlags);
+void PRCMPeripheralReset(unsigned long ulPeripheral);
+unsigned long PRCMSysResetCauseGet(void);
+void PRCMSOCReset(void);
+unsigned long long PRCMSlowClkCtrGet(void);
+void PRCMOCRRegisterWrite(unsigned char ucIndex, unsigned long ulRegValue);
+unsigned long PRCMOCRRegisterRead(unsigned char ucIndex);
+void PRCMHibernateIntervalSet(unsigned long long ullTicks);
+void PRCMHibernateWakeupSourceEnable(unsigned long ulHIBWakupSrc);
+void PRCMHibernateEnter(void);
+
+/* wdt.h */
+void WatchdogUnlock(unsigned long ulBase);
+void WatchdogStallEnable(unsigned long ulBase);
+void WatchdogIntClear(unsigned long ulBase);
+void WatchdogReloadSet(unsigned long ulBase, unsigned long ulLoadVal);
+void WatchdogEnable(unsigned long ulBase);
+
+/* interrupt.h */
+void IntDisable(unsigned long ulInterrupt);
+void IntPendClear(unsigned long ulInterrupt);
+
+/* rom_map.h */
+#define MAP_PRCMPeripheralClkEnable	PRCMPeripheralClkEnable
+#define MAP_PRCMPeripheralReset	PRCMPeripheralReset
+#define MAP_PRCMSysResetCauseGet	PRCMSysResetCauseGet
+#define MAP_PRCMSOCReset	PRCMSOCReset
+#define MAP_PRCMSlowClkCtrGet	PRCMSlowClkCtrGet
+#define MAP_PRCMOCRRegisterWrite	PRCMOCRRegisterWrite
+#define MAP_PRCMOCRRegisterRead	PRCMOCRRegisterRead
+#define MAP_PRCMHibernateIntervalSet	PRCMHibernateIntervalSet
+#define MAP_PRCMHibernateWakeupSourceEnable	PRCMHibernateWakeupSourceEnable
+#define MAP_PRCMHibernateEnter	PRCMHibernateEnter
+#define MAP_WatchdogUnlock	WatchdogUnlock
+#define MAP_WatchdogStallEnable	WatchdogStallEnable
+#define MAP_WatchdogIntClear	WatchdogIntClear
+#define MAP_WatchdogReloadSet	WatchdogReloadSet
+#define MAP_WatchdogEnable	WatchdogEnable
+#define MAP_IntDisable	IntDisable
+#define MAP_IntPendClear	IntPendClear
+
+/* simplelink.h */
+typedef int8_t _i8;
+typedef uint8_t _u8;
+typedef int16_t _i16;
+typedef uint16_t _u16;
+typedef int32_t _i32;
+typedef uint32_t _u32;
+
+_i16 sl_Start(const void *pIfHdl, _i8 *pDevName, const void *pInitCallBack);
+_i16 sl_Stop(const _u16 timeout);
+void _SlNonOsMainLoopTask(void);
+void NwpPowerOn(void);
+void NwpPowerOff(void);
+
+/* fs.h */
+#define FS_MODE_OPEN_READ	0
+#define FS_MODE_OPEN_WRITE	1
+/* Max size in bytes (up to 8MB) and access flags, not the SDK encoding. */
+#define FS_MODE_OPEN_CREATE(maxSizeInBytes, accessModeFlags) \
+    (0x80000000u | ((_u32) (maxSizeInBytes) << 8) | (accessModeFlags))
+#define _FS_FILE_OPEN_FLAG_COMMIT	0x01
+#define _FS_FILE_OPEN_FLAG_SECURE	0x02
+#define _FS_FILE_OPEN_FLAG_NO_SIGNATURE_TEST	0x04
+#define _FS_FILE_OPEN_FLAG_STATIC	0x08
+#define _FS_FILE_OPEN_FLAG_VENDOR	0x10
+#define _FS_FILE_PUBLIC_WRITE	0x20
+#define _FS_FILE_PUBLIC_READ	0x40
+
+typedef struct {
+  _u16 flags;
+  _u32 FileLen;
+  _u32 AllocatedLen;
+  _u32 Token[4];
+} SlFsFileInfo_t;
+
+_i32 sl_FsOpen(const _u8 *pFileName, const _u32 AccessModeAndMaxSize,
+    _u32 *pToken, _i32 *pFileHandle);
+_i16 sl_FsClose(const _i32 FileHdl, const _u8 *pCeritificateFileName,
+    const _u8 *pSignature, const _u32 SignatureLen);
+_i32 sl_FsRead(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len);
+_i32 sl_FsWrite(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len);
+_i16 sl_FsGetInfo(const _u8 *pFileName, const _u32 Token,
+    SlFsFileInfo_t *pFsFileInfo);
+_i16 sl_FsDel(const _u8 *pFileName, const _u32 Token);
+
+/* wlan.h and netapp.h */
+#define SL_WLAN_CONNECT_EVENT	1
+#define SL_WLAN_DISCONNECT_EVENT	2
+#define SL_NETAPP_IPV4_IPACQUIRED_EVENT	1
+
+typedef struct {
+  _u32 Event;
+} SlWlanEvent_t;
+
+typedef struct {
+  _u32 Event;
+  union {
+    struct {
+      _u32 ip;
+      _u32 gateway;
+    } ipAcquiredV4;
+  } EventData;
+} SlNetAppEvent_t;
+
+/* socket.h */
+#define SL_AF_INET	2
+#define SL_SOCK_STREAM	1
+#define SL_IPPROTO_TCP	6
+#define SL_SOL_SOCKET	1
+#define SL_SO_RCVTIMEO	20
+#define sl_Htons(x)	(x)
+#define sl_Htonl(x)	(x)
+
+typedef struct {
+  _u16 sa_family;
+  _u8 sa_data[14];
+} SlSockAddr_t;
+
+typedef struct {
+  _u16 sin_family;
+  _u16 sin_port;
+  struct {
+    _u32 s_addr;
+  } sin_addr;
+  _i8 sin_zero[8];
+} SlSockAddrIn_t;
+
+typedef struct SlTimeval_t {
+  _i32 tv_sec;
+  _i32 tv_usec;
+} SlTimeval_t;
+
+_i16 sl_Socket(_i16 Domain, _i16 Type, _i16 Protocol);
+_i16 sl_Close(_i16 sd);
+_i16 sl_Connect(_i16 sd, const SlSockAddr_t *addr, _i16 addrlen);
+_i16 sl_Send(_i16 sd, const void *pBuf, _i16 Len, _i16 flags);
+_i16 sl_Recv(_i16 sd, void *pBuf, _i16 Len, _i16 flags);
+_i16 sl_SetSockOpt(_i16 sd, _i16 level, _i16 optname, const void *optval,
+    _u16 optlen);
+
+/* source/driver.h */
+typedef struct {
+  struct {
+    _u8 ActionIndex;
+  } AsyncExt;
+} _SlFunctionParams_t;
+
+typedef struct {
+  _SlFunctionParams_t FunctionParams;
+} _SlDriverCb_t;
+
+extern _SlDriverCb_t *g_pCB;
+void _SlDrvReleasePoolObj(_u8 pObj);
+
+#endif
@@ -0,0 +1,2 @@
+/* Host stand-in of the SDK wdt.h, see sdk.h. */
+#include "sdk.h"
@@ -0,0 +1,288 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file kvbench.c
+ *
+ * 	\brief KV store (kv.h) against one file per setting, as boot.cfg.
+ *
+ * 	The settings of an application are kept either each in its own file,
+ * 	written the way BOOTWriteCfg writes boot.cfg (open for writing or
+ * 	create, write, close) and read with an open, a read and a close, or in
+ * 	the KV store, synced after each change or after a batch of KV_BATCH
+ * 	changes. boot.cfg itself, with BOOTWriteCfg and BOOTReadCfg, is set
+ * 	against a bootinfo_t kept in the store.
+ *
+ * 	For each, the simulated time to load all the settings, to get one and
+ * 	to commit a change, and what a change costs the flash: the bytes
+ * 	written per byte of value changed and the blocks erased. Every open
+ * 	for writing erases the file (NWPWriteErase).
+ *
+ * 	Usage: kvbench
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "simplelink.h"
+#include "boot.h"
+#include "kv.h"
+#include "host.h"
+
+/*! Changes made by each run. */
+#define KV_CHANGES	64
+
+/*! Changes between two KVSync calls of the batched run. */
+#define KV_BATCH	8
+
+/*! Size of the file of a setting, as boot.cfg. */
+#define KV_SETTING_FILE	512
+
+/*! Settings of the application. */
+static struct {
+  const char *key;
+  uint32_t len;
+} settings[] = { { "interval", 4 }, { "server", 32 }, { "port", 2 }, {
+    "ssid", 32 }, { "passphrase", 64 }, { "tz", 4 }, { "led", 1 }, { "calib",
+    24 } };
+
+#define KV_SETTINGS	(sizeof(settings) / sizeof(settings[0]))
+
+/*! Costs of a run. */
+typedef struct {
+  double load;
+  double get;
+  double put;
+  uint32_t value;
+  nwpstats_t nwp;
+} kvcost_t;
+
+/*
+ * Value of a setting for a change.
+ */
+static void BenchValue(uint32_t change, uint8_t *value, uint32_t len) {
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+    value[i] = (uint8_t) (change * 13 + i);
+}
+
+/*
+ * File of a setting.
+ */
+static const _u8* BenchFile(uint32_t setting) {
+  static char name[32];
+
+  snprintf(name, sizeof(name), "/app/%s", settings[setting].key);
+  return (const _u8*) name;
+}
+
+/*
+ * Write a setting to its file, as BOOTWriteCfg.
+ */
+static int32_t BenchFilePut(uint32_t setting, uint8_t *value) {
+  int32_t RetVal;
+  int32_t hFile;
+
+  RetVal = sl_FsOpen(BenchFile(setting), FS_MODE_OPEN_WRITE, NULL, &hFile);
+  if (0 != RetVal) {
+    RetVal = sl_FsOpen(BenchFile(setting),
+        FS_MODE_OPEN_CREATE(KV_SETTING_FILE, _FS_FILE_PUBLIC_WRITE |
+            _FS_FILE_PUBLIC_READ), NULL, &hFile);
+    if (0 != RetVal)
+      return -1;
+  }
+
+  RetVal = sl_FsWrite(hFile, 0, value, settings[setting].len);
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  return (0 > RetVal) ? -1 : 0;
+}
+
+static int32_t BenchFileGet(uint32_t setting, uint8_t *value) {
+  int32_t RetVal;
+  int32_t hFile;
+
+  RetVal = sl_FsOpen(BenchFile(setting), FS_MODE_OPEN_READ, NULL, &hFile);
+  if (0 != RetVal)
+    return -1;
+
+  RetVal = sl_FsRead(hFile, 0, value, settings[setting].len);
+  sl_FsClose(hFile, NULL, NULL, 0);
+
+  return (0 > RetVal) ? -1 : 0;
+}
+
+/*
+ * Settings in files, or in the store with a KVSync every batch changes.
+ */
+static void BenchSettings(uint32_t batch, kvcost_t *cost) {
+  uint8_t value[64];
+  uint64_t start;
+  uint32_t change;
+  uint32_t i;
+
+  BOOTClose();
+  NWPFormat();
+  memset(cost, 0, sizeof(kvcost_t));
+
+  /* First values, not counted. */
+  if (batch)
+    KVOpen();
+
+  for (i = 0; i < KV_SETTINGS; i++) {
+    BenchValue(0, value, settings[i].len);
+    if (batch)
+      KVPut(settings[i].key, value, settings[i].len);
+    else
+      BenchFilePut(i, value);
+  }
+
+  if (batch)
+    KVSync();
+
+  /* Load at start up. */
+  start = HOSTUs;
+  if (batch)
+    KVOpen();
+  else
+    for (i = 0; i < KV_SETTINGS; i++)
+      BenchFileGet(i, value);
+  cost->load = HOSTUs - start;
+
+  start = HOSTUs;
+  for (i = 0; i < KV_SETTINGS; i++) {
+    if (batch)
+      KVGet(settings[i].key, value, sizeof(value));
+    else
+      BenchFileGet(i, value);
+  }
+  cost->get = (double) (HOSTUs - start) / KV_SETTINGS;
+
+  NWPClear();
+  start = HOSTUs;
+  for (change = 1; change <= KV_CHANGES; change++) {
+    i = change % KV_SETTINGS;
+    BenchValue(change, value, settings[i].len);
+    cost->value += settings[i].len;
+
+    if (!batch)
+      BenchFilePut(i, value);
+    else {
+      KVPut(settings[i].key, value, settings[i].len);
+      if (0 == change % batch)
+        KVSync();
+    }
+  }
+  cost->put = (double) (HOSTUs - start) / KV_CHANGES;
+  NWPStats(&cost->nwp);
+}
+
+/*
+ * boot.cfg, or a bootinfo_t in the store synced after each change.
+ */
+static void BenchBootCfg(int32_t kv, kvcost_t *cost) {
+  bootinfo_t bootinfo;
+  uint64_t start;
+  uint32_t change;
+
+  BOOTClose();
+  NWPFormat();
+  memset(cost, 0, sizeof(kvcost_t));
+  memset(&bootinfo, 0, sizeof(bootinfo));
+
+  if (kv) {
+    KVOpen();
+    KVPut("boot.cfg", &bootinfo, sizeof(bootinfo));
+    KVSync();
+  } else
+    BOOTWriteCfg(&bootinfo);
+
+  BOOTClose();
+  start = HOSTUs;
+  if (kv)
+    KVOpen();
+  else
+    BOOTReadCfg(&bootinfo);
+  cost->load = HOSTUs - start;
+
+  start = HOSTUs;
+  if (kv)
+    KVGet("boot.cfg", &bootinfo, sizeof(bootinfo));
+  else
+    BOOTReadCfg(&bootinfo);
+  cost->get = HOSTUs - start;
+
+  NWPClear();
+  start = HOSTUs;
+  for (change = 1; change <= KV_CHANGES; change++) {
+    bootinfo.status = change % 3;
+    bootinfo.trialid = change;
+    cost->value += sizeof(bootinfo);
+
+    if (kv) {
+      KVPut("boot.cfg", &bootinfo, sizeof(bootinfo));
+      KVSync();
+    } else
+      BOOTWriteCfg(&bootinfo);
+  }
+  cost->put = (double) (HOSTUs - start) / KV_CHANGES;
+  NWPStats(&cost->nwp);
+}
+
+static void BenchPrint(const char *what, kvcost_t *cost) {
+  printf("%-28s %9.1f %9.1f %9.1f %7.2f %7.2f\n", what, cost->load / 1000,
+      cost->get / 1000, cost->put / 1000,
+      (double) cost->nwp.writebytes / cost->value,
+      (double) cost->nwp.erases / KV_CHANGES);
+}
+
+int main() {
+  kvcost_t cost;
+  char what[40];
+
+  HOSTInit();
+  NWPWriteErase(1);
+
+  printf("%u changes, %u settings\n", KV_CHANGES, (uint32_t) KV_SETTINGS);
+  printf("%-28s %9s %9s %9s %7s %7s\n", "", "load ms", "get ms", "change ms",
+      "written", "erases");
+
+  BenchSettings(0, &cost);
+  BenchPrint("a file per setting", &cost);
+
+  BenchSettings(1, &cost);
+  BenchPrint("KV, sync every change", &cost);
+
+  BenchSettings(KV_BATCH, &cost);
+  snprintf(what, sizeof(what), "KV, sync every %u changes", KV_BATCH);
+  BenchPrint(what, &cost);
+
+  BenchBootCfg(0, &cost);
+  BenchPrint("boot.cfg, BOOTWriteCfg", &cost);
+
+  BenchBootCfg(1, &cost);
+  BenchPrint("bootinfo_t in KV", &cost);
+
+  return 0;
+}
@@ -0,0 +1,356 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file netboottest.c
+ *
+ * 	\brief Network boot client (netboot.h) against a loopback server.
+ *
+ * 	NETBOOTFetch runs on the socket stand-in of nwp.c, connected to a
+ * 	server forked for each case that checks the request and answers with
+ * 	scripted chunks. The file must arrive whole with any read size
+ * 	(NWPRecvMax, down to a length split across reads), and a chunk larger
+ * 	than the space left, a server closing before the last chunk or a
+ * 	silent server must fail the fetch without writing past the space given.
+ * 	Then a whole image is fetched and prepared with NETBOOTLoad.
+ *
+ * 	Usage: netboottest
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "simplelink.h"
+#include "boot.h"
+#include "cksum.h"
+#include "netboot.h"
+#include "host.h"
+
+/*! Space given to NETBOOTFetch. */
+#define TEST_MAXLEN	4096
+
+/*! Where the file is fetched, with a guard past TEST_MAXLEN. */
+#define TEST_ADDR	BASE_ADDR
+#define TEST_GUARD	0xA5
+
+/*! Largest scripted answer. */
+#define TEST_SCRIPT	65536
+
+static int32_t failures;
+
+/*! Answer of the server. */
+static struct {
+  uint8_t data[TEST_SCRIPT];
+  uint32_t len;
+  /* Bytes sent before closing, less than len to close early. */
+  uint32_t cut;
+  /* Set for a server that never answers. */
+  int32_t silent;
+  uint16_t port;
+} script;
+
+/*! Contents of the files served. */
+static uint8_t file[TEST_SCRIPT];
+
+static void TestExpect(const char *what, int32_t ok) {
+  printf("%-56s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+/*
+ * Append a chunk of len bytes, its data from the file at offset.
+ */
+static void TestChunk(uint32_t len, uint32_t offset) {
+  memcpy(script.data + script.len, &len, sizeof(len));
+  script.len += sizeof(len);
+
+  if (len && (offset + len <= sizeof(file))) {
+    memcpy(script.data + script.len, file + offset, len);
+    script.len += len;
+  }
+}
+
+/*
+ * The file of len bytes in chunks of size bytes, then the end chunk.
+ */
+static void TestScript(uint32_t len, uint32_t size) {
+  uint32_t offset;
+  uint32_t n;
+
+  memset(&script, 0, sizeof(script));
+
+  for (offset = 0; offset < len; offset += n) {
+    n = (len - offset < size) ? len - offset : size;
+    TestChunk(n, offset);
+  }
+
+  TestChunk(0, 0);
+  script.cut = script.len;
+}
+
+/*
+ * Serve the script once from a child process. It exits with 0 if the
+ * request was NETBOOT_MAGIC.
+ */
+static pid_t TestServe(void) {
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof(addr);
+  uint32_t magic = 0;
+  int srv;
+  int con;
+  pid_t pid;
+
+  srv = socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if ((srv < 0) || bind(srv, (struct sockaddr*) &addr, sizeof(addr))
+      || listen(srv, 1)
+      || getsockname(srv, (struct sockaddr*) &addr, &addrlen)) {
+    perror("loopback server");
+    exit(2);
+  }
+
+  script.port = ntohs(addr.sin_port);
+
+  pid = fork();
+  if (0 != pid) {
+    close(srv);
+    return pid;
+  }
+
+  con = accept(srv, NULL, NULL);
+  if ((con < 0) || (sizeof(magic) != recv(con, &magic, sizeof(magic),
+      MSG_WAITALL)))
+    _exit(1);
+
+  if (script.silent)
+    sleep(NETBOOT_RECV_MS / 1000 + 2);
+  else if (script.cut != write(con, script.data, script.cut))
+    _exit(1);
+
+  close(con);
+  _exit(NETBOOT_MAGIC == magic ? 0 : 1);
+}
+
+/*
+ * Fetch from the server. Returns the result of NETBOOTFetch, *request is
+ * set if the server got NETBOOT_MAGIC.
+ */
+static int32_t TestFetch(uint32_t maxlen, int32_t *request) {
+  int32_t RetVal;
+  int status;
+  pid_t pid;
+
+  memset((void*) TEST_ADDR, TEST_GUARD, TEST_SCRIPT);
+
+  pid = TestServe();
+  RetVal = NETBOOTFetch(INADDR_LOOPBACK, script.port, TEST_ADDR, maxlen);
+
+  if (script.silent)
+    kill(pid, SIGKILL);
+
+  waitpid(pid, &status, 0);
+  *request = WIFEXITED(status) && (0 == WEXITSTATUS(status));
+
+  return RetVal;
+}
+
+/*
+ * Nothing written from offset to the end of the guard.
+ */
+static int32_t TestUntouched(uint32_t offset) {
+  uint8_t *sram = (uint8_t*) TEST_ADDR;
+  uint32_t i;
+
+  for (i = offset; i < TEST_SCRIPT; i++) {
+    if (TEST_GUARD != sram[i])
+      return 0;
+  }
+
+  return 1;
+}
+
+/*
+ * Whole file of len bytes in chunks of size, read at most recvmax at once.
+ */
+static void TestWhole(uint32_t len, uint32_t size, uint32_t recvmax) {
+  char what[80];
+  int32_t request;
+  int32_t RetVal;
+
+  TestScript(len, size);
+  NWPRecvMax(recvmax);
+  RetVal = TestFetch(TEST_MAXLEN, &request);
+  NWPRecvMax(0);
+
+  if (recvmax)
+    snprintf(what, sizeof(what), "%u bytes in %u byte chunks, %u byte reads",
+        len, size, recvmax);
+  else
+    snprintf(what, sizeof(what), "%u bytes in %u byte chunks", len, size);
+
+  TestExpect(what, request && ((int32_t) len == RetVal)
+      && (0 == memcmp((void*) TEST_ADDR, file, len)) && TestUntouched(len));
+}
+
+/*
+ * A fetch that must fail, the first good bytes written at most.
+ */
+static void TestFail(const char *what, uint32_t good) {
+  int32_t request;
+  int32_t RetVal;
+
+  RetVal = TestFetch(TEST_MAXLEN, &request);
+  TestExpect(what, (0 > RetVal) && TestUntouched(good));
+}
+
+/*
+ * An image file linked at BASE_ADDR, fetched and prepared.
+ */
+static void TestLoad(void) {
+  imghdr_t hdr;
+  uint32_t adler;
+  uint32_t imglen = 8192;
+  uint32_t len = sizeof(imghdr_t) + imglen;
+  uint8_t *payload = file + sizeof(imghdr_t);
+  int32_t RetVal;
+  int status;
+  pid_t pid;
+
+  memset(&hdr, 0, sizeof(imghdr_t));
+  hdr.magic = IMG_MAGIC;
+  hdr.hdrlen = sizeof(imghdr_t);
+  hdr.linkaddr = BASE_ADDR;
+  hdr.imglen = imglen;
+  hdr.memlen = imglen;
+  hdr.digestalg = IMG_DIGEST_ADLER32;
+
+  adler = CKSUMAdler32(CKSUM_ADLER_INIT, payload, imglen);
+  memcpy(hdr.digest, &adler, sizeof(uint32_t));
+  memcpy(file, &hdr, sizeof(imghdr_t));
+
+  TestScript(len, 1460);
+  pid = TestServe();
+  RetVal = NETBOOTLoad(INADDR_LOOPBACK, script.port);
+  waitpid(pid, &status, 0);
+
+  TestExpect("image fetched and loaded by NETBOOTLoad", (0 == RetVal)
+      && (0 == memcmp((void*) BASE_ADDR, payload, imglen))
+      && (BASE_ADDR == HANDOFF->base));
+
+  file[sizeof(imghdr_t)] ^= 1;
+  TestScript(len, 1460);
+  pid = TestServe();
+  RetVal = NETBOOTLoad(INADDR_LOOPBACK, script.port);
+  waitpid(pid, &status, 0);
+  file[sizeof(imghdr_t)] ^= 1;
+
+  TestExpect("image with a bad digest refused by NETBOOTLoad", 0 != RetVal);
+}
+
+int main() {
+  SlNetAppEvent_t event;
+  uint32_t len;
+  uint32_t i;
+
+  HOSTInit();
+
+  for (i = 0; i < sizeof(file); i++)
+    file[i] = (uint8_t) (i * 13 + 7);
+
+  /* The access point is there. */
+  memset(&event, 0, sizeof(event));
+  event.Event = SL_NETAPP_IPV4_IPACQUIRED_EVENT;
+  NETBOOTNetAppEvent(&event);
+
+  TestWhole(3000, 1000, 0);
+  TestWhole(3001, 1000, 0);
+  TestWhole(TEST_MAXLEN, 1460, 0);
+  TestWhole(3001, 1000, 100);
+  TestWhole(3001, 1000, 3);
+  TestWhole(3001, 7, 1);
+  TestWhole(0, 1000, 0);
+
+  /* A chunk past the space, after a good one, and a huge one. */
+  memset(&script, 0, sizeof(script));
+  TestChunk(1000, 0);
+  TestChunk(TEST_MAXLEN, 1000);
+  TestChunk(0, 0);
+  script.cut = script.len;
+  TestFail("chunk larger than the space left refused", 1000);
+
+  memset(&script, 0, sizeof(script));
+  TestChunk(1000, 0);
+  TestChunk(0xFFFFFFFF, 0);
+  script.cut = script.len;
+  TestFail("chunk of 0xFFFFFFFF bytes refused", 1000);
+
+  /* The space is exactly filled, one more byte is too much. */
+  memset(&script, 0, sizeof(script));
+  TestChunk(TEST_MAXLEN, 0);
+  TestChunk(1, TEST_MAXLEN);
+  TestChunk(0, 0);
+  script.cut = script.len;
+  TestFail("byte past a full space refused", TEST_MAXLEN);
+
+  /* The server closes early. */
+  TestScript(3000, 1000);
+  len = script.len;
+
+  script.cut = 0;
+  TestFail("server closed before the first chunk", 0);
+
+  script.cut = 2;
+  TestFail("server closed inside a chunk length", 0);
+
+  script.cut = sizeof(uint32_t) + 500;
+  TestFail("server closed inside the chunk data", 500);
+
+  script.cut = len - sizeof(uint32_t);
+  TestFail("server closed before the end chunk", 3000);
+
+  NWPRecvMax(3);
+  script.cut = len - 2;
+  TestFail("server closed inside the end chunk, short reads", 3000);
+  NWPRecvMax(0);
+
+  TestScript(3000, 1000);
+  script.silent = 1;
+  TestFail("silent server: receive timeout", 0);
+
+  TestLoad();
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
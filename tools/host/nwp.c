@@ -0,0 +1,596 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file nwp.c
+ *
+ * 	\brief Host stand-in of the SimpleLink NWP.
+ *
+ * 	This file implements an in-memory file system with the SimpleLink rules
+ * 	the boot modules depend on: the maximum size is fixed when the file is
+ * 	created, opening for write discards the contents and the new contents
+ * 	are only seen after sl_FsClose. The handles survive a reset of the SOC,
+ * 	like the statics of the boot modules that keep them (the boot.cfg
+ * 	handle); with NWPTorn the reset leaves a file being written empty,
+ * 	unless it was created fail-safe (_FS_FILE_OPEN_FLAG_COMMIT). Every call
+ * 	costs simulated time (NWP_*_US, NWP_*_NS), rough CC3200 serial flash
+ * 	figures; measure the board and override them with -D for real
+ * 	predictions. Secure files (_FS_FILE_OPEN_FLAG_SECURE or NWPSecure) add
+ * 	NWP_SECURE_OPEN_US to each open and NWP_SECURE_NS to each byte, and
+ * 	fail-safe files erase twice their blocks. With NWPWriteErase, opening a
+ * 	file for writing erases its blocks again, as the serial flash must.
+ * 	The sockets are host sockets, so a loopback server stands in for the
+ * 	network; NWPRecvMax makes sl_Recv return short reads.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "sdk.h"
+#include "host.h"
+
+#ifndef NWP_START_US
+/*! Time of sl_Start. */
+#define NWP_START_US	100000
+#endif
+
+#ifndef NWP_STOP_US
+/*! Time of sl_Stop. */
+#define NWP_STOP_US	10000
+#endif
+
+#ifndef NWP_OPEN_US
+/*! Time of sl_FsOpen, sl_FsGetInfo and sl_FsDel. */
+#define NWP_OPEN_US	5000
+#endif
+
+#ifndef NWP_CALL_US
+/*! Time of any other file call, on top of the bytes. */
+#define NWP_CALL_US	100
+#endif
+
+#ifndef NWP_ERASE_US
+/*! Time to erase a block, when a file is created. */
+#define NWP_ERASE_US	45000
+#endif
+
+#ifndef NWP_READ_NS
+/*! Read time per byte (mkimg.py --read-ns). */
+#define NWP_READ_NS	1000
+#endif
+
+#ifndef NWP_WRITE_NS
+/*! Write time per byte. */
+#define NWP_WRITE_NS	2500
+#endif
+
+#ifndef NWP_SECURE_OPEN_US
+/*! Extra time to open a secure file. */
+#define NWP_SECURE_OPEN_US	20000
+#endif
+
+#ifndef NWP_SECURE_NS
+/*! Extra time per byte of a secure file, encrypted or decrypted. */
+#define NWP_SECURE_NS	400
+#endif
+
+#ifndef NWP_STALL_US
+/*! Time of a stalled call (NWPStall), an hour. */
+#define NWP_STALL_US	3600000000ull
+#endif
+
+/*! Flash block size. */
+#define NWP_BLOCK	4096
+
+/*! Number of files. */
+#define NWP_FILES	32
+
+/*! Number of open files. */
+#define NWP_HANDLES	8
+
+/*! SimpleLink errors used by the stand-in. */
+#define NWP_ERR_NOT_FOUND	(-11)
+#define NWP_ERR_NO_HANDLE	(-12)
+#define NWP_ERR_NO_SPACE	(-13)
+#define NWP_ERR_BAD_HANDLE	(-14)
+#define NWP_ERR_SOCKET	(-1)
+#define NWP_ERR_EAGAIN	(-11)
+
+/*! A file, with the contents being written apart. */
+typedef struct {
+  char name[64];
+  uint8_t *data;
+  uint8_t *shadow;
+  uint32_t len;
+  uint32_t slen;
+  uint32_t max;
+  uint32_t failsafe;
+  uint32_t secure;
+} nwpfile_t;
+
+static nwpfile_t files[NWP_FILES];
+
+static struct {
+  nwpfile_t *file;
+  int32_t write;
+} handles[NWP_HANDLES];
+
+static nwpstats_t stats;
+
+/*! Calls left until the stalled one. */
+static uint32_t stall;
+
+/*! Calls left until the one that resets the SOC, and the reset cause. */
+static uint32_t resetat;
+static unsigned long resetcause;
+
+/*! Set when a reset empties the files being written. */
+static int32_t torn;
+
+/*! Erase on every open for writing, see NWPWriteErase. */
+static int32_t writeerase;
+
+/*! Largest sl_Recv, 0 for any. */
+static uint32_t recvmax;
+
+static _SlDriverCb_t driver;
+_SlDriverCb_t *g_pCB = &driver;
+
+/*
+ * Find a file by name.
+ */
+static nwpfile_t *NWPFind(const _u8 *name) {
+  uint32_t i;
+
+  for (i = 0; i < NWP_FILES; i++) {
+    if (files[i].data && (0 == strcmp(files[i].name, (const char*) name)))
+      return &files[i];
+  }
+
+  return NULL;
+}
+
+/*
+ * Take a free entry for a new file.
+ */
+static nwpfile_t *NWPCreate(const _u8 *name, uint32_t max) {
+  uint32_t i;
+
+  for (i = 0; i < NWP_FILES; i++) {
+    if (NULL == files[i].data) {
+      strncpy(files[i].name, (const char*) name, sizeof(files[i].name) - 1);
+      files[i].data = calloc(1, max ? max : 1);
+      files[i].shadow = malloc(max ? max : 1);
+      files[i].len = 0;
+      files[i].max = max;
+      return &files[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void NWPFree(nwpfile_t *file) {
+  free(file->data);
+  free(file->shadow);
+  memset(file, 0, sizeof(nwpfile_t));
+}
+
+static nwpfile_t *NWPHandle(_i32 hdl) {
+  if ((hdl < 0) || (hdl >= NWP_HANDLES))
+    return NULL;
+
+  return handles[hdl].file;
+}
+
+/*
+ * Count a call and take its time, or stall.
+ */
+static void NWPCall(uint64_t us) {
+  stats.calls++;
+
+  if (resetat && (0 == --resetat))
+    HOSTReset(resetcause);
+
+  if (stall && (0 == --stall))
+    us = NWP_STALL_US;
+
+  HOSTDelay(us);
+}
+
+/*
+ * Time per byte of a file, ns for a plain one.
+ */
+static uint32_t NWPByteNs(const nwpfile_t *file, uint32_t ns) {
+  return file->secure ? ns + NWP_SECURE_NS : ns;
+}
+
+void NWPFormat() {
+  uint32_t i;
+
+  for (i = 0; i < NWP_FILES; i++) {
+    if (files[i].data)
+      NWPFree(&files[i]);
+  }
+
+  memset(handles, 0, sizeof(handles));
+  NWPClear();
+}
+
+int32_t NWPPut(const char *name, const void *data, uint32_t len) {
+  nwpfile_t *file = NWPFind((const _u8*) name);
+
+  if (file)
+    NWPFree(file);
+
+  file = NWPCreate((const _u8*) name, len);
+  if (NULL == file)
+    return -1;
+
+  memcpy(file->data, data, len);
+  file->len = len;
+
+  return 0;
+}
+
+void NWPStats(nwpstats_t *nwpstats) {
+  memcpy(nwpstats, &stats, sizeof(nwpstats_t));
+}
+
+void NWPClear() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void NWPStall(uint32_t call) {
+  stall = call;
+}
+
+int32_t NWPSecure(const char *name) {
+  nwpfile_t *file = NWPFind((const _u8*) name);
+
+  if (NULL == file)
+    return -1;
+
+  file->secure = 1;
+  return 0;
+}
+
+void NWPResetAt(uint32_t call, unsigned long cause) {
+  resetat = call;
+  resetcause = cause;
+}
+
+void NWPTorn(int32_t on) {
+  torn = on;
+}
+
+void NWPWriteErase(int32_t on) {
+  writeerase = on;
+}
+
+void NWPRecvMax(uint32_t max) {
+  recvmax = max;
+}
+
+/*
+ * The writes cut by the reset, with NWPTorn.
+ */
+void NWPReset() {
+  _i32 i;
+
+  for (i = 0; torn && (i < NWP_HANDLES); i++) {
+    if (handles[i].file && handles[i].write && !handles[i].file->failsafe) {
+      memset(handles[i].file->data, 0xFF, handles[i].file->max);
+      handles[i].file->len = 0;
+      handles[i].file = NULL;
+    }
+  }
+}
+
+_i16 sl_Start(const void *pIfHdl, _i8 *pDevName, const void *pInitCallBack) {
+  (void) pIfHdl;
+  (void) pDevName;
+  (void) pInitCallBack;
+
+  NWPCall(NWP_START_US);
+  return 0;
+}
+
+_i16 sl_Stop(const _u16 timeout) {
+  (void) timeout;
+
+  NWPCall(NWP_STOP_US);
+  return 0;
+}
+
+/*
+ * The erase of a new file is paid on its creation.
+ */
+_i32 sl_FsOpen(const _u8 *pFileName, const _u32 AccessModeAndMaxSize,
+    _u32 *pToken, _i32 *pFileHandle) {
+  nwpfile_t *file = NWPFind(pFileName);
+  uint32_t blocks;
+  uint32_t max;
+  _i32 i;
+
+  (void) pToken;
+
+  stats.opens++;
+  NWPCall(NWP_OPEN_US);
+
+  /* An existing file opened for writing is erased. */
+  if (writeerase && file && (FS_MODE_OPEN_READ != AccessModeAndMaxSize)) {
+    blocks = (file->max + NWP_BLOCK - 1) / NWP_BLOCK;
+    stats.erases += blocks;
+    HOSTDelay((uint64_t) NWP_ERASE_US * blocks);
+  }
+
+  if ((NULL == file) && (AccessModeAndMaxSize & 0x80000000u)) {
+    max = (AccessModeAndMaxSize >> 8) & 0x7FFFFF;
+    file = NWPCreate(pFileName, max);
+    if (NULL == file)
+      return NWP_ERR_NO_SPACE;
+
+    file->failsafe = AccessModeAndMaxSize & _FS_FILE_OPEN_FLAG_COMMIT;
+    file->secure = AccessModeAndMaxSize & _FS_FILE_OPEN_FLAG_SECURE;
+
+    /* A fail-safe file keeps two copies. */
+    blocks = (max + NWP_BLOCK - 1) / NWP_BLOCK;
+    if (file->failsafe)
+      blocks *= 2;
+
+    stats.erases += blocks;
+    HOSTDelay((uint64_t) NWP_ERASE_US * blocks);
+  }
+
+  if (NULL == file)
+    return NWP_ERR_NOT_FOUND;
+
+  if (file->secure) {
+    stats.secureopens++;
+    HOSTDelay(NWP_SECURE_OPEN_US);
+  }
+
+  for (i = 0; i < NWP_HANDLES; i++) {
+    if (NULL == handles[i].file) {
+      handles[i].file = file;
+      handles[i].write = (FS_MODE_OPEN_READ != AccessModeAndMaxSize);
+      if (handles[i].write) {
+        memset(file->shadow, 0xFF, file->max);
+        file->slen = 0;
+      }
+
+      *pFileHandle = i;
+      return 0;
+    }
+  }
+
+  return NWP_ERR_NO_HANDLE;
+}
+
+/*
+ * The written contents replace the old ones.
+ */
+_i16 sl_FsClose(const _i32 FileHdl, const _u8 *pCeritificateFileName,
+    const _u8 *pSignature, const _u32 SignatureLen) {
+  nwpfile_t *file = NWPHandle(FileHdl);
+
+  (void) pCeritificateFileName;
+  (void) pSignature;
+  (void) SignatureLen;
+
+  if (NULL == file)
+    return NWP_ERR_BAD_HANDLE;
+
+  NWPCall(NWP_CALL_US);
+
+  if (handles[FileHdl].write) {
+    memcpy(file->data, file->shadow, file->max);
+    file->len = file->slen;
+  }
+
+  handles[FileHdl].file = NULL;
+
+  return 0;
+}
+
+_i32 sl_FsRead(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len) {
+  nwpfile_t *file = NWPHandle(FileHdl);
+
+  if (NULL == file)
+    return NWP_ERR_BAD_HANDLE;
+
+  if (Offset >= file->len)
+    Len = 0;
+  else if (Len > file->len - Offset)
+    Len = file->len - Offset;
+
+  stats.reads++;
+  stats.readbytes += Len;
+  NWPCall(NWP_CALL_US + ((uint64_t) Len * NWPByteNs(file, NWP_READ_NS))
+      / 1000);
+
+  memcpy(pData, file->data + Offset, Len);
+
+  return Len;
+}
+
+_i32 sl_FsWrite(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len) {
+  nwpfile_t *file = NWPHandle(FileHdl);
+
+  if ((NULL == file) || !handles[FileHdl].write)
+    return NWP_ERR_BAD_HANDLE;
+
+  if ((Offset > file->max) || (Len > file->max - Offset))
+    return NWP_ERR_NO_SPACE;
+
+  stats.writes++;
+  stats.writebytes += Len;
+  NWPCall(NWP_CALL_US + ((uint64_t) Len * NWPByteNs(file, NWP_WRITE_NS))
+      / 1000);
+
+  memcpy(file->shadow + Offset, pData, Len);
+  if (Offset + Len > file->slen)
+    file->slen = Offset + Len;
+
+  return Len;
+}
+
+_i16 sl_FsGetInfo(const _u8 *pFileName, const _u32 Token,
+    SlFsFileInfo_t *pFsFileInfo) {
+  nwpfile_t *file = NWPFind(pFileName);
+
+  (void) Token;
+
+  NWPCall(NWP_OPEN_US);
+
+  if (NULL == file)
+    return NWP_ERR_NOT_FOUND;
+
+  memset(pFsFileInfo, 0, sizeof(SlFsFileInfo_t));
+  pFsFileInfo->FileLen = file->len;
+  pFsFileInfo->AllocatedLen = file->max;
+
+  return 0;
+}
+
+_i16 sl_FsDel(const _u8 *pFileName, const _u32 Token) {
+  nwpfile_t *file = NWPFind(pFileName);
+  _i32 i;
+
+  (void) Token;
+
+  NWPCall(NWP_OPEN_US);
+
+  if (NULL == file)
+    return NWP_ERR_NOT_FOUND;
+
+  for (i = 0; i < NWP_HANDLES; i++) {
+    if (file == handles[i].file)
+      handles[i].file = NULL;
+  }
+
+  NWPFree(file);
+
+  return 0;
+}
+
+void _SlNonOsMainLoopTask() {
+}
+
+void _SlDrvReleasePoolObj(_u8 pObj) {
+  (void) pObj;
+}
+
+void NwpPowerOn() {
+}
+
+void NwpPowerOff() {
+}
+
+/*
+ * A host socket, a timeout or a failure as the SimpleLink errors.
+ */
+static _i16 NWPSockErr(ssize_t RetVal) {
+  if (0 <= RetVal)
+    return (_i16) RetVal;
+
+  return (_i16) (((EAGAIN == errno) || (EWOULDBLOCK == errno)) ?
+      NWP_ERR_EAGAIN : NWP_ERR_SOCKET);
+}
+
+_i16 sl_Socket(_i16 Domain, _i16 Type, _i16 Protocol) {
+  NWPCall(NWP_CALL_US);
+
+  if ((SL_AF_INET != Domain) || (SL_SOCK_STREAM != Type))
+    return NWP_ERR_SOCKET;
+
+  (void) Protocol;
+  return NWPSockErr(socket(AF_INET, SOCK_STREAM, 0));
+}
+
+_i16 sl_Close(_i16 sd) {
+  NWPCall(NWP_CALL_US);
+  return NWPSockErr(close(sd));
+}
+
+/*
+ * sl_Htons and sl_Htonl are no-ops here, the address is in host order.
+ */
+_i16 sl_Connect(_i16 sd, const SlSockAddr_t *addr, _i16 addrlen) {
+  const SlSockAddrIn_t *in = (const SlSockAddrIn_t*) addr;
+  struct sockaddr_in host;
+
+  NWPCall(NWP_CALL_US);
+
+  if ((addrlen < (_i16) sizeof(SlSockAddrIn_t))
+      || (SL_AF_INET != in->sin_family))
+    return NWP_ERR_SOCKET;
+
+  memset(&host, 0, sizeof(host));
+  host.sin_family = AF_INET;
+  host.sin_port = htons(in->sin_port);
+  host.sin_addr.s_addr = htonl(in->sin_addr.s_addr);
+
+  return NWPSockErr(connect(sd, (struct sockaddr*) &host, sizeof(host)));
+}
+
+_i16 sl_Send(_i16 sd, const void *pBuf, _i16 Len, _i16 flags) {
+  (void) flags;
+
+  NWPCall(NWP_CALL_US);
+  return NWPSockErr(send(sd, pBuf, Len, MSG_NOSIGNAL));
+}
+
+_i16 sl_Recv(_i16 sd, void *pBuf, _i16 Len, _i16 flags) {
+  (void) flags;
+
+  NWPCall(NWP_CALL_US);
+
+  if (recvmax && ((uint32_t) Len > recvmax))
+    Len = (_i16) recvmax;
+
+  return NWPSockErr(recv(sd, pBuf, Len, 0));
+}
+
+_i16 sl_SetSockOpt(_i16 sd, _i16 level, _i16 optname, const void *optval,
+    _u16 optlen) {
+  const SlTimeval_t *timeout = (const SlTimeval_t*) optval;
+  struct timeval tv;
+
+  NWPCall(NWP_CALL_US);
+
+  if ((SL_SOL_SOCKET != level) || (SL_SO_RCVTIMEO != optname)
+      || (optlen < sizeof(SlTimeval_t)))
+    return 0;
+
+  tv.tv_sec = timeout->tv_sec;
+  tv.tv_usec = timeout->tv_usec;
+  return NWPSockErr(setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)));
+}
@@ -0,0 +1,262 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * 	\file stalltest.c
+ *
+ * 	\brief Boot deadlines (deadline.h) against a hung NWP.
+ *
+ * 	For each boot state (factory, custom, custom on trial) the boot
+ * 	(bootflow.c) is run once per NWP call, with that call stalled for an
+ * 	hour (NWPStall). Each run must be cut by the watchdog within the budget
+ * 	of its stage, and an image must be started within the bound: two clean
+ * 	boots, the budget and the backoff delay of the retried stages. The
+ * 	overrun is only seen by the next boot, counted as the second attempt.
+ *
+ * 	Then a custom image on trial that never confirms itself hangs until the
+ * 	trial watchdog (BOOT_TRIAL_MS) resets the SOC: the time from the start
+ * 	of its BOOT_CHECK boot to the factory image running is the time to
+ * 	rollback, and must stay within the trial time, two clean boots and the
+ * 	backoff delay of one failure.
+ *
+ * 	Usage: stalltest [-v]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "prcm.h"
+#include "simplelink.h"
+#include "boot.h"
+#include "backoff.h"
+#include "deadline.h"
+#include "host.h"
+
+/*! Boots tried before giving up on a stalled run. */
+#define STALL_BOOTS	8
+
+/*! Retained record of the stages. */
+#define DEADLINE	((volatile deadlinestats_t*) DEADLINE_ADDR)
+
+static const uint32_t budget[DEADLINE_STAGES] = { 0, DEADLINE_SL_START_MS,
+    DEADLINE_CFG_MS, DEADLINE_LOAD_MS, DEADLINE_LOAD_MS, DEADLINE_NETBOOT_MS,
+    DEADLINE_SL_STOP_MS };
+
+static const char *stagename[DEADLINE_STAGES] = { "none", "sl_Start", "cfg",
+    "load factory", "load custom", "netboot", "sl_Stop" };
+
+/*! Boot state set up by the application before the measured boot. */
+static bootinfo_t state;
+
+/*
+ * The application sets the boot state and resets.
+ */
+static int32_t AppSetup(void) {
+  bootinfo_t bootinfo;
+
+  if (0 != BOOTReadCfg(&bootinfo))
+    return -1;
+
+  bootinfo.status = state.status;
+  bootinfo.bootimg = state.bootimg;
+  if (0 != BOOTWriteCfg(&bootinfo))
+    return -1;
+
+  BOOTClose();
+  PRCMSOCReset();
+  return -1;
+}
+
+/*
+ * An image that never confirms itself, it hangs until the watchdog resets.
+ */
+static int32_t AppHang(void) {
+  HOSTDelay(3600000000ull);
+  return -1;
+}
+
+/*
+ * Power on with both images, and the state set.
+ */
+static void StallSetup(void) {
+  static uint8_t image[32768];
+  int32_t ret;
+
+  HOSTPowerOn();
+  NWPFormat();
+  NWPPut("/sys/factory.bin", image, sizeof(image));
+  NWPPut((const char*) BOOTSlotName(0), image, sizeof(image));
+
+  HOSTRun(HOSTBoot, &ret);
+  HOSTRun(AppSetup, &ret);
+  NWPClear();
+}
+
+/*
+ * Boot until an image starts. Returns it, -1 if none did.
+ */
+static int32_t StallBoot(uint32_t *resets) {
+  int32_t img;
+
+  for (*resets = 0; *resets < STALL_BOOTS; (*resets)++) {
+    if (0 == HOSTRun(HOSTBoot, &img))
+      return img;
+  }
+
+  return -1;
+}
+
+/*
+ * Stall every call of a boot from the given state.
+ */
+static int32_t StallRun(const char *name, int32_t verbose) {
+  uint64_t clean;
+  uint64_t start;
+  uint64_t bound;
+  uint64_t worst = 0;
+  uint32_t calls;
+  uint32_t call;
+  uint32_t resets;
+  uint32_t stage;
+  uint32_t cut;
+  int32_t failures = 0;
+  int32_t img;
+  nwpstats_t nwp;
+
+  StallSetup();
+  start = HOSTUs;
+  img = StallBoot(&resets);
+  clean = HOSTUs - start;
+  NWPStats(&nwp);
+  calls = nwp.calls;
+
+  printf("%s: image %d, %u NWP calls, %.1f ms\n", name, img, calls,
+      clean / 1e3);
+
+  for (call = 1; call <= calls; call++) {
+    StallSetup();
+    NWPStall(call);
+    start = HOSTUs;
+
+    /* The stalled boot, cut by the watchdog. */
+    stage = DEADLINE_NONE;
+    cut = 0;
+    if ((0 != HOSTRun(HOSTBoot, &img))
+        && (PRCM_WDT_RESET == HOSTResetCause)) {
+      stage = DEADLINE->stage;
+      cut = ((uint32_t) PRCMSlowClkCtrGet() - DEADLINE->start) * 1000 / 32768;
+    }
+
+    img = StallBoot(&resets);
+    NWPStall(0);
+
+    bound = 2 * clean + (budget[stage] + BACKOFFDelay(2)) * 1000ull;
+    if (HOSTUs - start > worst)
+      worst = HOSTUs - start;
+
+    if ((DEADLINE_NONE == stage) || (cut > budget[stage]) || (img < 0)
+        || (HOSTUs - start > bound)) {
+      failures++;
+      printf("  call %2u: FAIL stage %s cut at %u ms, image %d after %.1f ms"
+          " (bound %.1f ms)\n", call, stagename[stage], cut, img,
+          (HOSTUs - start) / 1e3, bound / 1e3);
+    }
+    else if (verbose) {
+      printf("  call %2u: %-12s cut at %5u ms, image %d after %8.1f ms\n",
+          call, stagename[stage], cut, img, (HOSTUs - start) / 1e3);
+    }
+  }
+
+  printf("  worst boot with a stall %.1f ms, %d failures\n", worst / 1e3,
+      failures);
+
+  return failures;
+}
+
+/*
+ * Time from the boot of a trial to the factory image, the image never
+ * confirming itself.
+ */
+static int32_t StallRollback(void) {
+  bootinfo_t bootinfo;
+  uint64_t start;
+  uint64_t trial;
+  uint64_t hang;
+  uint64_t bound;
+  uint32_t resets;
+  int32_t img;
+  int32_t ret;
+
+  state.status = BOOT_CHECK;
+  state.bootimg = IMG_CUSTOM;
+  StallSetup();
+
+  start = HOSTUs;
+  if ((0 != HOSTRun(HOSTBoot, &img)) || (IMG_CUSTOM != img)) {
+    printf("rollback: FAIL no trial boot\n");
+    return 1;
+  }
+
+  trial = HOSTUs - start;
+  HOSTRun(AppHang, &ret);
+  hang = HOSTUs - start;
+  img = StallBoot(&resets);
+
+  BOOTClose();
+  bound = 2 * trial + (BOOT_TRIAL_MS + BACKOFFDelay(1)) * 1000ull;
+  printf("rollback: trial boot %.1f ms, watchdog reset at %.1f ms, factory"
+      " image at %.1f ms\n", trial / 1e3, hang / 1e3, (HOSTUs - start) / 1e3);
+
+  if ((IMG_FACTORY != img) || (PRCM_WDT_RESET != HOSTResetCause)
+      || (0 != BOOTReadCfg(&bootinfo)) || (BOOT_OK != bootinfo.status)
+      || (IMG_FACTORY != bootinfo.bootimg) || (HOSTUs - start > bound)) {
+    printf("  FAIL image %d after %u resets (bound %.1f ms)\n", img, resets,
+        bound / 1e3);
+    return 1;
+  }
+
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int32_t verbose = (argc > 1) && (0 == strcmp(argv[1], "-v"));
+  int32_t failures = 0;
+
+  HOSTInit();
+
+  state.status = BOOT_OK;
+  state.bootimg = IMG_FACTORY;
+  failures += StallRun("factory", verbose);
+
+  state.bootimg = IMG_CUSTOM;
+  failures += StallRun("custom", verbose);
+
+  state.status = BOOT_CHECK;
+  failures += StallRun("custom on trial", verbose);
+
+  failures += StallRollback();
+
+  printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
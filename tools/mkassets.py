@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+
+"""Pack read-only assets into an asset file for the asset store (asset.h).
+
+Each asset is stored under the name given on the command line (the file base
+name by default, or NAME=PATH). The index is sorted by the FNV-1a hash of the
+name, which is what ASSETFind searches for. The names follow the index, so
+ASSETFind can tell a packed name from another one with the same hash.
+
+Usage: mkassets.py assets.bin ca.der index.html=web/index.html ...
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+ASSET_MAGIC = 0x32455341
+
+
+def asset_id(name):
+    """FNV-1a hash of the name, same as ASSETId."""
+    h = 2166136261
+    for c in name.encode():
+        h = ((h ^ c) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('out')
+    parser.add_argument('assets', nargs='+', metavar='[NAME=]PATH')
+    args = parser.parse_args()
+
+    assets = {}
+    for arg in args.assets:
+        name, _, path = arg.rpartition('=')
+        name = name or os.path.basename(path)
+        with open(path, 'rb') as f:
+            data = f.read()
+        aid = asset_id(name)
+        if aid in assets:
+            sys.exit('%s: id 0x%08x already used by %s' %
+                     (name, aid, assets[aid][0]))
+        assets[aid] = (name, data)
+
+    ids = sorted(assets)
+    names = b''.join(assets[aid][0].encode() for aid in ids)
+    nameoff = 8 + 20 * len(ids)
+    offset = nameoff + len(names) + (-len(names) % 4)
+    index = b''
+    blob = b''
+
+    for aid in ids:
+        name = assets[aid][0].encode()
+        data = assets[aid][1]
+        index += struct.pack('<IIIII', aid, offset + len(blob), len(data),
+                             nameoff, len(name))
+        nameoff += len(name)
+        # Keep every asset word aligned.
+        blob += data + b'\0' * (-len(data) % 4)
+
+    with open(args.out, 'wb') as f:
+        f.write(struct.pack('<II', ASSET_MAGIC, len(ids)))
+        f.write(index)
+        f.write(names + b'\0' * (-len(names) % 4))
+        f.write(blob)
+
+    print('%s: %d assets, %d bytes' % (args.out, len(ids), offset + len(blob)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""Build the packed bootloader: packstub.asm followed by the LZ77 coded
+bootloader.
+
+The ROM loader copies the whole file to 0x20004000 before the bootloader
+runs, so a smaller file boots faster as long as decoding costs less than the
+bytes saved. The stub (linked with packstub.ld) decodes the bootloader
+straight into 0x20000000, instead of the copy done by Relocator, so the
+ResetISR of the packed bootloader is set to its main here.
+
+The predicted ROM load plus relocation time of both files is printed, with
+--read-ns per byte loaded (as mkimg.py) and the cycles of the copy and
+decode loops at 80MHz. When the packed file is not predicted to be faster,
+the plain bootloader is written instead, unless --force is given.
+
+The packed bootloader is optional and off by default: on the 1.0.5
+bootloader the LZ77 codec only saves about 4% and the packed file loads
+slower at the usual flash speed. Build the stub from tools/ (see
+packstub.asm) only to try it.
+
+Usage: mkboot.py [--read-ns NS] [--force] Bootloader.elf packstub.elf
+                 Bootloader.bin
+"""
+
+import argparse
+import struct
+import sys
+
+from mkimg import Elf, load_payload, pack_lz
+
+INITIAL_POS = 0x20004000
+RELOCATED_POS = 0x20000000
+BOOT_MAX_LEN = INITIAL_POS - RELOCATED_POS
+
+CPU_HZ = 80000000
+
+# Cycles of the Relocator loop per word (ldr, str, 2 add, cmp, taken bne).
+RELOC_WORD = 9
+# Cycles of the stub loops (see packstub.asm).
+STUB_START = 8
+STUB_LITERAL = 10
+STUB_MATCH = 17
+STUB_BYTE = 7
+STUB_CLEAR_WORD = 6
+STUB_RUN = 8
+
+
+def unpack_lz(stream, outlen):
+    """Decode the stream as the stub does, to check it before writing it."""
+    out = bytearray()
+    i = 0
+    while i < len(stream):
+        c = stream[i]
+        i += 1
+        if c < 0x80:
+            out += stream[i:i + c + 1]
+            i += c + 1
+        else:
+            dist = stream[i] | (stream[i + 1] << 8)
+            i += 2
+            if not 0 < dist <= len(out):
+                raise ValueError('bad distance in the packed stream')
+            for _ in range((c & 0x7F) + 3):
+                out.append(out[-dist])
+    if len(out) != outlen:
+        raise ValueError('packed stream decodes to %d bytes' % len(out))
+    return bytes(out)
+
+
+def stub_cycles(stream, outlen):
+    """Cycles taken by the stub to decode stream and clear the memory."""
+    cycles = STUB_START + STUB_RUN
+    i = 0
+    while i < len(stream):
+        c = stream[i]
+        if c < 0x80:
+            cycles += STUB_LITERAL + (c + 1) * STUB_BYTE
+            i += c + 2
+        else:
+            cycles += STUB_MATCH + ((c & 0x7F) + 3) * STUB_BYTE
+            i += 3
+    return cycles + (BOOT_MAX_LEN - outlen) // 4 * STUB_CLEAR_WORD
+
+
+def load_us(nbytes, cycles, read_ns):
+    """Predicted ROM load plus relocation time, in us."""
+    return (nbytes * read_ns + cycles * 1000000000 // CPU_HZ) // 1000
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--read-ns', type=int, default=1000, metavar='NS',
+                        help='ROM load cost per byte (default: 1000)')
+    parser.add_argument('-f', '--force', action='store_true',
+                        help='write the packed file even if it is slower')
+    parser.add_argument('elf', help='bootloader ELF')
+    parser.add_argument('stub', help='packstub ELF')
+    parser.add_argument('out')
+    args = parser.parse_args()
+
+    with open(args.elf, 'rb') as f:
+        elf = Elf(f.read())
+    with open(args.stub, 'rb') as f:
+        stub = Elf(f.read())
+
+    base, payload, memend = load_payload(elf)
+    if base != RELOCATED_POS or memend > INITIAL_POS:
+        raise ValueError('the bootloader must fit 0x%08x..0x%08x' %
+                         (RELOCATED_POS, INITIAL_POS))
+
+    sbase, code, _ = load_payload(stub)
+    packed = stub.symbol('packed')
+    if sbase != INITIAL_POS or packed is None \
+            or packed[0] != sbase + len(code):
+        raise ValueError('the stub must be linked with packstub.ld')
+
+    # The stub jumps straight to the ResetISR, skipping Relocator.
+    entry = elf.symbol('main')
+    if entry is None:
+        raise ValueError('symbol main not found')
+    plain = bytes(payload)
+    struct.pack_into('<I', payload, 4, entry[0] | 1)
+
+    stream = pack_lz(payload, 0, len(payload), {})
+    unpack_lz(stream, len(payload))
+    packed = code + struct.pack('<I', len(stream)) + stream
+
+    raw_us = load_us(len(plain), BOOT_MAX_LEN // 4 * RELOC_WORD, args.read_ns)
+    packed_us = load_us(len(packed), stub_cycles(stream, len(payload)),
+                        args.read_ns)
+    print('raw: %d bytes, predicted ROM load and relocation %d us' %
+          (len(plain), raw_us))
+    print('packed: %d bytes, predicted ROM load and unpack %d us' %
+          (len(packed), packed_us))
+
+    if packed_us >= raw_us and not args.force:
+        print('packing does not pay, writing the plain bootloader')
+        packed = plain
+
+    with open(args.out, 'wb') as f:
+        f.write(packed)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,513 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""Build a bootloader image (imghdr_t + payload + relocations) from an ELF.
+
+The application must be linked for BASE_ADDR. To build a relocatable image
+(-r) it must also be linked with --emit-relocs (-Wl,-q) so the relocations
+survive in the final ELF, and it must not use movw/movt to load addresses
+(the default for GCC on the Cortex-M4 is to use literal pools).
+
+Everything the application uses in SRAM (.bss, heap and stack included, as
+given by the PT_LOAD segments) must end below RETAINED_ADDR, the SRAM size
+is recorded in imghdr_t::memlen.
+
+Extra files loaded by the bootloader together with the image are given with
+-f NAME:DEST[:MAXLEN], where DEST is a symbol of the application (a buffer)
+or an address, and MAXLEN defaults to the size of the symbol. The buffer
+must be in the .noinit section of the application (or past the SRAM it
+uses), anywhere else its C runtime would clear the file at startup.
+
+The payload can be protected by a digest checked by the bootloader before
+the image is started (-d blake2s), or only by a checksum (-d adler32).
+
+Regions of the application that can be patched per device by the bootloader
+(see tools/mkpatch.py) are given with -p SYMBOL[:LEN] or -p ADDR:LEN.
+
+The payload can be packed (-z): each IMG_CHUNK_SIZE chunk is stored raw,
+run-length coded or LZ77 coded, picking the codec with the lowest predicted
+load time. The model charges --read-ns per byte read from the flash plus the
+decoding cost of the codec per byte produced, so a chunk is only coded when
+the bytes saved pay for the decoder. The bootloader reads a coded chunk into
+the SRAM of the image past the chunk, a chunk that doesn't fit before the
+end of the image (memend) is stored raw. --codec rle or --codec lz limits
+the choice to raw chunks and that codec, to compare with a single codec.
+
+An application that takes over the NWP still connecting from the bootloader
+(see wlan.h) is built with -w.
+
+Usage: mkimg.py [-r] [-z [--codec CODEC]] [-w] [-t MS] [-d DIGEST]
+                [-f NAME:DEST[:MAXLEN]]... [-p SYMBOL[:LEN]]...
+                app.elf custom.bin
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+IMG_MAGIC = 0x474D4941
+IMG_FLAG_RELOC = 0x0001
+IMG_FLAG_PACKED = 0x0002
+IMG_FLAG_WLAN = 0x0004
+RELOC_SKIP = 0xFFFF
+
+HDR_FMT = '<IHHIIIIIII32sIIIIIII'
+CHUNK_FMT = '<HH'
+FILE_FMT = '<40sII'
+BOOT_MAX_FILES = 4
+REGION_FMT = '<II'
+BOOT_MAX_REGIONS = 4
+RETAINED_ADDR = 0x2003F800
+
+IMG_DIGEST = {
+    'none': 0,
+    'blake2s': 1,
+    'adler32': 2,
+}
+
+IMG_CHUNK_SIZE = 1024
+IMG_CODEC_RAW = 0
+IMG_CODEC_RLE = 1
+IMG_CODEC_LZ = 2
+
+# Decoding cost on the target, in ns per byte produced.
+CODEC_NS = {
+    IMG_CODEC_RAW: 0,
+    IMG_CODEC_RLE: 40,
+    IMG_CODEC_LZ: 80,
+}
+
+LZ_MIN = 3
+LZ_MAX = 0x7F + LZ_MIN
+LZ_WINDOW = 0xFFFF
+LZ_CHAIN = 64
+
+PT_LOAD = 1
+SHT_SYMTAB = 2
+SHT_REL = 9
+SHN_UNDEF = 0
+SHN_ABS = 0xFFF1
+
+R_ARM_ABS32 = 2
+R_ARM_TARGET1 = 38
+R_ARM_ABS_MOV = (43, 44, 47, 48)
+
+
+class Elf(object):
+    """Minimal ELF32 little endian reader."""
+
+    def __init__(self, data):
+        if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+            raise ValueError('not an ELF32 little endian file')
+        self.data = data
+        (self.phoff, self.shoff) = struct.unpack_from('<II', data, 28)
+        (self.phentsize, self.phnum, self.shentsize, self.shnum) = \
+            struct.unpack_from('<HHHH', data, 42)
+
+    def segments(self):
+        for i in range(self.phnum):
+            yield struct.unpack_from('<IIIIIIII', self.data,
+                                     self.phoff + i * self.phentsize)
+
+    def sections(self):
+        for i in range(self.shnum):
+            yield struct.unpack_from('<IIIIIIIIII', self.data,
+                                     self.shoff + i * self.shentsize)
+
+    def section(self, name):
+        """Return (addr, size) of a section, None if not found."""
+        sections = list(self.sections())
+        (shstrndx,) = struct.unpack_from('<H', self.data, 50)
+        strtab = sections[shstrndx]
+        for sh in sections:
+            start = strtab[4] + sh[0]
+            end = self.data.index(b'\0', start)
+            if self.data[start:end].decode() == name:
+                return sh[3], sh[5]
+        return None
+
+    def symbols(self):
+        """Yield (name, value, size, info) of every symbol."""
+        sections = list(self.sections())
+        for sh in sections:
+            if sh[1] != SHT_SYMTAB:
+                continue
+            strtab = sections[sh[6]]
+            for off in range(sh[4], sh[4] + sh[5], sh[9]):
+                st_name, value, size, info = struct.unpack_from(
+                    '<IIIB', self.data, off)
+                start = strtab[4] + st_name
+                end = self.data.index(b'\0', start)
+                yield self.data[start:end].decode(), value, size, info
+
+    def symbol(self, name):
+        """Return (value, size) of a symbol, None if not found."""
+        for sym in self.symbols():
+            if sym[0] == name:
+                return sym[1], sym[2]
+        return None
+
+
+def load_payload(elf):
+    """Concatenate the PT_LOAD segments, returns (linkaddr, payload, memend)."""
+    segs = [s for s in elf.segments() if s[0] == PT_LOAD and s[5] > 0]
+    if not segs:
+        raise ValueError('no loadable segment')
+
+    base = min(s[2] for s in segs if s[4] > 0)
+    end = max(s[2] + s[4] for s in segs)
+    memend = max(s[2] + s[5] for s in segs)
+    payload = bytearray(end - base)
+
+    for s in segs:
+        if s[4]:
+            off = s[2] - base
+            payload[off:off + s[4]] = elf.data[s[1]:s[1] + s[4]]
+
+    # The loader works with whole words.
+    payload += b'\0' * (-len(payload) % 4)
+    return base, payload, memend
+
+
+def find_relocs(elf, base, size, memend):
+    """Return the sorted word indexes of the payload that hold addresses."""
+    sections = list(elf.sections())
+    words = set()
+
+    for sh in sections:
+        if sh[1] != SHT_REL:
+            continue
+
+        symtab = sections[sh[6]]
+        for off in range(sh[4], sh[4] + sh[5], 8):
+            r_offset, r_info = struct.unpack_from('<II', elf.data, off)
+            rtype = r_info & 0xFF
+            sym = r_info >> 8
+
+            if not base <= r_offset < base + size:
+                continue
+
+            if rtype in R_ARM_ABS_MOV:
+                raise ValueError('movw/movt relocation at 0x%08x, build without '
+                                 '-mslow-flash-data/-mpure-code' % r_offset)
+
+            if rtype not in (R_ARM_ABS32, R_ARM_TARGET1):
+                continue
+
+            value, shndx = struct.unpack_from(
+                '<I6xH', elf.data, symtab[4] + sym * symtab[9] + 4)
+            if shndx == SHN_UNDEF:
+                continue
+
+            # Linker script symbols are absolute, keep only those in the image.
+            if shndx == SHN_ABS and not base <= value <= memend:
+                continue
+
+            if r_offset & 3:
+                raise ValueError('unaligned relocation at 0x%08x' % r_offset)
+
+            words.add((r_offset - base) // 4)
+
+    return sorted(words)
+
+
+def encode_relocs(words):
+    """Encode the word indexes as uint16_t deltas (see imghdr_t)."""
+    out = []
+    pos = 0
+    for w in words:
+        delta = w - pos
+        while delta > RELOC_SKIP - 1:
+            out.append(RELOC_SKIP)
+            delta -= RELOC_SKIP
+        out.append(delta)
+        pos = w
+    return out
+
+
+def flush_literals(out, lit):
+    """Emit literal runs of at most 128 bytes."""
+    for i in range(0, len(lit), 0x80):
+        run = lit[i:i + 0x80]
+        out.append(len(run) - 1)
+        out += run
+    del lit[:]
+
+
+def pack_rle(chunk):
+    """Run-length code a chunk (see UNPACKRle)."""
+    out = bytearray()
+    lit = bytearray()
+    i = 0
+    while i < len(chunk):
+        n = 1
+        while i + n < len(chunk) and n < 0x7F + 3 and chunk[i + n] == chunk[i]:
+            n += 1
+        if n >= 3:
+            flush_literals(out, lit)
+            out.append(0x80 + n - 3)
+            out.append(chunk[i])
+            i += n
+        else:
+            lit.append(chunk[i])
+            i += 1
+    flush_literals(out, lit)
+    return bytes(out)
+
+
+def pack_lz(payload, start, end, heads):
+    """LZ77 code payload[start:end], the previous bytes are the window.
+
+    heads maps a 3 byte prefix to the positions it was seen at, it is shared
+    between the chunks so matches can reach into the previous ones.
+    """
+    out = bytearray()
+    lit = bytearray()
+    i = start
+    while i < end:
+        best_len, best_dist = 0, 0
+        key = bytes(payload[i:i + LZ_MIN])
+        if len(key) == LZ_MIN:
+            for j in reversed(heads.get(key, [])[-LZ_CHAIN:]):
+                if i - j > LZ_WINDOW:
+                    break
+                n = 0
+                while (n < LZ_MAX and i + n < end
+                       and payload[j + n] == payload[i + n]):
+                    n += 1
+                if n > best_len:
+                    best_len, best_dist = n, i - j
+                    if n == LZ_MAX:
+                        break
+
+        if best_len >= LZ_MIN:
+            flush_literals(out, lit)
+            out.append(0x80 + best_len - LZ_MIN)
+            out += struct.pack('<H', best_dist)
+            step = best_len
+        else:
+            lit.append(payload[i])
+            step = 1
+
+        for k in range(i, i + step):
+            heads.setdefault(bytes(payload[k:k + LZ_MIN]), []).append(k)
+        i += step
+    flush_literals(out, lit)
+    return bytes(out)
+
+
+def pack_payload(payload, read_ns, memlen,
+                 codecs=(IMG_CODEC_RLE, IMG_CODEC_LZ)):
+    """Return (table, data, ns) of the packed payload (see imgchunk_t)."""
+    table = []
+    data = bytearray()
+    heads = {}
+    total = 0
+
+    for start in range(0, len(payload), IMG_CHUNK_SIZE):
+        chunk = bytes(payload[start:start + IMG_CHUNK_SIZE])
+        options = [(IMG_CODEC_RAW, chunk)]
+        if IMG_CODEC_RLE in codecs:
+            options.append((IMG_CODEC_RLE, pack_rle(chunk)))
+        if IMG_CODEC_LZ in codecs:
+            options.append((IMG_CODEC_LZ, pack_lz(payload, start,
+                                                  start + len(chunk), heads)))
+
+        # A coded chunk is read into the SRAM of the image past the chunk.
+        room = memlen - (start + len(chunk))
+
+        best = None
+        for codec, enc in options:
+            if codec != IMG_CODEC_RAW and (len(enc) >= len(chunk)
+                                           or len(enc) > room):
+                continue
+            ns = len(enc) * read_ns + len(chunk) * CODEC_NS[codec]
+            if best is None or ns < best[0]:
+                best = (ns, codec, enc)
+
+        ns, codec, enc = best
+        total += ns
+        table.append(struct.pack(CHUNK_FMT, codec, len(enc)))
+        data += enc
+
+    return b''.join(table), bytes(data), total
+
+
+def parse_file(elf, arg, noinit, memend):
+    """Parse NAME:DEST[:MAXLEN] into an imgfile_t."""
+    parts = arg.split(':')
+    if len(parts) not in (2, 3):
+        raise ValueError('bad file spec %s' % arg)
+
+    name, dest = parts[0], parts[1]
+    size = 0
+    try:
+        addr = int(dest, 0)
+    except ValueError:
+        sym = elf.symbol(dest)
+        if sym is None:
+            raise ValueError('symbol %s not found' % dest)
+        addr, size = sym
+
+    if len(parts) == 3:
+        size = int(parts[2], 0)
+    if not size:
+        raise ValueError('no size for %s' % arg)
+    if len(name.encode()) >= 40:
+        raise ValueError('file name too long: %s' % name)
+    if not (noinit[0] <= addr and addr + size <= noinit[0] + noinit[1]
+            or memend <= addr and addr + size <= RETAINED_ADDR):
+        raise ValueError('%s must be in .noinit or past the SRAM of the '
+                         'image (0x%08x)' % (arg, memend))
+
+    return struct.pack(FILE_FMT, name.encode(), addr, size)
+
+
+def parse_region(elf, base, size, arg):
+    """Parse SYMBOL[:LEN] or ADDR:LEN into an imgregion_t."""
+    parts = arg.split(':')
+    if len(parts) not in (1, 2):
+        raise ValueError('bad region spec %s' % arg)
+
+    length = 0
+    try:
+        addr = int(parts[0], 0)
+    except ValueError:
+        sym = elf.symbol(parts[0])
+        if sym is None:
+            raise ValueError('symbol %s not found' % parts[0])
+        addr, length = sym
+
+    if len(parts) == 2:
+        length = int(parts[1], 0)
+    if length < 4 or addr & 3:
+        raise ValueError('region %s must be word aligned and sized' % arg)
+    if not base <= addr <= addr + length <= base + size:
+        raise ValueError('region %s is not in the payload' % arg)
+
+    return struct.pack(REGION_FMT, addr, length & ~3)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-r', '--reloc', action='store_true',
+                        help='build a relocatable image')
+    parser.add_argument('-t', '--trial', type=int, default=0, metavar='MS',
+                        help='trial boot timeout (default: BOOT_TRIAL_MS)')
+    parser.add_argument('-z', '--pack', action='store_true',
+                        help='pack the payload in chunks')
+    parser.add_argument('-w', '--wlan', action='store_true',
+                        help='take over the running NWP (see wlan.h)')
+    parser.add_argument('--codec', choices=('any', 'rle', 'lz'),
+                        default='any',
+                        help='codec used by -z besides raw (default: any)')
+    parser.add_argument('--read-ns', type=int, default=1000, metavar='NS',
+                        help='flash read cost per byte for -z (default: 1000)')
+    parser.add_argument('-d', '--digest', choices=sorted(IMG_DIGEST),
+                        default='none', help='payload digest (default: none)')
+    parser.add_argument('-f', '--file', action='append', default=[],
+                        metavar='NAME:DEST[:MAXLEN]',
+                        help='extra file loaded with the image')
+    parser.add_argument('-p', '--patch', action='append', default=[],
+                        metavar='SYMBOL[:LEN]',
+                        help='region patchable per device')
+    parser.add_argument('elf')
+    parser.add_argument('out')
+    args = parser.parse_args()
+
+    with open(args.elf, 'rb') as f:
+        elf = Elf(f.read())
+
+    base, payload, memend = load_payload(elf)
+    if memend > RETAINED_ADDR:
+        raise ValueError('the image uses SRAM up to 0x%08x, past RETAINED_ADDR '
+                         '(0x%08x)' % (memend, RETAINED_ADDR))
+    flags = IMG_FLAG_WLAN if args.wlan else 0
+    relocs = []
+
+    if args.reloc:
+        flags |= IMG_FLAG_RELOC
+        relocs = encode_relocs(find_relocs(elf, base, len(payload), memend))
+
+    if len(args.file) > BOOT_MAX_FILES:
+        raise ValueError('at most %d extra files' % BOOT_MAX_FILES)
+    noinit = elf.section('.noinit') or (0, 0)
+    files = b''.join(parse_file(elf, arg, noinit, memend)
+                     for arg in args.file)
+
+    if len(args.patch) > BOOT_MAX_REGIONS:
+        raise ValueError('at most %d patchable regions' % BOOT_MAX_REGIONS)
+    regions = b''.join(parse_region(elf, base, len(payload), arg)
+                       for arg in args.patch)
+
+    stored = bytes(payload)
+    if args.pack:
+        flags |= IMG_FLAG_PACKED
+        codecs = {'any': (IMG_CODEC_RLE, IMG_CODEC_LZ),
+                  'rle': (IMG_CODEC_RLE,),
+                  'lz': (IMG_CODEC_LZ,)}[args.codec]
+        table, data, ns = pack_payload(payload, args.read_ns,
+                                       memend - base, codecs)
+        stored = table + data
+        print('packed %d bytes in %d, predicted load %d us (raw %d us)' %
+              (len(payload), len(stored), ns // 1000,
+               len(payload) * args.read_ns // 1000))
+
+    # The digest covers the payload as stored, before any unpacking and
+    # relocation.
+    digest = b''
+    if args.digest == 'blake2s':
+        digest = hashlib.blake2s(stored, digest_size=32).digest()
+    elif args.digest == 'adler32':
+        digest = struct.pack('<I', zlib.adler32(stored))
+
+    # The file and region tables go between the header and the payload.
+    hdrlen = struct.calcsize(HDR_FMT)
+    fileoff = hdrlen
+    regionoff = fileoff + len(files)
+    payloadoff = regionoff + len(regions)
+    hdr = struct.pack(HDR_FMT, IMG_MAGIC, hdrlen, flags,
+                      base, len(payload), len(relocs), args.trial,
+                      fileoff, len(args.file), IMG_DIGEST[args.digest],
+                      digest, len(stored) if args.pack else 0, regionoff,
+                      len(args.patch), memend - base, payloadoff, noinit[0],
+                      noinit[1])
+
+    with open(args.out, 'wb') as f:
+        f.write(hdr)
+        f.write(files)
+        f.write(regions)
+        f.write(stored)
+        f.write(struct.pack('<%dH' % len(relocs), *relocs))
+
+    print('%s: 0x%08x, %d bytes (%d in SRAM), %d relocations' %
+          (args.out, base, len(payload), memend - base, len(relocs)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""Build the per-device patch file (/sys/patch.bin, see patch.h).
+
+Each record sets one word of the application, given as SYMBOL[+OFF]=VALUE or
+ADDR=VALUE. The words must be inside the regions declared with mkimg.py -p,
+the bootloader refuses the whole file otherwise.
+
+Usage: mkpatch.py app.elf patch.bin cal_gain=0x1234 cal_table+8=-3 ...
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+from mkimg import Elf, load_payload
+
+PATCH_MAGIC = 0x48435450
+PATCH_MAX_RECORDS = 128
+
+
+def parse_record(elf, base, size, arg):
+    """Parse TARGET=VALUE into a patchrec_t."""
+    target, sep, value = arg.partition('=')
+    if not sep:
+        raise ValueError('bad record %s' % arg)
+
+    name, _, off = target.partition('+')
+    try:
+        addr = int(name, 0)
+    except ValueError:
+        sym = elf.symbol(name)
+        if sym is None:
+            raise ValueError('symbol %s not found' % name)
+        addr = sym[0]
+    addr += int(off, 0) if off else 0
+
+    if addr & 3 or not base <= addr <= base + size - 4:
+        raise ValueError('%s is not a word of the payload' % target)
+
+    return struct.pack('<II', addr - base, int(value, 0) & 0xFFFFFFFF)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('elf')
+    parser.add_argument('out')
+    parser.add_argument('records', nargs='+', metavar='TARGET=VALUE')
+    args = parser.parse_args()
+
+    if len(args.records) > PATCH_MAX_RECORDS:
+        raise ValueError('at most %d records' % PATCH_MAX_RECORDS)
+
+    with open(args.elf, 'rb') as f:
+        elf = Elf(f.read())
+
+    base, payload, _ = load_payload(elf)
+    recs = b''.join(parse_record(elf, base, len(payload), arg)
+                    for arg in args.records)
+
+    with open(args.out, 'wb') as f:
+        f.write(struct.pack('<III', PATCH_MAGIC, len(args.records),
+                            zlib.adler32(recs)))
+        f.write(recs)
+
+    print('%s: %d records' % (args.out, len(args.records)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""Serve an image file to bootloaders built with BOOT_NETBOOT.
+
+The bootloader connects, sends the "NBOT" request and gets the file in
+chunks, each one a little endian uint32 length followed by the data, ended by
+a chunk of length 0. The file is read again for every request, so a new build
+is picked up by just resetting the board.
+
+Usage: netboot.py [-p PORT] [-c CHUNK] custom.bin
+"""
+
+import argparse
+import socket
+import struct
+import sys
+
+NETBOOT_MAGIC = b'NBOT'
+
+
+def recv_exact(conn, n):
+    data = b''
+    while len(data) < n:
+        part = conn.recv(n - len(data))
+        if not part:
+            raise ConnectionError('connection closed')
+        data += part
+    return data
+
+
+def serve_one(conn, path, chunk):
+    """Answer one request, returns the number of bytes sent."""
+    if recv_exact(conn, 4) != NETBOOT_MAGIC:
+        raise ValueError('bad request')
+
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    for off in range(0, len(data), chunk):
+        part = data[off:off + chunk]
+        conn.sendall(struct.pack('<I', len(part)) + part)
+    conn.sendall(struct.pack('<I', 0))
+    return len(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-p', '--port', type=int, default=6969,
+                        help='TCP port (default: 6969)')
+    parser.add_argument('-c', '--chunk', type=int, default=4096,
+                        help='chunk size (default: 4096)')
+    parser.add_argument('image')
+    args = parser.parse_args()
+
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(('', args.port))
+    srv.listen(1)
+    print('serving %s on port %d' % (args.image, args.port))
+
+    while True:
+        conn, addr = srv.accept()
+        with conn:
+            try:
+                n = serve_one(conn, args.image, args.chunk)
+                print('%s: %d bytes' % (addr[0], n))
+            except (OSError, ValueError) as e:
+                print('%s: %s' % (addr[0], e))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
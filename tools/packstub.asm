@@ -0,0 +1,153 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Akenge Engenharia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ *  \file packstub.asm
+ *
+ *  \brief Decompression stub of the packed bootloader.
+ *
+ *  The ROM loader copies the whole bootloader file to 0x20004000 before any
+ *  of it runs, so every byte of the file costs boot time. The packed
+ *  bootloader (tools/mkboot.py) is this stub followed by the bootloader
+ *  coded with the LZ77 codec of the packed images (IMG_CODEC_LZ, see
+ *  unpack.h). Instead of the word by word copy of Relocator, the stub
+ *  decodes the bootloader into 0x20000000, clears the rest of its 16KB
+ *  (.bss and stack) and runs it.
+ *
+ *  The stub is linked for 0x20004000 with packstub.ld and must not grow
+ *  past the packed data: mkboot.py appends the stream at the symbol packed.
+ *  The stream is a word with its length followed by the tokens. The data is
+ *  not checked here, mkboot.py decodes it again before writing the file.
+ *
+ *  It lives in tools/ so the bootloader project doesn't build it (its
+ *  .intvecs would end up next to the one of startup.asm). Build it apart:
+ *
+ *    arm-none-eabi-gcc -mcpu=cortex-m4 -mthumb -nostdlib -T packstub.ld
+ *        packstub.asm -o packstub.elf
+ */
+
+.syntax unified
+.thumb
+
+/*!
+ *  \def INITIAL_POS 0x20004000
+ *
+ *  \brief Stub position, where the TI bootloader loads the binary file.
+ */
+.set    INITIAL_POS,    0x20004000
+
+/*!
+ *  \def RELOCATED_POS 0x20000000
+ *
+ *  \brief Bootloader final position.
+ */
+.set    RELOCATED_POS,    0x20000000
+
+/*!
+ *  \brief Interrupt vector
+ *
+ *  Same stack pointer as the bootloader, the stub itself doesn't use it.
+ */
+.section .intvecs
+stubVector: .global stubVector
+    .word   0x20004004
+    .word   Unpacker+1
+
+
+.text
+
+/*!
+ *  \fn void Unpacker (void)
+ *
+ *  \brief Decode the bootloader from packed to 0x20000000 and run it.
+ *
+ *  mkboot.py has already set the ResetISR of the packed bootloader
+ *  (IntVector[1]) to its main, as Relocator would.
+ */
+Unpacker: .global  Unpacker
+    .align 4
+    // r0 = Output position
+    ldr        r0, =RELOCATED_POS
+    // r1 = Packed stream, r3 = its end
+    adr        r1, packed
+    ldr        r3, [r1], #4
+    add        r3, r3, r1
+
+token:
+    cmp        r1, r3
+    bhs        clear
+
+    // r4 = Control byte.
+    ldrb       r4, [r1], #1
+    cmp        r4, #0x80
+    bhs        match
+
+    // Literal run of r4 + 1 bytes.
+    add        r4, r4, #1
+literal:
+    ldrb       r5, [r1], #1
+    strb       r5, [r0], #1
+    subs       r4, r4, #1
+    bne        literal
+    b          token
+
+    // Copy (r4 & 0x7F) + 3 bytes from r5 bytes back.
+match:
+    and        r4, r4, #0x7F
+    add        r4, r4, #3
+    ldrb       r5, [r1], #1
+    ldrb       r6, [r1], #1
+    orr        r5, r5, r6, lsl #8
+    sub        r5, r0, r5
+copy:
+    ldrb       r6, [r5], #1
+    strb       r6, [r0], #1
+    subs       r4, r4, #1
+    bne        copy
+    b          token
+
+    // The output is word padded, clear up to the stub word by word.
+clear:
+    ldr        r2, =INITIAL_POS
+    mov        r4, #0
+zero:
+    cmp        r0, r2
+    bhs        run
+    str        r4, [r0], #4
+    b          zero
+
+    // Run the bootloader, as BOOTRun does.
+run:
+    ldr        r0, =RELOCATED_POS
+    ldr        r1, [r0]
+    mov        sp, r1
+    ldr        r1, [r0, #4]
+    bx         r1
+
+    // Literal pool, then the packed stream appended by mkboot.py.
+    .ltorg
+    .align 2
+packed: .global packed
+
+.end
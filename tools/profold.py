@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+
+"""Turn the boot profiler samples (prof.h) into folded stacks.
+
+The input is a binary dump of the profbuf_t buffer at PROF_ADDR. The PC and
+LR of each sample are symbolized against the bootloader ELF and printed as
+"caller;function count" lines, the input format of flamegraph.pl.
+
+Usage: profold.py Bootloader.elf prof.bin > boot.folded
+"""
+
+import argparse
+import bisect
+import struct
+import sys
+
+from mkimg import Elf
+
+PROF_MAGIC = 0x464F5250
+STT_FUNC = 2
+EXC_RETURN = 0xFFFFFFF0
+
+
+class Symbolizer(object):
+    """Map addresses to the function that contains them."""
+
+    def __init__(self, elf):
+        funcs = sorted((value & ~1, size, name)
+                       for name, value, size, info in elf.symbols()
+                       if info & 0xF == STT_FUNC and name)
+        self.starts = [f[0] for f in funcs]
+        self.funcs = funcs
+
+    def __call__(self, addr):
+        addr &= ~1
+        i = bisect.bisect_right(self.starts, addr) - 1
+        if i >= 0:
+            start, size, name = self.funcs[i]
+            if addr < start + max(size, 2):
+                return name
+        if addr < 0x20000000:
+            return '[rom]'
+        return '[0x%08x]' % addr
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('elf')
+    parser.add_argument('dump')
+    args = parser.parse_args()
+
+    with open(args.elf, 'rb') as f:
+        sym = Symbolizer(Elf(f.read()))
+    with open(args.dump, 'rb') as f:
+        data = f.read()
+
+    magic, count, period, _ = struct.unpack_from('<IIII', data)
+    if magic != PROF_MAGIC:
+        sys.exit('%s: no valid profile (was the bootloader built with '
+                 'BOOT_PROFILE?)' % args.dump)
+
+    stacks = {}
+    for i in range(count):
+        pc, lr = struct.unpack_from('<II', data, 16 + 8 * i)
+        func = sym(pc)
+        caller = sym(lr) if lr < EXC_RETURN else None
+
+        stack = func if caller in (None, func) else caller + ';' + func
+        stacks[stack] = stacks.get(stack, 0) + 1
+
+    for stack in sorted(stacks):
+        print('%s %d' % (stack, stacks[stack]))
+
+    sys.stderr.write('%d samples, %d us each\n' % (count, period))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
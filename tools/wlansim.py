@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Akenge Engenharia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""Estimate the time to IP of an application with and without the NWP
+handover (see wlan.h).
+
+The NWP stand-in starts connecting to its stored profile when it is
+started: a scan, then the association, then DHCP, each with a random
+latency in the given range. Without the handover the bootloader stops the
+NWP after loading the image and the application starts it again, so the
+connection starts over from the application's sl_Start. With it the
+connection started by the bootloader's sl_Start goes on while the image is
+loaded and the application starts.
+
+The default latencies are typical figures, measure the real network.
+
+Usage: wlansim.py [-n RUNS] [--load-ms MS] [--scan-ms MIN:MAX] ...
+"""
+
+import argparse
+import random
+import sys
+
+
+class Nwp(object):
+    """NWP stand-in, connecting from the time it is started."""
+
+    def __init__(self, args, rng):
+        self.args = args
+        self.rng = rng
+
+    def latency(self, span):
+        return self.rng.uniform(span[0], span[1])
+
+    def start(self, t):
+        """Start the NWP at t, returns the time it gets an IP address."""
+        a = self.args
+        t += a.nwp_start_ms
+        return (t + self.latency(a.scan_ms) + self.latency(a.assoc_ms)
+                + self.latency(a.dhcp_ms))
+
+
+def boot(args, nwp, handover):
+    """Return (application start, IP address) times of one boot in ms."""
+    ip = nwp.start(0)
+    t = args.nwp_start_ms + args.cfg_ms + args.load_ms
+
+    if not handover:
+        t += args.stop_ms
+
+    # The application runs its init and its sl_Start, which is only a
+    # driver init when the NWP is adopted.
+    t += args.app_ms
+    if not handover:
+        ip = nwp.start(t)
+        t += args.nwp_start_ms
+
+    return t, max(ip, t)
+
+
+def span(text):
+    low, _, high = text.partition(':')
+    return float(low), float(high or low)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-n', '--runs', type=int, default=10000,
+                        help='boots simulated (default: 10000)')
+    parser.add_argument('--nwp-start-ms', type=float, default=120,
+                        help='sl_Start until the NWP runs (default: 120)')
+    parser.add_argument('--cfg-ms', type=float, default=20,
+                        help='boot.cfg stage (default: 20)')
+    parser.add_argument('--load-ms', type=float, default=300,
+                        help='image load (default: 300)')
+    parser.add_argument('--stop-ms', type=float, default=20,
+                        help='sl_Stop (default: 20)')
+    parser.add_argument('--app-ms', type=float, default=50,
+                        help='application init before sl_Start '
+                        '(default: 50)')
+    parser.add_argument('--scan-ms', type=span, default=(300, 1500),
+                        metavar='MIN:MAX', help='scan (default: 300:1500)')
+    parser.add_argument('--assoc-ms', type=span, default=(50, 300),
+                        metavar='MIN:MAX',
+                        help='authentication and association '
+                        '(default: 50:300)')
+    parser.add_argument('--dhcp-ms', type=span, default=(100, 1500),
+                        metavar='MIN:MAX', help='DHCP (default: 100:1500)')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    print('%-12s %10s %12s %12s' % ('', 'app (ms)', 'IP p50 (ms)',
+                                    'IP p90 (ms)'))
+    for name, handover in (('sl_Stop', False), ('handover', True)):
+        nwp = Nwp(args, random.Random(args.seed))
+        runs = [boot(args, nwp, handover) for _ in range(args.runs)]
+        ips = [r[1] for r in runs]
+        print('%-12s %10.0f %12.0f %12.0f' %
+              (name, runs[0][0], percentile(ips, 0.5), percentile(ips, 0.9)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())